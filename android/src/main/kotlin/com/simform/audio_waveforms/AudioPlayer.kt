@@ -7,7 +7,11 @@ import android.os.Looper
 import com.google.android.exoplayer2.ExoPlayer
 import com.google.android.exoplayer2.MediaItem
 import com.google.android.exoplayer2.PlaybackException
+import com.google.android.exoplayer2.PlaybackParameters
 import com.google.android.exoplayer2.Player
+import com.google.android.exoplayer2.extractor.DefaultExtractorsFactory
+import com.google.android.exoplayer2.extractor.mp3.Mp3Extractor
+import com.google.android.exoplayer2.source.DefaultMediaSourceFactory
 import io.flutter.plugin.common.MethodChannel
 
 class AudioPlayer(
@@ -24,23 +28,18 @@ class AudioPlayer(
     private var isPlayerPrepared: Boolean = false
     private var finishMode = FinishMode.Stop
     private var key = playerKey
-    private var updateFrequency: Long = 200
 
     fun preparePlayer(
             result: MethodChannel.Result,
             path: String?,
             volume: Float?,
-            frequency: Long?,
     ) {
         if (path != null) {
-            frequency?.let {
-                updateFrequency = it
-            }
             val uri = Uri.parse(path)
             val mediaItem = MediaItem.fromUri(uri)
             stop()
             player?.clearMediaItems()
-            player = ExoPlayer.Builder(appContext).build()
+            player = buildPlayer()
             player?.setMediaItem(mediaItem)
             player?.prepare()
             playerListener = object : Player.Listener {
@@ -50,6 +49,22 @@ class AudioPlayer(
                     result.error(Constants.LOG_TAG, error.message, "Unable to load media source.")
                 }
 
+                override fun onIsPlayingChanged(isPlaying: Boolean) {
+                    if (isPlaying) startListening() else stopListening()
+                }
+
+                override fun onPositionDiscontinuity(
+                        oldPosition: Player.PositionInfo,
+                        newPosition: Player.PositionInfo,
+                        reason: Int
+                ) {
+                    sendAnchor()
+                }
+
+                override fun onPlaybackParametersChanged(playbackParameters: PlaybackParameters) {
+                    sendAnchor()
+                }
+
                 override fun onPlayerStateChanged(isReady: Boolean, state: Int) {
                     if (!isPlayerPrepared) {
                         if (state == Player.STATE_READY) {
@@ -96,10 +111,25 @@ class AudioPlayer(
         }
     }
 
+    /// MP3 files without a seek table, or with the coarse one of a Xing
+    /// header, are seeked by estimate by default. Index seeking records the
+    /// offset of every frame while the file is read, so seeks to positions
+    /// played or buffered before land exactly and without a rescan. ADTS
+    /// streams have no index, so they are seeked assuming a constant
+    /// bitrate instead of not at all.
+    private fun buildPlayer(): ExoPlayer {
+        val extractorsFactory = DefaultExtractorsFactory()
+            .setMp3ExtractorFlags(Mp3Extractor.FLAG_ENABLE_INDEX_SEEKING)
+            .setConstantBitrateSeekingEnabled(true)
+        return ExoPlayer.Builder(
+            appContext,
+            DefaultMediaSourceFactory(appContext, extractorsFactory)
+        ).build()
+    }
+
     fun seekToPosition(result: MethodChannel.Result, progress: Long?) {
         if (progress != null) {
             player?.seekTo(progress)
-            sendCurrentDuration()
             result.success(true)
         } else {
             result.success(false)
@@ -111,7 +141,6 @@ class AudioPlayer(
             player?.playWhenReady = true
             player?.play()
             result.success(true)
-            startListening(result)
         } catch (e: Exception) {
             result.error(Constants.LOG_TAG, "Can not start the player", e.toString())
         }
@@ -132,17 +161,16 @@ class AudioPlayer(
     }
 
     fun stop() {
-        stopListening()
         if (playerListener != null) {
             player?.removeListener(playerListener!!)
         }
         isPlayerPrepared = false
         player?.stop()
+        stopListening()
     }
 
 
     fun pause() {
-        stopListening()
         player?.pause()
     }
 
@@ -211,29 +239,34 @@ class AudioPlayer(
         }
     }
 
-    private fun startListening(result: MethodChannel.Result) {
+    /// Playback is extrapolated by Dart from anchors, which are sent when
+    /// playing starts or stops, on seeks and rate changes, and every
+    /// [Constants.ANCHOR_INTERVAL_MS] to correct drift.
+    private fun startListening() {
+        runnable?.let { handler.removeCallbacks(it) }
         runnable = object : Runnable {
             override fun run() {
-                sendCurrentDuration()
-                handler.postDelayed(this, updateFrequency)
+                sendAnchor()
+                handler.postDelayed(this, Constants.ANCHOR_INTERVAL_MS)
             }
         }
         handler.post(runnable!!)
-
     }
 
     private fun stopListening() {
         runnable?.let { handler.removeCallbacks(it) }
-        sendCurrentDuration()
+        runnable = null
+        sendAnchor()
     }
 
-    private fun sendCurrentDuration() {
-        val currentPosition = player?.currentPosition ?: 0
+    private fun sendAnchor() {
         val args: MutableMap<String, Any?> = HashMap()
-        args[Constants.current] = currentPosition
+        args[Constants.current] = player?.currentPosition ?: 0
+        // Monotonic microseconds, Dart only relies on differences between anchors.
+        args[Constants.timestamp] = System.nanoTime() / 1000
+        args[Constants.rate] = (player?.playbackParameters?.speed ?: 1F).toDouble()
+        args[Constants.isPlaying] = player?.isPlaying ?: false
         args[Constants.playerKey] = key
-        methodChannel.invokeMethod(Constants.onCurrentDuration, args)
+        methodChannel.invokeMethod(Constants.onPlaybackAnchor, args)
     }
-
-
 }
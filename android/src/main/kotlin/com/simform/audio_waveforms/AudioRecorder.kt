@@ -3,10 +3,9 @@ package com.simform.audio_waveforms
 import android.Manifest
 import android.app.Activity
 import android.content.pm.PackageManager
-import android.media.MediaMetadataRetriever
-import android.media.MediaMetadataRetriever.METADATA_KEY_DURATION
 import android.media.MediaRecorder
 import android.os.Build
+import android.os.SystemClock
 import android.util.Log
 import androidx.annotation.RequiresApi
 import androidx.core.app.ActivityCompat
@@ -23,6 +22,12 @@ class AudioRecorder : PluginRegistry.RequestPermissionsResultListener {
     private var useLegacyNormalization = false
     private var successCallback: RequestPermissionsSuccessCallback? = null
 
+    // Duration of the recording is kept while recording, so the file isn't
+    // opened again to read it. Time recorded before the last resume, and
+    // when recording last started or resumed, or 0 while paused.
+    private var recordedMillis = 0L
+    private var resumedAt = 0L
+
     fun getDecibel(result: MethodChannel.Result, recorder: MediaRecorder?) {
         if (useLegacyNormalization) {
             val db = 20 * log10(((recorder?.maxAmplitude?.toDouble() ?: (0.0 / 32768.0))))
@@ -63,10 +68,9 @@ class AudioRecorder : PluginRegistry.RequestPermissionsResultListener {
         try {
             val hashMap: HashMap<String, Any?> = HashMap()
             try {
+                val duration = recordedDuration()
                 recorder?.stop()
 
-                val duration = getDuration(path)
-
                 hashMap[Constants.resultFilePath] = path
                 hashMap[Constants.resultDuration] = duration
             } catch (e: RuntimeException) {
@@ -86,24 +90,17 @@ class AudioRecorder : PluginRegistry.RequestPermissionsResultListener {
         }
     }
 
-    private fun getDuration(path: String): Int {
-        val mediaMetadataRetriever = MediaMetadataRetriever()
-        try {
-            mediaMetadataRetriever.setDataSource(path)
-            val duration = mediaMetadataRetriever.extractMetadata(METADATA_KEY_DURATION)
-            return duration?.toInt() ?: -1
-        } catch (e: Exception) {
-            Log.e(LOG_TAG, "Failed to get recording duration")
-        } finally {
-            mediaMetadataRetriever.release()
-        }
-        return -1
+    private fun recordedDuration(): Int {
+        val running = if (resumedAt > 0) SystemClock.elapsedRealtime() - resumedAt else 0
+        return (recordedMillis + running).toInt()
     }
 
     fun startRecorder(result: MethodChannel.Result, recorder: MediaRecorder?, useLegacy: Boolean) {
         try {
             useLegacyNormalization = useLegacy
             recorder?.start()
+            recordedMillis = 0
+            resumedAt = SystemClock.elapsedRealtime()
             result.success(true)
         } catch (e: IllegalStateException) {
             Log.e(LOG_TAG, "Failed to start recording")
@@ -114,6 +111,8 @@ class AudioRecorder : PluginRegistry.RequestPermissionsResultListener {
     fun pauseRecording(result: MethodChannel.Result, recorder: MediaRecorder?) {
         try {
             recorder?.pause()
+            recordedMillis = recordedDuration().toLong()
+            resumedAt = 0
             result.success(false)
         } catch (e: IllegalStateException) {
             Log.e(LOG_TAG, "Failed to pause recording")
@@ -124,6 +123,7 @@ class AudioRecorder : PluginRegistry.RequestPermissionsResultListener {
     fun resumeRecording(result: MethodChannel.Result, recorder: MediaRecorder?) {
         try {
             recorder?.resume()
+            resumedAt = SystemClock.elapsedRealtime()
             result.success(true)
         } catch (e: IllegalStateException) {
             Log.e(LOG_TAG, "Failed to resume recording")
@@ -91,14 +91,12 @@ class AudioWaveformsPlugin : FlutterPlugin, MethodCallHandler, ActivityAware {
                 val audioPath = call.argument(Constants.path) as String?
                 val volume = call.argument(Constants.volume) as Double?
                 val key = call.argument(Constants.playerKey) as String?
-                val frequency = call.argument(Constants.updateFrequency) as Int?
                 if (key != null) {
                     initPlayer(key)
                     audioPlayers[key]?.preparePlayer(
                         result,
                         audioPath,
                         volume?.toFloat(),
-                        frequency?.toLong(),
                     )
                 } else {
                     result.error(Constants.LOG_TAG, "Player key can't be null", "")
@@ -200,12 +198,16 @@ class AudioWaveformsPlugin : FlutterPlugin, MethodCallHandler, ActivityAware {
                 val key = call.argument(Constants.playerKey) as String?
                 val path = call.argument(Constants.path) as String?
                 val noOfSample = call.argument(Constants.noOfSamples) as Int?
+                val progressive = call.argument(Constants.progressive) as Boolean?
+                val channelMode = call.argument(Constants.channelMode) as Int?
                 if (key != null) {
                     createOrUpdateExtractor(
                         playerKey = key,
                         result = result,
                         path = path,
                         noOfSamples = noOfSample ?: 100,
+                        progressive = progressive ?: false,
+                        channelMode = ChannelMode.fromIndex(channelMode),
                     )
                 } else {
                     result.error(Constants.LOG_TAG, "Waveform key can't be null", "")
@@ -292,6 +294,8 @@ class AudioWaveformsPlugin : FlutterPlugin, MethodCallHandler, ActivityAware {
         noOfSamples: Int,
         path: String?,
         result: Result,
+        progressive: Boolean,
+        channelMode: ChannelMode,
     ) {
         if (path == null) {
             result.error(Constants.LOG_TAG, "Path can't be null", "")
@@ -305,10 +309,12 @@ class AudioWaveformsPlugin : FlutterPlugin, MethodCallHandler, ActivityAware {
             key = playerKey,
             path = path,
             result = result,
+            progressive = progressive,
+            channelMode = channelMode,
             extractorCallBack = object : ExtractorCallBack {
                 override fun onProgress(value: Float) {
                     if (value == 1.0F) {
-                        result.success(extractors[playerKey]?.sampleData)
+                        result.success(extractors[playerKey]?.extractionResult())
                     }
                 }
 
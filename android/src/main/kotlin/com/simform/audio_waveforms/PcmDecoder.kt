@@ -0,0 +1,38 @@
+package com.simform.audio_waveforms
+
+import java.nio.ByteBuffer
+
+/// Reads one frame of the little-endian PCM which MediaCodec outputs into
+/// [frame], one sample per channel, scaled to -1..1.
+object PcmDecoder {
+    /// 8-bit PCM is unsigned and centered on 128.
+    fun read8bit(buf: ByteBuffer, frame: FloatArray) {
+        for (channel in frame.indices) {
+            frame[channel] = ((buf.get().toInt() and 0xFF) - 128) / Constants.EIGHT_BITS
+        }
+    }
+
+    /// Only the high byte of 16-bit PCM carries the sign.
+    fun read16bit(buf: ByteBuffer, frame: FloatArray) {
+        for (channel in frame.indices) {
+            val first = buf.get().toInt() and 0xFF
+            val second = buf.get().toInt() shl 8
+            frame[channel] = (first or second) / Constants.SIXTEEN_BITS
+        }
+    }
+
+    /// 32-bit output of MediaCodec is float PCM.
+    fun readFloat(buf: ByteBuffer, frame: FloatArray) {
+        for (channel in frame.indices) {
+            val first = buf.get().toInt() and 0xFF
+            val second = (buf.get().toInt() and 0xFF) shl 8
+            val third = (buf.get().toInt() and 0xFF) shl 16
+            val forth = buf.get().toInt() shl 24
+            frame[channel] = Float.fromBits(first or second or third or forth)
+        }
+    }
+
+    /// The mono downmix of [frame], which the mixed waveform is computed
+    /// from on every platform regardless of the channel mode.
+    fun mono(frame: FloatArray): Float = frame.sum() / frame.size
+}
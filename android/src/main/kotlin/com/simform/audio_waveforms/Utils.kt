@@ -72,6 +72,13 @@ object Constants {
     const val resultFilePath = "resultFilePath"
     const val resultDuration = "resultDuration"
     const val pauseAllPlayers = "pauseAllPlayers"
+    const val progressive = "progressive"
+    const val channelMode = "channelMode"
+    const val channelWaveforms = "channelWaveforms"
+    const val resolutionLevel = "resolutionLevel"
+    const val onPlaybackAnchor = "onPlaybackAnchor"
+    const val timestamp = "timestamp"
+    const val isPlaying = "isPlaying"
 
     /// Indicates 128 bits in a single channel for 8-bit PCM
     const val EIGHT_BITS = 128f
@@ -79,8 +86,34 @@ object Constants {
     /// Indicates 32767 bits in a single channel for 16-bit PCM
     const val SIXTEEN_BITS = 32767f
 
-    /// Indicates 2147483648f bits in a single channel for 32-bit PCM
-    const val THIRTY_TWO_BITS = 2.14748365E9f
+    /// Positions decoded for the preview of a progressive extraction
+    const val PREVIEW_PROBES = 64
+
+    /// Samples decoded at every preview position
+    const val PREVIEW_WINDOW_SAMPLES = 2048
+
+    /// Codec round trips after which a preview position gives up
+    const val PREVIEW_MAX_ATTEMPTS = 32
+
+    const val PREVIEW_TIMEOUT_US = 10_000L
+
+    /// Milliseconds between playback anchors which correct the position
+    /// extrapolated by Dart while playing
+    const val ANCHOR_INTERVAL_MS = 1000L
+}
+
+/// Waveforms extracted besides the mixed one, in the order of the Dart
+/// enum whose index is sent.
+enum class ChannelMode {
+    Mixed,
+    PerChannel,
+
+    /// (L + R) / 2 and (L - R) / 2 of the first two channels
+    MidSide;
+
+    companion object {
+        fun fromIndex(index: Int?): ChannelMode = values().getOrElse(index ?: 0) { Mixed }
+    }
 }
 
 enum class FinishMode(val value: Int) {
@@ -7,8 +7,11 @@ import android.media.MediaExtractor
 import android.media.MediaFormat
 import android.net.Uri
 import android.os.Build
+import android.os.Handler
+import android.os.Looper
 import io.flutter.plugin.common.MethodChannel
 import java.nio.ByteBuffer
+import java.nio.ByteOrder
 import java.util.concurrent.CountDownLatch
 import kotlin.math.pow
 import kotlin.math.sqrt
@@ -21,6 +24,8 @@ class WaveformExtractor(
     private val result: MethodChannel.Result,
     private val extractorCallBack: ExtractorCallBack,
     private val context: Context,
+    private val progressive: Boolean = false,
+    private val channelMode: ChannelMode = ChannelMode.Mixed,
 ) {
     private var decoder: MediaCodec? = null
     private var extractor: MediaExtractor? = null
@@ -37,6 +42,13 @@ class WaveformExtractor(
     private var perSamplePoints = 0L
     private var isReplySubmitted = false
 
+    @Volatile
+    private var isStopped = false
+
+    /// Rough waveform of the whole file for progressive extractions, whose
+    /// points are replaced by the decoded ones as decoding progresses.
+    private var preview: FloatArray? = null
+
     private fun getFormat(path: String): MediaFormat? {
         val mediaExtractor = MediaExtractor()
         this.extractor = mediaExtractor
@@ -56,6 +68,28 @@ class WaveformExtractor(
     }
 
     fun startDecode() {
+        if (!progressive) {
+            decode()
+            return
+        }
+        // The preview is decoded on its own thread, the full decode starts
+        // from the main thread afterwards so its codec callbacks are
+        // delivered where they are without a preview.
+        val mainHandler = Handler(Looper.getMainLooper())
+        Thread {
+            val points = decodePreview()
+            mainHandler.post {
+                if (isStopped) return@post
+                if (points != null) {
+                    preview = points
+                    sendUpdate(points.toList(), 0F, 0)
+                }
+                decode()
+            }
+        }.start()
+    }
+
+    private fun decode() {
         try {
             val format = getFormat(path) ?: error("No audio format found")
             val mime = format.getString(MediaFormat.KEY_MIME) ?: error("No MIME type found")
@@ -112,6 +146,16 @@ class WaveformExtractor(
                         }
                         totalSamples = (sampleRate.toLong() * durationMillis) / 1000
                         perSamplePoints = totalSamples / expectedPoints
+                        frame = FloatArray(channels)
+                        val lanes = when (channelMode) {
+                            ChannelMode.Mixed -> 0
+                            ChannelMode.PerChannel -> channels
+                            ChannelMode.MidSide -> 2
+                        }
+                        if (channelData.size != lanes) {
+                            channelSums = DoubleArray(lanes)
+                            channelData = List(lanes) { ArrayList() }
+                        }
                     }
 
                     override fun onError(codec: MediaCodec, e: MediaCodec.CodecException) {
@@ -180,7 +224,24 @@ class WaveformExtractor(
     private var sampleCount = 0L
     private var sampleSum = 0.0
 
-    private fun handleBufferDivision(value: Float) {
+    /// Waveforms of [channelMode], filled in the same pass as [sampleData].
+    private var channelData: List<ArrayList<Float>> = emptyList()
+    private var channelSums = DoubleArray(0)
+
+    /// Samples of the frame being decoded, one per channel.
+    private var frame = FloatArray(1)
+
+    /// Result to reply with, the waveform points or a map which also holds
+    /// the waveforms of [channelMode].
+    fun extractionResult(): Any {
+        if (channelMode == ChannelMode.Mixed) return sampleData
+        return mapOf(
+            Constants.waveformData to sampleData,
+            Constants.channelWaveforms to channelData,
+        )
+    }
+
+    private fun handleBufferDivision(frame: FloatArray) {
         if (sampleCount == perSamplePoints) {
             updateProgress()
 
@@ -194,46 +255,55 @@ class WaveformExtractor(
         }
 
         sampleCount++
-        sampleSum += value.toDouble().pow(2.0)
+        sampleSum += PcmDecoder.mono(frame).toDouble().pow(2.0)
+        addChannels(frame)
     }
 
-    private fun handle8bit(size: Int, buf: ByteBuffer) {
-        repeat(size / if (channels == 2) 2 else 1) {
-            val result = buf.get().toInt() / Constants.EIGHT_BITS
-            if (channels == 2) {
-                buf.get()
+    private fun addChannels(frame: FloatArray) {
+        when (channelMode) {
+            ChannelMode.Mixed -> return
+            ChannelMode.PerChannel -> for (channel in frame.indices) {
+                channelSums[channel] += frame[channel].toDouble().pow(2.0)
+            }
+            ChannelMode.MidSide -> {
+                val left = frame[0].toDouble()
+                val right = if (frame.size > 1) frame[1].toDouble() else left
+                channelSums[0] += ((left + right) / 2).pow(2.0)
+                channelSums[1] += ((left - right) / 2).pow(2.0)
             }
-            handleBufferDivision(result)
+        }
+    }
+
+    /// Appends a point to every waveform of [channelMode], with the same
+    /// divisor as the mixed point.
+    private fun flushChannels() {
+        for (lane in channelSums.indices) {
+            channelData[lane].add(sqrt(channelSums[lane] / perSamplePoints).toFloat())
+            channelSums[lane] = 0.0
+        }
+    }
+
+    // Every frame is deinterleaved into [frame] in one pass over the
+    // buffer, the mixed waveform is the RMS of its mono downmix.
+
+    private fun handle8bit(size: Int, buf: ByteBuffer) {
+        repeat(size / channels) {
+            PcmDecoder.read8bit(buf, frame)
+            handleBufferDivision(frame)
         }
     }
 
     private fun handle16bit(size: Int, buf: ByteBuffer) {
-        repeat(size / if (channels == 2) 4 else 2) {
-            val first = buf.get().toInt()
-            val second = buf.get().toInt() shl 8
-            val value = (first or second) / Constants.SIXTEEN_BITS
-            if (channels == 2) {
-                buf.get()
-                buf.get()
-            }
-            handleBufferDivision(value)
+        repeat(size / (2 * channels)) {
+            PcmDecoder.read16bit(buf, frame)
+            handleBufferDivision(frame)
         }
     }
 
     private fun handle32bit(size: Int, buf: ByteBuffer) {
-        repeat(size / if (channels == 2) 8 else 4) {
-            val first = buf.get().toLong()
-            val second = buf.get().toLong() shl 8
-            val third = buf.get().toLong() shl 16
-            val forth = buf.get().toLong() shl 24
-            val value = (first or second or third or forth) / Constants.THIRTY_TWO_BITS
-            if (channels == 2) {
-                buf.get()
-                buf.get()
-                buf.get()
-                buf.get()
-            }
-            handleBufferDivision(value)
+        repeat(size / (4 * channels)) {
+            PcmDecoder.readFloat(buf, frame)
+            handleBufferDivision(frame)
         }
     }
 
@@ -244,21 +314,153 @@ class WaveformExtractor(
 
     private fun sendProgress(rms: Float) {
         sampleData.add(rms)
+        flushChannels()
         extractorCallBack.onProgress(progress)
         sampleCount = 0
         sampleSum = 0.0
 
+        val preview = preview
+        if (preview == null) {
+            sendUpdate(sampleData, progress, null)
+            return
+        }
+        // Decoded points replace their preview values in place, so every
+        // update spans the whole file.
+        val points = ArrayList<Float>(maxOf(preview.size, sampleData.size))
+        points.addAll(sampleData)
+        for (i in sampleData.size until preview.size) {
+            points.add(preview[i])
+        }
+        sendUpdate(points, progress, 1)
+    }
+
+    private fun sendUpdate(waveformData: List<Float>, progress: Float, level: Int?) {
         val args: MutableMap<String, Any?> = HashMap()
-        args[Constants.waveformData] = sampleData
+        args[Constants.waveformData] = waveformData
         args[Constants.progress] = progress
         args[Constants.playerKey] = key
+        if (level != null) {
+            args[Constants.resolutionLevel] = level
+        }
         methodChannel.invokeMethod(
             Constants.onCurrentExtractedWaveformData,
             args
         )
     }
 
+    /// Decodes a short window at evenly spaced positions of the file. This
+    /// gives a rough waveform of the whole file while decoding a small
+    /// fraction of it, instead of bars filling in from the start.
+    private fun decodePreview(): FloatArray? {
+        val probes = minOf(expectedPoints, Constants.PREVIEW_PROBES)
+        if (probes <= 0) return null
+        val mediaExtractor = MediaExtractor()
+        var codec: MediaCodec? = null
+        return try {
+            mediaExtractor.setDataSource(context, Uri.parse(path), null)
+            val track = (0 until mediaExtractor.trackCount).firstOrNull {
+                val mime = mediaExtractor.getTrackFormat(it).getString(MediaFormat.KEY_MIME)
+                mime?.contains("audio") == true
+            } ?: return null
+            val format = mediaExtractor.getTrackFormat(track)
+            val mime = format.getString(MediaFormat.KEY_MIME) ?: return null
+            val durationUs = format.getLong(MediaFormat.KEY_DURATION)
+            mediaExtractor.selectTrack(track)
+            val decoder = MediaCodec.createDecoderByType(mime)
+            codec = decoder
+            decoder.configure(format, null, null, 0)
+            decoder.start()
+
+            val levels = FloatArray(probes)
+            for (probe in 0 until probes) {
+                if (isStopped) return null
+                val timeUs = durationUs * (2 * probe + 1) / (2 * probes)
+                mediaExtractor.seekTo(timeUs, MediaExtractor.SEEK_TO_PREVIOUS_SYNC)
+                decoder.flush()
+                levels[probe] = decodeWindow(decoder, mediaExtractor)
+            }
+            FloatArray(expectedPoints) { levels[it * probes / expectedPoints] }
+        } catch (e: Exception) {
+            null
+        } finally {
+            try {
+                codec?.stop()
+            } catch (e: IllegalStateException) {
+                // Already stopped or in an error state, releasing is enough.
+            }
+            codec?.release()
+            mediaExtractor.release()
+        }
+    }
+
+    /// Returns the RMS of the samples decoded from the current position of
+    /// [mediaExtractor], all channels included.
+    private fun decodeWindow(codec: MediaCodec, mediaExtractor: MediaExtractor): Float {
+        val info = MediaCodec.BufferInfo()
+        var sum = 0.0
+        var count = 0
+        var inputEof = false
+        var attempts = 0
+        while (count < Constants.PREVIEW_WINDOW_SAMPLES &&
+            attempts++ < Constants.PREVIEW_MAX_ATTEMPTS
+        ) {
+            if (!inputEof) {
+                val inputIndex = codec.dequeueInputBuffer(Constants.PREVIEW_TIMEOUT_US)
+                val buffer = if (inputIndex >= 0) codec.getInputBuffer(inputIndex) else null
+                if (buffer != null) {
+                    val size = mediaExtractor.readSampleData(buffer, 0)
+                    if (size < 0) {
+                        codec.queueInputBuffer(
+                            inputIndex,
+                            0,
+                            0,
+                            0,
+                            MediaCodec.BUFFER_FLAG_END_OF_STREAM
+                        )
+                        inputEof = true
+                    } else {
+                        codec.queueInputBuffer(inputIndex, 0, size, mediaExtractor.sampleTime, 0)
+                        mediaExtractor.advance()
+                    }
+                }
+            }
+            val outputIndex = codec.dequeueOutputBuffer(info, Constants.PREVIEW_TIMEOUT_US)
+            if (outputIndex < 0) continue
+            val buffer = codec.getOutputBuffer(outputIndex)
+            if (buffer != null && info.size > 0) {
+                buffer.position(info.offset)
+                buffer.limit(info.offset + info.size)
+                val samples = buffer.order(ByteOrder.nativeOrder())
+                if (isFloatOutput(codec.outputFormat)) {
+                    val floats = samples.asFloatBuffer()
+                    while (floats.hasRemaining()) {
+                        val value = floats.get().toDouble()
+                        sum += value * value
+                        count++
+                    }
+                } else {
+                    val shorts = samples.asShortBuffer()
+                    while (shorts.hasRemaining()) {
+                        val value = shorts.get() / Constants.SIXTEEN_BITS.toDouble()
+                        sum += value * value
+                        count++
+                    }
+                }
+            }
+            codec.releaseOutputBuffer(outputIndex, false)
+            if (info.isEof()) break
+        }
+        return if (count > 0) sqrt(sum / count).toFloat() else 0F
+    }
+
+    private fun isFloatOutput(format: MediaFormat): Boolean {
+        return Build.VERSION.SDK_INT >= Build.VERSION_CODES.N &&
+                format.containsKey(MediaFormat.KEY_PCM_ENCODING) &&
+                format.getInteger(MediaFormat.KEY_PCM_ENCODING) == AudioFormat.ENCODING_PCM_FLOAT
+    }
+
     fun stop() {
+        isStopped = true
         decoder?.stop()
         decoder?.release()
         extractor?.release()
@@ -0,0 +1,63 @@
+package com.simform.audio_waveforms
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import org.junit.Test
+
+class PcmDecoderTest {
+    private fun bytes(vararg values: Int): ByteBuffer =
+        ByteBuffer.wrap(ByteArray(values.size) { values[it].toByte() })
+
+    @Test
+    fun read8bitTreatsSamplesAsUnsigned() {
+        val frame = FloatArray(3)
+
+        PcmDecoder.read8bit(bytes(0x00, 0x80, 0xFF), frame)
+
+        assertArrayEquals(floatArrayOf(-1f, 0f, 127 / 128f), frame, 1e-6f)
+    }
+
+    @Test
+    fun read16bitDoesNotSignExtendTheLowByte() {
+        val frame = FloatArray(2)
+
+        // 0x00FF and 0x80FF, whose low bytes have the sign bit set.
+        PcmDecoder.read16bit(bytes(0xFF, 0x00, 0xFF, 0x80), frame)
+
+        assertArrayEquals(
+            floatArrayOf(255 / 32767f, -32513 / 32767f),
+            frame,
+            1e-6f,
+        )
+    }
+
+    @Test
+    fun readFloatReadsFloatSamples() {
+        val buf = ByteBuffer.allocate(8).order(ByteOrder.LITTLE_ENDIAN)
+        buf.putFloat(0.5f).putFloat(-0.25f).flip()
+        val frame = FloatArray(2)
+
+        PcmDecoder.readFloat(buf, frame)
+
+        assertArrayEquals(floatArrayOf(0.5f, -0.25f), frame, 0f)
+    }
+
+    @Test
+    fun monoAveragesEveryChannel() {
+        assertEquals(0.25f, PcmDecoder.mono(floatArrayOf(1f, -0.5f)), 0f)
+        assertEquals(0.5f, PcmDecoder.mono(floatArrayOf(0.5f)), 0f)
+    }
+
+    @Test
+    fun readsOneFrameOfEveryChannel() {
+        val buf = bytes(0x00, 0x01, 0x00, 0x02, 0x00, 0x03)
+        val frame = FloatArray(2)
+
+        PcmDecoder.read16bit(buf, frame)
+
+        assertArrayEquals(floatArrayOf(256 / 32767f, 512 / 32767f), frame, 1e-6f)
+        assertEquals(2, buf.remaining())
+    }
+}
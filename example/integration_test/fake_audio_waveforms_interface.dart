@@ -0,0 +1,403 @@
+import 'dart:async';
+import 'dart:math' as math;
+
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:audio_waveforms/audio_waveforms.dart';
+import 'package:audio_waveforms/src/base/constants.dart';
+import 'package:audio_waveforms/src/base/playback_clock.dart';
+import 'package:audio_waveforms/src/models/recorder_settings.dart';
+
+/// Deterministic stand-in for the native side of the plugin.
+///
+/// Calls are answered locally, but every call, result and event is encoded
+/// with the codec of the real method channel so the traffic a native
+/// backend would cause can be measured. Playback and extraction events are
+/// delivered through the method channel and decoded by the plugin's own
+/// handler, the same way native events are.
+class FakeAudioWaveformsInterface extends AudioWaveformsInterface {
+  FakeAudioWaveformsInterface({
+    this.fileDuration = const Duration(seconds: 5),
+    this.extractionSteps = 4,
+  }) : super.test();
+
+  static const _codec = StandardMethodCodec();
+
+  /// Duration reported for every prepared file.
+  final Duration fileDuration;
+
+  /// Number of progress events sent while extracting a waveform.
+  final int extractionSteps;
+
+  /// Bytes sent from Dart to the fake backend.
+  int bytesSent = 0;
+
+  /// Bytes sent from the fake backend to Dart, results and events included.
+  int bytesReceived = 0;
+
+  /// Number of method calls made by the plugin.
+  int callCount = 0;
+
+  /// Number of events delivered to the plugin.
+  int eventCount = 0;
+
+  final Map<String, _FakePlayer> _players = {};
+  final Set<String> _extractions = {};
+  int _decibelTick = 0;
+  bool _recording = false;
+
+  /// Keys of players which were prepared but not released yet.
+  Iterable<String> get residentPlayers => _players.keys;
+
+  /// Keys of waveform extractions which haven't completed or been stopped.
+  Iterable<String> get runningExtractions => _extractions;
+
+  bool get isRecording => _recording;
+
+  void resetTraffic() {
+    bytesSent = 0;
+    bytesReceived = 0;
+    callCount = 0;
+    eventCount = 0;
+  }
+
+  void _account(String method, Object? arguments, Object? result) {
+    callCount++;
+    bytesSent +=
+        _codec.encodeMethodCall(MethodCall(method, arguments)).lengthInBytes;
+    bytesReceived += _codec.encodeSuccessEnvelope(result).lengthInBytes;
+  }
+
+  Future<void> _emit(String method, Map<String, Object?> arguments) async {
+    final message = _codec.encodeMethodCall(MethodCall(method, arguments));
+    eventCount++;
+    bytesReceived += message.lengthInBytes;
+    await TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .handlePlatformMessage(Constants.methodChannelName, message, (_) {});
+  }
+
+  @override
+  Future<bool> record({
+    required RecorderSettings recorderSetting,
+    String? path,
+    bool useLegacyNormalization = false,
+    bool overrideAudioSession = true,
+  }) async {
+    _account(
+      Constants.startRecording,
+      recorderSetting.androidToJson(path: path),
+      true,
+    );
+    _recording = true;
+    return true;
+  }
+
+  @override
+  Future<bool> initRecorder({
+    String? path,
+    required RecorderSettings recorderSettings,
+  }) async {
+    _account(
+      Constants.initRecorder,
+      recorderSettings.androidToJson(path: path),
+      true,
+    );
+    return true;
+  }
+
+  @override
+  Future<bool> checkPermission() async {
+    _account(Constants.checkPermission, null, true);
+    return true;
+  }
+
+  @override
+  Future<double?> getDecibel() async {
+    // A slow sweep keeps the recorder waveform moving deterministically.
+    final db = 0.5 + 0.5 * math.sin(_decibelTick++ / 8);
+    _account(Constants.getDecibel, null, db);
+    return db;
+  }
+
+  @override
+  Future<bool?> pause() async {
+    _account(Constants.pauseRecording, null, true);
+    return true;
+  }
+
+  @override
+  Future<bool> resume() async {
+    _account(Constants.resumeRecording, null, true);
+    return true;
+  }
+
+  @override
+  Future<Map<String, dynamic>> stop() async {
+    final result = <String, dynamic>{
+      Constants.resultDuration: 1000,
+      Constants.resultFilePath: 'test.m4a',
+    };
+    _account(Constants.stopRecording, null, result);
+    _recording = false;
+    return result;
+  }
+
+  @override
+  Future<bool> preparePlayer({
+    required String path,
+    required String key,
+    required int frequency,
+    double? volume,
+    bool overrideAudioSession = false,
+  }) async {
+    _account(Constants.preparePlayer, {
+      Constants.path: path,
+      Constants.volume: volume,
+      Constants.playerKey: key,
+      Constants.updateFrequency: frequency,
+      Constants.overrideAudioSession: overrideAudioSession,
+    }, true);
+    _players.remove(key)?.cancel();
+    _players[key] = _FakePlayer();
+    return true;
+  }
+
+  @override
+  Future<bool> startPlayer(String key) async {
+    _account(Constants.startPlayer, {Constants.playerKey: key}, true);
+    final player = _players[key];
+    if (player == null) return false;
+    player.setPosition(player.position);
+    player.isPlaying = true;
+    _schedule(key, player);
+    return true;
+  }
+
+  /// Sends an anchor and, while playing, schedules the drift corrections
+  /// and the completion the way native players do.
+  void _schedule(String key, _FakePlayer player) {
+    player.cancel();
+    _anchor(key, player);
+    if (!player.isPlaying) return;
+    player.timer = Timer.periodic(
+      const Duration(seconds: 1),
+      (_) => _anchor(key, player),
+    );
+    final remaining = fileDuration.inMilliseconds - player.position;
+    player.completion = Timer(
+      Duration(milliseconds: math.max(0, remaining ~/ player.rate)),
+      () => _finish(key, player),
+    );
+  }
+
+  void _anchor(String key, _FakePlayer player) {
+    player.setPosition(player.position);
+    _emit(Constants.onPlaybackAnchor, {
+      Constants.current: player.position,
+      Constants.timestamp: PlaybackClock.now(),
+      Constants.rate: player.rate,
+      Constants.isPlaying: player.isPlaying,
+      Constants.playerKey: key,
+    });
+  }
+
+  void _finish(String key, _FakePlayer player) {
+    player.isPlaying = false;
+    player.setPosition(0);
+    _schedule(key, player);
+    _emit(Constants.onDidFinishPlayingAudio, {
+      Constants.finishType: player.finishMode.index,
+      Constants.playerKey: key,
+    });
+  }
+
+  @override
+  Future<bool> pausePlayer(String key) async {
+    _account(Constants.pausePlayer, {Constants.playerKey: key}, true);
+    final player = _players[key];
+    if (player != null) {
+      player.setPosition(player.position);
+      player.isPlaying = false;
+      _schedule(key, player);
+    }
+    return true;
+  }
+
+  @override
+  Future<bool> stopPlayer(String key) async {
+    _account(Constants.stopPlayer, {Constants.playerKey: key}, true);
+    final player = _players[key];
+    if (player != null) {
+      player.isPlaying = false;
+      player.setPosition(0);
+      _schedule(key, player);
+    }
+    return true;
+  }
+
+  @override
+  Future<bool> release(String key) async {
+    _account(Constants.releasePlayer, {Constants.playerKey: key}, true);
+    _players.remove(key)?.cancel();
+    return true;
+  }
+
+  @override
+  Future<int?> getDuration(String key, int durationType) async {
+    final player = _players[key];
+    final duration = durationType == DurationType.current.index
+        ? player?.position
+        : fileDuration.inMilliseconds;
+    _account(Constants.getDuration, {
+      Constants.durationType: durationType,
+      Constants.playerKey: key,
+    }, duration);
+    return duration;
+  }
+
+  @override
+  Future<bool> setVolume(double volume, String key) async {
+    _account(Constants.setVolume, {
+      Constants.volume: volume,
+      Constants.playerKey: key,
+    }, true);
+    return true;
+  }
+
+  @override
+  Future<bool> setRate(double rate, String key) async {
+    _account(Constants.setRate, {
+      Constants.rate: rate,
+      Constants.playerKey: key,
+    }, true);
+    final player = _players[key];
+    if (player != null) {
+      player.setPosition(player.position);
+      player.rate = rate;
+      _schedule(key, player);
+    }
+    return true;
+  }
+
+  @override
+  Future<bool> seekTo(String key, int progress) async {
+    _account(Constants.seekTo, {
+      Constants.progress: progress,
+      Constants.playerKey: key,
+    }, true);
+    final player = _players[key];
+    if (player != null) {
+      player.setPosition(
+        progress.clamp(0, fileDuration.inMilliseconds).toInt(),
+      );
+      _schedule(key, player);
+    }
+    return true;
+  }
+
+  @override
+  Future<void> setReleaseMode(String key, FinishMode finishMode) async {
+    _account(Constants.finishMode, {
+      Constants.finishType: finishMode.index,
+      Constants.playerKey: key,
+    }, null);
+    _players[key]?.finishMode = finishMode;
+  }
+
+  @override
+  Future<WaveformExtractionResult> extractWaveformData({
+    required String key,
+    required String path,
+    required int noOfSamples,
+    SilenceDetection? silenceDetection,
+    bool measureLoudness = false,
+    bool progressive = false,
+    ChannelMode channelMode = ChannelMode.mixed,
+  }) async {
+    final arguments = {
+      Constants.playerKey: key,
+      Constants.path: path,
+      Constants.noOfSamples: noOfSamples,
+      ...?silenceDetection?.toJson(),
+      if (measureLoudness) Constants.measureLoudness: true,
+      if (progressive) Constants.progressive: true,
+      if (channelMode != ChannelMode.mixed)
+        Constants.channelMode: channelMode.index,
+    };
+    _extractions.add(key);
+    final waveform = List<double>.generate(
+      noOfSamples,
+      (i) => 0.5 + 0.5 * math.sin(i * 2 * math.pi / 50),
+    );
+    // Native backends send the samples extracted so far with every update.
+    for (var step = 1; step <= extractionSteps; step++) {
+      await Future<void>.delayed(Duration.zero);
+      if (!_extractions.contains(key)) break;
+      final count = noOfSamples * step ~/ extractionSteps;
+      await _emit(Constants.onCurrentExtractedWaveformData, {
+        Constants.playerKey: key,
+        Constants.progress: step / extractionSteps,
+        Constants.waveformData: waveform.sublist(0, count),
+      });
+    }
+    _extractions.remove(key);
+    _account(Constants.extractWaveformData, arguments, waveform);
+    return WaveformExtractionResult(waveformData: waveform);
+  }
+
+  @override
+  Future<void> stopWaveformExtraction(String key) async {
+    _account(Constants.stopExtraction, {Constants.playerKey: key}, null);
+    _extractions.remove(key);
+  }
+
+  @override
+  Future<bool> stopAllPlayers() async {
+    _account(Constants.stopAllPlayers, null, true);
+    for (final player in _players.values) {
+      player.cancel();
+    }
+    _players.clear();
+    return true;
+  }
+
+  @override
+  Future<bool> pauseAllPlayers() async {
+    _account(Constants.pauseAllPlayers, null, true);
+    for (final entry in _players.entries) {
+      entry.value.setPosition(entry.value.position);
+      entry.value.isPlaying = false;
+      _schedule(entry.key, entry.value);
+    }
+    return true;
+  }
+}
+
+class _FakePlayer {
+  int _position = 0;
+  int _time = PlaybackClock.now();
+  double rate = 1.0;
+  bool isPlaying = false;
+  FinishMode finishMode = FinishMode.stop;
+  Timer? timer;
+  Timer? completion;
+
+  /// Position in milliseconds, advancing with the rate while playing.
+  int get position {
+    if (!isPlaying) return _position;
+    return _position + (PlaybackClock.now() - _time) * rate ~/ 1000;
+  }
+
+  void setPosition(int position) {
+    _position = position;
+    _time = PlaybackClock.now();
+  }
+
+  void cancel() {
+    timer?.cancel();
+    timer = null;
+    completion?.cancel();
+    completion = null;
+  }
+}
@@ -0,0 +1,199 @@
+import 'dart:io';
+import 'dart:ui';
+
+import 'package:flutter/material.dart';
+import 'package:flutter/scheduler.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:integration_test/integration_test.dart';
+
+import 'package:audio_waveforms/audio_waveforms.dart';
+import 'package:audio_waveforms/src/base/platform_streams.dart';
+
+import 'fake_audio_waveforms_interface.dart';
+
+// Soak test of the plugin against a fake backend. Run it with
+//
+//   flutter drive --profile --driver=test_driver/integration_test.dart \
+//       --target=integration_test/performance_test.dart
+//
+// to get the summary in build/integration_response_data.json, or with
+// `flutter test integration_test/performance_test.dart` for a quick check.
+
+/// Players and recorders on screen at the same time in every cycle.
+const _playerCount = 12;
+const _recorderCount = 2;
+
+/// Number of prepare, extract, play, seek and dispose cycles.
+const _cycles = 8;
+
+const _noOfSamples = 200;
+
+// Budgets the harness fails on. Frame budgets leave room for debug builds,
+// profile builds are expected to stay well below them.
+const _maxAverageBuildMs = 16.0;
+const _maxP90BuildMs = 32.0;
+const _maxAverageRasterMs = 16.0;
+const _maxP90RasterMs = 32.0;
+const _maxChannelBytesPerCycle = 256 * 1024;
+const _maxRssGrowthBytes = 96 * 1024 * 1024;
+
+void main() {
+  final binding = IntegrationTestWidgetsFlutterBinding.ensureInitialized();
+
+  testWidgets('concurrent players and recorders stay within budget',
+      (tester) async {
+    binding.framePolicy = LiveTestWidgetsFlutterBindingFramePolicy.fullyLive;
+    final backend = FakeAudioWaveformsInterface();
+    AudioWaveformsInterface.setInstance(backend);
+
+    final timings = <FrameTiming>[];
+    void onTimings(List<FrameTiming> batch) => timings.addAll(batch);
+    SchedulerBinding.instance.addTimingsCallback(onTimings);
+    addTearDown(
+      () => SchedulerBinding.instance.removeTimingsCallback(onTimings),
+    );
+
+    final rssAtStart = ProcessInfo.currentRss;
+    final channelBytes = <int>[];
+
+    for (var cycle = 0; cycle < _cycles; cycle++) {
+      backend.resetTraffic();
+      final players = List.generate(
+        _playerCount,
+        (_) => PlayerController()..updateFrequency = UpdateFrequency.high,
+      );
+      final recorders =
+          List.generate(_recorderCount, (_) => RecorderController());
+
+      await tester.pumpWidget(
+        _Harness(players: players, recorders: recorders),
+      );
+      await Future.wait([
+        for (var i = 0; i < players.length; i++)
+          players[i].preparePlayer(
+            path: 'cycle-$cycle-$i.m4a',
+            noOfSamples: _noOfSamples,
+          ),
+      ]);
+      for (final recorder in recorders) {
+        await recorder.record();
+      }
+      await Future.wait(players.map((player) => player.startPlayer()));
+      await tester.pump(const Duration(milliseconds: 500));
+
+      await Future.wait([
+        for (var i = 0; i < players.length; i++)
+          players[i].seekTo(backend.fileDuration.inMilliseconds * i ~/ 20),
+      ]);
+      await tester.pump(const Duration(milliseconds: 300));
+
+      await Future.wait(players.map((player) => player.pausePlayer()));
+      for (final recorder in recorders) {
+        await recorder.stop();
+      }
+      await tester.pump();
+
+      // Widgets must drop their subscriptions when they are unmounted, while
+      // the controllers are still alive.
+      await tester.pumpWidget(const SizedBox.shrink());
+      expect(PlatformStreams.instance.hasListeners, isFalse,
+          reason: 'subscriptions leaked by widgets in cycle $cycle');
+
+      for (final player in players) {
+        player.dispose();
+      }
+      for (final recorder in recorders) {
+        recorder.dispose();
+      }
+      // PlayerController.dispose completes asynchronously.
+      await tester.pump(const Duration(milliseconds: 100));
+
+      expect(PlatformStreams.instance.playerControllerFactory, isEmpty,
+          reason: 'controllers leaked in cycle $cycle');
+      expect(PlatformStreams.instance.isInitialised, isFalse);
+      expect(backend.residentPlayers, isEmpty,
+          reason: 'players not released in cycle $cycle');
+      expect(backend.runningExtractions, isEmpty);
+      expect(backend.isRecording, isFalse);
+
+      channelBytes.add(backend.bytesSent + backend.bytesReceived);
+    }
+
+    final builds = timings.map((t) => t.buildDuration).toList();
+    final rasters = timings.map((t) => t.rasterDuration).toList();
+    final rssGrowth = ProcessInfo.maxRss - rssAtStart;
+    final maxChannelBytes = channelBytes.reduce((a, b) => a > b ? a : b);
+    final summary = <String, dynamic>{
+      'frame_count': timings.length,
+      'average_build_ms': _averageMs(builds),
+      'p90_build_ms': _percentileMs(builds, 0.9),
+      'average_raster_ms': _averageMs(rasters),
+      'p90_raster_ms': _percentileMs(rasters, 0.9),
+      'channel_bytes_per_cycle': channelBytes,
+      'peak_rss_bytes': ProcessInfo.maxRss,
+      'rss_growth_bytes': rssGrowth,
+    };
+    binding.reportData = {'performance': summary};
+
+    expect(timings, isNotEmpty);
+    expect(
+      summary['average_build_ms'],
+      lessThanOrEqualTo(_maxAverageBuildMs),
+    );
+    expect(summary['p90_build_ms'], lessThanOrEqualTo(_maxP90BuildMs));
+    expect(
+      summary['average_raster_ms'],
+      lessThanOrEqualTo(_maxAverageRasterMs),
+    );
+    expect(summary['p90_raster_ms'], lessThanOrEqualTo(_maxP90RasterMs));
+    expect(maxChannelBytes, lessThanOrEqualTo(_maxChannelBytesPerCycle));
+    expect(rssGrowth, lessThanOrEqualTo(_maxRssGrowthBytes));
+  });
+}
+
+double _averageMs(List<Duration> durations) {
+  if (durations.isEmpty) return 0;
+  final total = durations.fold<int>(0, (sum, d) => sum + d.inMicroseconds);
+  return total / durations.length / 1000;
+}
+
+double _percentileMs(List<Duration> durations, double percentile) {
+  if (durations.isEmpty) return 0;
+  final sorted = durations.map((d) => d.inMicroseconds).toList()..sort();
+  final index = ((sorted.length * percentile).ceil() - 1)
+      .clamp(0, sorted.length - 1)
+      .toInt();
+  return sorted[index] / 1000;
+}
+
+class _Harness extends StatelessWidget {
+  const _Harness({required this.players, required this.recorders});
+
+  final List<PlayerController> players;
+  final List<RecorderController> recorders;
+
+  @override
+  Widget build(BuildContext context) {
+    return MaterialApp(
+      home: Scaffold(
+        // Every waveform is mounted, unlike in a lazily built list.
+        body: SingleChildScrollView(
+          child: Column(
+            children: [
+              for (final recorder in recorders)
+                AudioWaveforms(
+                  size: const Size(300, 50),
+                  recorderController: recorder,
+                ),
+              for (final player in players)
+                AudioFileWaveforms(
+                  size: const Size(300, 40),
+                  playerController: player,
+                ),
+            ],
+          ),
+        ),
+      ),
+    );
+  }
+}
@@ -0,0 +1,6 @@
+import 'package:integration_test/integration_test_driver.dart';
+
+/// Writes the data reported by integration tests, such as the performance
+/// summary, to `build/integration_response_data.json`.
+Future<void> main() =>
+    integrationDriver(responseDataCallback: writeResponseData);
@@ -8,7 +8,6 @@ class AudioPlayer: NSObject, AVAudioPlayerDelegate {
     private var timer: Timer?
     private var player: AVAudioPlayer?
     private var finishMode:FinishMode = FinishMode.stop
-    private var updateFrequency = 200
     var plugin: SwiftAudioWaveformsPlugin
     var playerKey: String
     var flutterChannel: FlutterMethodChannel
@@ -20,9 +19,8 @@ class AudioPlayer: NSObject, AVAudioPlayerDelegate {
         flutterChannel = channel
     }
     
-    func preparePlayer(path: String?, volume: Double?, updateFrequency: Int?,result: @escaping FlutterResult, overrideAudioSession : Bool) {
+    func preparePlayer(path: String?, volume: Double?, result: @escaping FlutterResult, overrideAudioSession : Bool) {
         if(!(path ?? "").isEmpty) {
-            self.updateFrequency = updateFrequency ?? 200
             let audioUrl = URL.init(string: path!)
             if(audioUrl == nil){
                 result(FlutterError(code: Constants.audioWaveforms, message: "Failed to initialise Url from provided audio file", details: "If path contains `file://` try removing it"))
@@ -63,6 +61,7 @@ class AudioPlayer: NSObject, AVAudioPlayerDelegate {
         case .loop:
             self.player?.currentTime = 0
             self.player?.play()
+            sendAnchor()
             finishType = 0
 
         case .pause:
@@ -94,14 +93,13 @@ class AudioPlayer: NSObject, AVAudioPlayerDelegate {
 
 
     func pausePlayer() {
-        stopListening()
         player?.pause()
+        stopListening()
     }
     
     func stopPlayer() {
-        stopListening()
         player?.stop()
-        timer = nil
+        stopListening()
     }
     
     func release(result: @escaping FlutterResult) {
@@ -126,13 +124,14 @@ class AudioPlayer: NSObject, AVAudioPlayerDelegate {
 
     func setRate(_ rate: Double?, _ result: @escaping FlutterResult) {
         player?.rate = Float(rate ?? 1.0);
+        sendAnchor()
         result(true)
     }
 
     func seekTo(_ time: Int?, _ result: @escaping FlutterResult) {
         if(time != nil) {
-            player?.currentTime = Double(time! / 1000)
-            sendCurrentDuration()
+            player?.currentTime = Double(time!) / 1000
+            sendAnchor()
             result(true)
         } else {
             result(false)
@@ -150,10 +149,15 @@ class AudioPlayer: NSObject, AVAudioPlayerDelegate {
         result(nil)
     }
 
+    /// Playback is extrapolated by Dart from anchors, which are sent when
+    /// playing starts or stops, on seeks and rate changes, and every
+    /// `Constants.anchorInterval` to correct drift.
     func startListening() {
+        timer?.invalidate()
+        sendAnchor()
         if #available(iOS 10.0, *) {
-            timer = Timer.scheduledTimer(withTimeInterval: (Double(updateFrequency) / 1000), repeats: true, block: { _ in
-                self.sendCurrentDuration()
+            timer = Timer.scheduledTimer(withTimeInterval: Constants.anchorInterval, repeats: true, block: { _ in
+                self.sendAnchor()
             })
         } else {
             // Fallback on earlier versions
@@ -163,11 +167,18 @@ class AudioPlayer: NSObject, AVAudioPlayerDelegate {
     func stopListening() {
         timer?.invalidate()
         timer = nil
-        sendCurrentDuration()
+        sendAnchor()
     }
 
-    func sendCurrentDuration() {
+    func sendAnchor() {
         let ms = (player?.currentTime ?? 0) * 1000
-        flutterChannel.invokeMethod(Constants.onCurrentDuration, arguments: [Constants.current: Int(ms), Constants.playerKey: playerKey])
+        // Monotonic microseconds, Dart only relies on differences between anchors.
+        let timestamp = DispatchTime.now().uptimeNanoseconds / 1000
+        flutterChannel.invokeMethod(Constants.onPlaybackAnchor, arguments: [
+            Constants.current: Int(ms),
+            Constants.timestamp: Int(timestamp),
+            Constants.rate: Double(player?.rate ?? 1.0),
+            Constants.isPlaying: player?.isPlaying ?? false,
+            Constants.playerKey: playerKey])
     }
 }
@@ -53,7 +53,6 @@ public class SwiftAudioWaveformsPlugin: NSObject, FlutterPlugin {
                 initPlayer(playerKey: key!)
                 audioPlayers[key!]?.preparePlayer(path: args?[Constants.path] as? String,
                                                   volume: args?[Constants.volume] as? Double,
-                                                  updateFrequency: args?[Constants.updateFrequency] as? Int,
                                                   result: result,
                                                   overrideAudioSession: (args?[Constants.overrideAudioSession] as? Bool) ?? false)
             } else {
@@ -156,11 +155,17 @@ public class SwiftAudioWaveformsPlugin: NSObject, FlutterPlugin {
             }
             let path = args?[Constants.path] as? String
             let noOfSamples = args?[Constants.noOfSamples] as? Int
+            let progressive = args?[Constants.progressive] as? Bool ?? false
+            let channelMode = ChannelMode(
+                rawValue: args?[Constants.channelMode] as? Int ?? 0
+            ) ?? .mixed
             createOrUpdateExtractor(
                 playerKey: key,
                 result: result,
                 path: path,
-                noOfSamples: noOfSamples
+                noOfSamples: noOfSamples,
+                progressive: progressive,
+                channelMode: channelMode
             )
         case Constants.stopExtraction:
             guard let key = args?[Constants.playerKey] as? String else {
@@ -189,7 +194,7 @@ public class SwiftAudioWaveformsPlugin: NSObject, FlutterPlugin {
         }
     }
     
-    func createOrUpdateExtractor(playerKey: String, result: @escaping FlutterResult,path: String?, noOfSamples: Int?) {
+    func createOrUpdateExtractor(playerKey: String, result: @escaping FlutterResult,path: String?, noOfSamples: Int?, progressive: Bool = false, channelMode: ChannelMode = .mixed) {
         if(!(path ?? "").isEmpty) {
             do {
                 let audioUrl = URL.init(string: path!)
@@ -199,14 +204,27 @@ public class SwiftAudioWaveformsPlugin: NSObject, FlutterPlugin {
                 }
                 extractors[playerKey]?.cancel()
                 let newExtractor = try WaveformExtractor(url: audioUrl!, flutterResult: result, channel: flutterChannel)
+                newExtractor.channelMode = channelMode
                 extractors[playerKey] = newExtractor
                 Task {
-                    let data = await newExtractor
-                        .extractWaveform(samplesPerPixel: noOfSamples, playerKey: playerKey)
+                    let data: FloatChannelData?
+                    if progressive {
+                        data = await newExtractor
+                            .extractWaveformProgressively(samplesPerPixel: noOfSamples, playerKey: playerKey)
+                    } else {
+                        data = await newExtractor
+                            .extractWaveform(samplesPerPixel: noOfSamples, playerKey: playerKey)
+                    }
                     if(newExtractor.progress == 1.0) {
-                        let waveformData = newExtractor.getChannelMean(data: data!)
+                        let waveformData = newExtractor.mixedWaveform(data: data!)
+                        let reply: Any = channelMode == .mixed
+                            ? waveformData
+                            : [
+                                Constants.waveformData: waveformData,
+                                Constants.channelWaveforms: newExtractor.channelWaveforms(data: data!)
+                            ]
                         DispatchQueue.main.async {
-                            result(waveformData)
+                            result(reply)
                         }
                     }
                 }
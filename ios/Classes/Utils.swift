@@ -68,6 +68,18 @@ struct Constants {
     static let linearPCMIsFloat = "linearPCMIsFloat";
     static let pauseAllPlayers = "pauseAllPlayers"
     static let stopExtraction = "stopExtraction"
+    static let progressive = "progressive"
+    static let channelMode = "channelMode"
+    static let channelWaveforms = "channelWaveforms"
+    static let resolutionLevel = "resolutionLevel"
+    static let onPlaybackAnchor = "onPlaybackAnchor"
+    static let timestamp = "timestamp"
+    static let isPlaying = "isPlaying"
+    /// Points read by the coarsest level of a progressive extraction
+    static let coarsestPoints = 16
+    /// Seconds between playback anchors which correct the position
+    /// extrapolated by Dart while playing
+    static let anchorInterval = 1.0
 }
 
 
@@ -81,6 +93,15 @@ public extension RangeReplaceableCollection where Iterator.Element: ExpressibleB
     }
 }
 
+/// Waveforms extracted besides the mixed one, in the order of the Dart enum
+/// whose index is sent.
+enum ChannelMode : Int {
+    case mixed = 0
+    case perChannel = 1
+    /// (L + R) / 2 and (L - R) / 2 of the first two channels
+    case midSide = 2
+}
+
 enum FinishMode : Int{
     case loop = 0
     case pause = 1
@@ -8,7 +8,10 @@ public class WaveformExtractor {
     var flutterChannel: FlutterMethodChannel
     private var waveformData = Array<Float>()
     var progress: Float = 0.0
-    var channelCount: Int = 1
+    /// Waveforms stored after the mixed one: none for `.mixed`, the
+    /// channels for `.perChannel` and the mid and side waveforms for
+    /// `.midSide`.
+    var channelMode: ChannelMode = .mixed
     private var currentProgress: Float = 0.0
     private let abortWaveformDataQueue = DispatchQueue(
         label: "WaveformExtractor",
@@ -62,7 +65,7 @@ public class WaveformExtractor {
         
         let channelCount = Int(audioFile.processingFormat.channelCount)
         let waveformStorage = WaveformStorage(
-            channelCount: channelCount,
+            channelCount: 1 + laneCount(channelCount: channelCount),
             size: samplesPerPixel
         )
         
@@ -102,21 +105,16 @@ public class WaveformExtractor {
                 return nil
             }
             
-            guard let floatData = rmsBuffer.floatChannelData else { return nil }
+            guard let levels = levels(of: rmsBuffer, channelCount: channelCount) else { return nil }
             
-            for channel in 0..<channelCount {
-                /// Calculating RMS(Root mean square)
-                var rmsValue: Float = 0.0
-                vDSP_rmsqv(
-                    floatData[channel], 1, &rmsValue,
-                    vDSP_Length(rmsBuffer.frameLength)
-                )
+            for (channel, rmsValue) in levels.enumerated() {
                 await waveformStorage.update(
                     channel: channel, index: i, value: rmsValue
                 )
             }
             
             let progress = Float(i - startIndex + 1) / Float(endIndex - startIndex)
+            self.progress = progress
             await sendWaveformDataToFlutter(
                 waveformStorage: waveformStorage,
                 progress: progress,
@@ -134,22 +132,162 @@ public class WaveformExtractor {
         return await waveformStorage.getData()
     }
 
-    func getChannelMean(data: FloatChannelData) -> [Float] {
-        var resultWaveform = [Float]()
+    /// Reads the same points as `extractWaveform`, each exactly once, but
+    /// coarse to fine: every `stride`th point first, then the points halfway
+    /// between those read so far. Each of these rounds is a resolution level.
+    /// Points which weren't read yet repeat their closest read neighbour, so
+    /// every update spans the whole file and is refined in place.
+    public func extractWaveformProgressively(
+        samplesPerPixel: Int?,
+        playerKey: String
+    ) async -> FloatChannelData? {
+        guard let audioFile = audioFile else { return nil }
 
-        if channelCount == 2, !data[0].isEmpty, !data[1].isEmpty {
-            resultWaveform = zip(data[0], data[1]).map { ($0 + $1) / 2 }
-        } else if !data[0].isEmpty {
-            resultWaveform = data[0]
-        } else if !data[1].isEmpty {
-            resultWaveform = data[1]
-        } else {
-            sendErrorToFlutter(
-                message: "Cannot get waveform mean",
-                details: "Both audio channels are null"
-            )
+        let samplesPerPixel = max(1, samplesPerPixel ?? 100)
+        let currentFrame = audioFile.framePosition
+        let totalFrames = audioFile.length
+        let framesPerBuffer = AVAudioFrameCount(totalFrames / AVAudioFramePosition(samplesPerPixel))
+        if framesPerBuffer == 0 {
+            return await extractWaveform(samplesPerPixel: samplesPerPixel, playerKey: playerKey)
+        }
+        guard let rmsBuffer = AVAudioPCMBuffer(
+            pcmFormat: audioFile.processingFormat,
+            frameCapacity: framesPerBuffer
+        ) else { return nil }
+
+        let channelCount = Int(audioFile.processingFormat.channelCount)
+        let waveformStorage = WaveformStorage(
+            channelCount: 1 + laneCount(channelCount: channelCount),
+            size: samplesPerPixel
+        )
+        var visited = [Bool](repeating: false, count: samplesPerPixel)
+        var visitedCount = 0
+        var sentCount = 0
+        let coarsest = min(samplesPerPixel, Constants.coarsestPoints)
+        var stride = 1
+        while samplesPerPixel / (stride * 2) >= coarsest {
+            stride *= 2
+        }
+
+        var level = 0
+        var step = stride
+        while step >= 1 {
+            var index = level == 0 ? 0 : step
+            let increment = level == 0 ? step : step * 2
+            while index < samplesPerPixel {
+                if abortGetWaveformData {
+                    audioFile.framePosition = currentFrame
+                    abortGetWaveformData = false
+                    return nil
+                }
+
+                let startFrame = AVAudioFramePosition(index) * AVAudioFramePosition(framesPerBuffer)
+                let frameCount = AVAudioFrameCount(
+                    min(AVAudioFramePosition(framesPerBuffer), totalFrames - startFrame)
+                )
+                do {
+                    audioFile.framePosition = startFrame
+                    try audioFile.read(into: rmsBuffer, frameCount: frameCount)
+                } catch {
+                    sendErrorToFlutter(
+                        message: "Couldn't read buffer. \(error.localizedDescription)"
+                    )
+                    return nil
+                }
+
+                guard let levels = levels(of: rmsBuffer, channelCount: channelCount) else { return nil }
+
+                for (channel, rmsValue) in levels.enumerated() {
+                    await waveformStorage.update(
+                        channel: channel, index: index, value: rmsValue
+                    )
+                }
+                visited[index] = true
+                visitedCount += 1
+
+                // Updates within a level are sent at most every percent.
+                let isLevelDone = index + increment >= samplesPerPixel
+                if isLevelDone || (visitedCount - sentCount) * 100 >= samplesPerPixel {
+                    sentCount = visitedCount
+                    let progress = Float(visitedCount) / Float(samplesPerPixel)
+                    self.progress = progress
+                    await sendWaveformDataToFlutter(
+                        waveformStorage: waveformStorage,
+                        progress: progress,
+                        playerKey: playerKey,
+                        visited: visitedCount < samplesPerPixel ? visited : nil,
+                        level: level
+                    )
+                }
+                index += increment
+            }
+            step /= 2
+            level += 1
+        }
+
+        audioFile.framePosition = currentFrame
+        return await waveformStorage.getData()
+    }
+
+    /// Number of waveforms stored after the mixed one for `channelMode`.
+    private func laneCount(channelCount: Int) -> Int {
+        switch channelMode {
+        case .mixed: return 0
+        case .perChannel: return channelCount
+        case .midSide: return 2
         }
-        return resultWaveform
+    }
+
+    /// RMS(Root mean square) of every stored waveform of `buffer`, computed
+    /// with vDSP on its deinterleaved channels: the mixed value first, then
+    /// one value per channel, or the mid and side values of the first two
+    /// channels for `.midSide`. The mixed value is the RMS of the mono
+    /// downmix whatever the mode, as on the other platforms.
+    private func levels(of buffer: AVAudioPCMBuffer, channelCount: Int) -> [Float]? {
+        guard let floatData = buffer.floatChannelData else { return nil }
+        let length = vDSP_Length(buffer.frameLength)
+        var scratch = [Float](zeros: Int(length))
+        var mixed: Float = 0.0
+        scratch.withUnsafeMutableBufferPointer { buffer in
+            guard let sum = buffer.baseAddress else { return }
+            for channel in 0..<channelCount {
+                vDSP_vadd(sum, 1, floatData[channel], 1, sum, 1, length)
+            }
+            vDSP_rmsqv(sum, 1, &mixed, length)
+        }
+        var levels = [mixed / Float(max(1, channelCount))]
+        switch channelMode {
+        case .mixed:
+            break
+        case .perChannel:
+            for channel in 0..<channelCount {
+                var rmsValue: Float = 0.0
+                vDSP_rmsqv(floatData[channel], 1, &rmsValue, length)
+                levels.append(rmsValue)
+            }
+        case .midSide:
+            let left = floatData[0]
+            let right = floatData[channelCount > 1 ? 1 : 0]
+            var mid: Float = 0.0
+            var side: Float = 0.0
+            vDSP_vadd(left, 1, right, 1, &scratch, 1, length)
+            vDSP_rmsqv(scratch, 1, &mid, length)
+            // vDSP_vsub subtracts its first operand from its second.
+            vDSP_vsub(right, 1, left, 1, &scratch, 1, length)
+            vDSP_rmsqv(scratch, 1, &side, length)
+            levels += [mid / 2, side / 2]
+        }
+        return levels
+    }
+
+    /// The single waveform sent with progress updates and as the result.
+    func mixedWaveform(data: FloatChannelData) -> [Float] {
+        return data.first ?? []
+    }
+
+    /// The waveforms of `channelMode` stored after the mixed one.
+    func channelWaveforms(data: FloatChannelData) -> FloatChannelData {
+        return Array(data.dropFirst())
     }
 
     public func cancel() {
@@ -159,23 +297,46 @@ public class WaveformExtractor {
     private func sendWaveformDataToFlutter(
         waveformStorage: WaveformStorage,
         progress: Float,
-        playerKey: String
+        playerKey: String,
+        visited: [Bool]? = nil,
+        level: Int? = nil
     ) async {
         let waveformData = await waveformStorage.getData()
-        let meanData = getChannelMean(data: waveformData)
+        var meanData = mixedWaveform(data: waveformData)
+        if let visited = visited {
+            fillGaps(&meanData, visited: visited)
+        }
 
+        var arguments: [String: Any] = [
+            Constants.waveformData: meanData,
+            Constants.progress: progress,
+            Constants.playerKey: playerKey
+        ]
+        if let level = level {
+            arguments[Constants.resolutionLevel] = level
+        }
         DispatchQueue.main.async {
             self.flutterChannel.invokeMethod(
                 Constants.onCurrentExtractedWaveformData,
-                arguments: [
-                    Constants.waveformData: meanData,
-                    Constants.progress: progress,
-                    Constants.playerKey: playerKey
-                ]
+                arguments: arguments
             )
         }
     }
 
+    /// Points which weren't read yet repeat the closest read point on their
+    /// left, or the first read point.
+    private func fillGaps(_ data: inout [Float], visited: [Bool]) {
+        guard let first = visited.firstIndex(of: true) else { return }
+        var last = first
+        for i in 0..<min(data.count, visited.count) {
+            if visited[i] {
+                last = i
+            } else {
+                data[i] = data[i < first ? first : last]
+            }
+        }
+    }
+
     private func sendErrorToFlutter(message: String, details: String? = nil) {
         DispatchQueue.main.async {
             self.result(
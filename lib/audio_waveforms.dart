@@ -9,4 +9,11 @@ export 'src/controllers/player_controller.dart';
 export 'src/controllers/recorder_controller.dart';
 export 'src/models/android_encoder_settings.dart';
 export 'src/models/ios_encoder_setting.dart';
+export 'src/models/media_info.dart';
 export 'src/models/recorder_settings.dart';
+export 'src/models/recording_result.dart';
+export 'src/models/recording_writer_settings.dart';
+export 'src/models/recording_writer_stats.dart';
+export 'src/models/resource_budget.dart';
+export 'src/models/silence_detection.dart';
+export 'src/models/waveform_extraction_result.dart';
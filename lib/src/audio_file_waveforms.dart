@@ -1,5 +1,7 @@
 import 'dart:async';
+import 'dart:math' show max;
 
+import 'package:flutter/foundation.dart' show listEquals;
 import 'package:flutter/material.dart';
 
 import '../audio_waveforms.dart';
@@ -17,6 +19,15 @@ class AudioFileWaveforms extends StatefulWidget {
   /// is ignored if waveform data is provided from this parameter.
   final List<double> waveformData;
 
+  /// Directly draws these waveforms in lanes of equal height from top to
+  /// bottom, for example the waveform of every channel from
+  /// [WaveformExtractionController.channelWaveforms]. Extracted channel
+  /// waveforms are ignored if they are provided from this parameter.
+  ///
+  /// Without this parameter, channel waveforms extracted by the
+  /// [playerController] are drawn once their extraction completes.
+  final List<List<double>> channelWaveforms;
+
   /// When this flag is set to true, new waves are drawn as soon as new
   /// waveform data is available from [onCurrentExtractedWaveformData].
   /// If this flag is set to false then waveforms will be drawn after waveform
@@ -99,6 +110,7 @@ class AudioFileWaveforms extends StatefulWidget {
     required this.size,
     required this.playerController,
     this.waveformData = const [],
+    this.channelWaveforms = const [],
     this.continuousWaveform = true,
     this.playerWaveStyle = const PlayerWaveStyle(),
     this.padding,
@@ -180,8 +192,16 @@ class _AudioFileWaveformsState extends State<AudioFileWaveforms>
       _seekProgress.value = playerController.maxDuration;
       _updatePlayerPercent();
     });
+    if (widget.channelWaveforms.isNotEmpty) {
+      _channelWaveforms.addAll(widget.channelWaveforms);
+    } else {
+      _channelWaveforms.addAll(waveformExtraction.channelWaveforms ?? const []);
+      playerController.addListener(_addChannelWaveformsFromController);
+    }
     if (widget.waveformData.isNotEmpty) {
       _addWaveformData(widget.waveformData);
+    } else if (widget.channelWaveforms.isNotEmpty) {
+      _addWaveformData(_loudestOf(widget.channelWaveforms));
     } else {
       if (waveformExtraction.waveformData.isNotEmpty) {
         _addWaveformData(waveformExtraction.waveformData);
@@ -202,6 +222,7 @@ class _AudioFileWaveformsState extends State<AudioFileWaveforms>
     onCurrentExtractedWaveformData?.cancel();
     onCompletionSubscription.cancel();
     playerController.removeListener(_addWaveformDataFromController);
+    playerController.removeListener(_addChannelWaveformsFromController);
     _growingWaveController.dispose();
     super.dispose();
   }
@@ -220,6 +241,7 @@ class _AudioFileWaveformsState extends State<AudioFileWaveforms>
   double _proportion = 0.0;
 
   final List<double> _waveformData = [];
+  final List<List<double>> _channelWaveforms = [];
 
   @override
   Widget build(BuildContext context) {
@@ -246,6 +268,7 @@ class _AudioFileWaveformsState extends State<AudioFileWaveforms>
                   painter: PlayerWavePainter(
                     playerWaveStyle: playerWaveStyle,
                     waveformData: _waveformData,
+                    channelWaveforms: _channelWaveforms,
                     animValue: _growAnimationProgress,
                     totalBackDistance: _totalBackDistance,
                     dragOffset: _dragOffset,
@@ -270,6 +293,29 @@ class _AudioFileWaveformsState extends State<AudioFileWaveforms>
   void _addWaveformDataFromController() =>
       _addWaveformData(waveformExtraction.waveformData);
 
+  void _addChannelWaveformsFromController() {
+    final channelWaveforms = waveformExtraction.channelWaveforms ?? const [];
+    if (listEquals(channelWaveforms, _channelWaveforms)) return;
+    _channelWaveforms
+      ..clear()
+      ..addAll(channelWaveforms);
+    if (mounted) setState(() {});
+  }
+
+  /// Loudest channel of every point, which sets the number of points and
+  /// the progress when only channel waveforms are provided.
+  static List<double> _loudestOf(List<List<double>> channelWaveforms) {
+    final length =
+        channelWaveforms.map((waveform) => waveform.length).reduce(max);
+    return List.generate(length, (i) {
+      var loudest = 0.0;
+      for (final waveform in channelWaveforms) {
+        if (i < waveform.length) loudest = max(loudest, waveform[i]);
+      }
+      return loudest;
+    });
+  }
+
   void _updateGrowAnimationProgress() {
     if (mounted) {
       setState(() {
@@ -243,16 +243,34 @@ class AudioWaveformsInterface {
     });
   }
 
-  Future<List<double>> extractWaveformData({
+  Future<WaveformExtractionResult> extractWaveformData({
     required String key,
     required String path,
     required int noOfSamples,
+    SilenceDetection? silenceDetection,
+    bool measureLoudness = false,
+    bool progressive = false,
+    ChannelMode channelMode = ChannelMode.mixed,
   }) async {
     if (Platform.isWindows || Platform.isLinux || Platform.isMacOS) {
-      return _desktopHandler.extractWaveformData(
-        key: key,
-        path: path,
-        noOfSamples: noOfSamples,
+      if (Platform.isLinux) {
+        final result = await _desktopHandler.extractWaveformNatively(
+          key: key,
+          path: path,
+          noOfSamples: noOfSamples,
+          silenceDetection: silenceDetection,
+          measureLoudness: measureLoudness,
+          progressive: progressive,
+          channelMode: channelMode,
+        );
+        if (result != null) return result;
+      }
+      return WaveformExtractionResult(
+        waveformData: await _desktopHandler.extractWaveformData(
+          key: key,
+          path: path,
+          noOfSamples: noOfSamples,
+        ),
       );
     }
     final result =
@@ -260,8 +278,13 @@ class AudioWaveformsInterface {
       Constants.playerKey: key,
       Constants.path: path,
       Constants.noOfSamples: noOfSamples,
+      ...?silenceDetection?.toJson(),
+      if (measureLoudness) Constants.measureLoudness: true,
+      if (progressive) Constants.progressive: true,
+      if (channelMode != ChannelMode.mixed)
+        Constants.channelMode: channelMode.index,
     });
-    return List<double>.from(result ?? []);
+    return WaveformExtractionResult.fromPlatform(result);
   }
 
   /// Stops current executing waveform extraction, if any.
@@ -274,6 +297,75 @@ class AudioWaveformsInterface {
     });
   }
 
+  /// Starts spectrum analysis of the file prepared for [key]. Currently
+  /// only supported on Linux, other platforms return false.
+  Future<bool> startSpectrumAnalysis({
+    required String key,
+    required int bands,
+    required int fftSize,
+  }) async {
+    if (!Platform.isLinux) return false;
+    return _desktopHandler.startSpectrumAnalysis(
+      key: key,
+      bands: bands,
+      fftSize: fftSize,
+    );
+  }
+
+  /// Stops spectrum analysis started with [startSpectrumAnalysis], if any.
+  Future<void> stopSpectrumAnalysis(String key) async {
+    if (!Platform.isLinux) return;
+    return _desktopHandler.stopSpectrumAnalysis(key);
+  }
+
+  /// Starts spectrum analysis of the audio being recorded. Currently only
+  /// supported on Linux while recording to a WAV file, otherwise returns
+  /// false.
+  Future<bool> startRecordingSpectrum({
+    required int bands,
+    required int fftSize,
+  }) async {
+    if (!Platform.isLinux) return false;
+    return _desktopHandler.startRecordingSpectrum(
+      bands: bands,
+      fftSize: fftSize,
+    );
+  }
+
+  /// Stops spectrum analysis started with [startRecordingSpectrum], if any.
+  Future<void> stopRecordingSpectrum() async {
+    if (!Platform.isLinux) return;
+    return _desktopHandler
+        .stopSpectrumAnalysis(Constants.recorderSpectrumKey);
+  }
+
+  Future<List<MediaInfo?>> probeMedia(
+    List<String> paths, {
+    bool exactDuration = false,
+  }) async {
+    if (Platform.isWindows || Platform.isLinux || Platform.isMacOS) {
+      return DesktopAudioHandler.probeMedia(
+        paths,
+        exactDuration: exactDuration,
+      );
+    }
+    return List<MediaInfo?>.filled(paths.length, null);
+  }
+
+  Future<bool> setResourceBudget(ResourceBudget budget) async {
+    if (Platform.isWindows || Platform.isLinux || Platform.isMacOS) {
+      return DesktopAudioHandler.setResourceBudget(budget);
+    }
+    return false;
+  }
+
+  Future<ResourceUsage?> getResourceUsage() async {
+    if (Platform.isWindows || Platform.isLinux || Platform.isMacOS) {
+      return DesktopAudioHandler.getResourceUsage();
+    }
+    return null;
+  }
+
   Future<bool> stopAllPlayers() async {
     if (Platform.isWindows || Platform.isLinux || Platform.isMacOS) {
       return _desktopHandler.stopAllPlayers();
@@ -301,6 +393,15 @@ class AudioWaveformsInterface {
             PlatformStreams.instance.addCurrentDurationEvent(identifier);
           }
           break;
+        case Constants.onPlaybackAnchor:
+          PlatformStreams.instance.addPlaybackAnchor(
+            call.arguments[Constants.playerKey],
+            position: call.arguments[Constants.current],
+            timestamp: call.arguments[Constants.timestamp],
+            rate: (call.arguments[Constants.rate] as num).toDouble(),
+            isPlaying: call.arguments[Constants.isPlaying],
+          );
+          break;
         case Constants.onDidFinishPlayingAudio:
           var key = call.arguments[Constants.playerKey];
           var playerState =
@@ -319,6 +420,13 @@ class AudioWaveformsInterface {
           var progress = call.arguments[Constants.progress];
           var waveformData =
               List<double>.from(call.arguments[Constants.waveformData]);
+          var level = call.arguments[Constants.resolutionLevel];
+          // Tagged before the data so listeners of both see them together.
+          if (level is int) {
+            PlatformStreams.instance.addExtractionResolution(
+              PlayerIdentifier<int>(key, level),
+            );
+          }
           PlatformStreams.instance.addExtractedWaveformDataEvent(
             PlayerIdentifier<List<double>>(key, waveformData),
           );
@@ -326,6 +434,22 @@ class AudioWaveformsInterface {
             PlayerIdentifier<double>(key, progress),
           );
           break;
+        case Constants.onSpectrumData:
+          var key = call.arguments[Constants.playerKey];
+          var version = call.arguments[Constants.version];
+          var bands = version is int
+              ? _desktopHandler.spectrumFrame(key, version)
+              : call.arguments[Constants.bands] as Float32List;
+          if (bands == null) break;
+          PlatformStreams.instance.addSpectrumEvent(
+            PlayerIdentifier<Float32List>(key, bands),
+          );
+          break;
+        case Constants.onResourcePressure:
+          await _desktopHandler.relieveResourcePressure(
+            call.arguments[Constants.players] as int,
+          );
+          break;
       }
     });
   }
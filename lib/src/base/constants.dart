@@ -55,4 +55,69 @@ class Constants {
   static const String linearPCMBitDepth = 'linearPCMBitDepth';
   static const String linearPCMIsBigEndian = 'linearPCMIsBigEndian';
   static const String linearPCMIsFloat = 'linearPCMIsFloat';
+  static const String startSpectrumAnalysis = "startSpectrumAnalysis";
+  static const String stopSpectrumAnalysis = "stopSpectrumAnalysis";
+  static const String updateSpectrumClock = "updateSpectrumClock";
+  static const String startRecordingSpectrum = "startRecordingSpectrum";
+  static const String recorderSpectrumKey = "recorderSpectrum";
+  static const String onSpectrumData = "onSpectrumData";
+  static const String bands = "bands";
+  static const String fftSize = "fftSize";
+  static const String isPlaying = "isPlaying";
+  static const String segments = "segments";
+  static const String silenceThreshold = "silenceThreshold";
+  static const String silenceMinDuration = "silenceMinDuration";
+  static const String cancelled = "cancelled";
+  static const String measureLoudness = "measureLoudness";
+  static const String loudness = "loudness";
+  static const String integratedLoudness = "integratedLoudness";
+  static const String loudnessRange = "loudnessRange";
+  static const String samplePeak = "samplePeak";
+  static const String truePeak = "truePeak";
+  static const String probeMedia = "probeMedia";
+  static const String paths = "paths";
+  static const String exactDuration = "exactDuration";
+  static const String codec = "codec";
+  static const String duration = "duration";
+  static const String channels = "channels";
+  static const String progressive = "progressive";
+  static const String channelMode = "channelMode";
+  static const String channelWaveforms = "channelWaveforms";
+  static const String sharedBuffers = "sharedBuffers";
+  static const String sharedBuffer = "sharedBuffer";
+  static const String version = "version";
+  static const String resolutionLevel = "resolutionLevel";
+  static const String onPlaybackAnchor = "onPlaybackAnchor";
+  static const String timestamp = "timestamp";
+  static const String startRecordingWriter = "startRecordingWriter";
+  static const String writeRecordingData = "writeRecordingData";
+  static const String stopRecordingWriter = "stopRecordingWriter";
+  static const String data = "data";
+  static const String bufferSize = "bufferSize";
+  static const String flushInterval = "flushInterval";
+  static const String syncInterval = "syncInterval";
+  static const String queueDuration = "queueDuration";
+  static const String framesWritten = "framesWritten";
+  static const String droppedBlocks = "droppedBlocks";
+  static const String droppedFrames = "droppedFrames";
+  static const String backpressureEvents = "backpressureEvents";
+  static const String queueCapacity = "queueCapacity";
+  static const String peakQueued = "peakQueued";
+  static const String longestWrite = "longestWrite";
+  static const String ioError = "ioError";
+  static const String writerStats = "writerStats";
+  static const String waveformPeaks = "waveformPeaks";
+  static const String setResourceBudget = "setResourceBudget";
+  static const String getResourceUsage = "getResourceUsage";
+  static const String acquirePlayerResources = "acquirePlayerResources";
+  static const String releasePlayerResources = "releasePlayerResources";
+  static const String onResourcePressure = "onResourcePressure";
+  static const String memory = "memory";
+  static const String threads = "threads";
+  static const String memoryBudget = "memoryBudget";
+  static const String threadBudget = "threadBudget";
+  static const String queuedJobs = "queuedJobs";
+  static const String runningExtractions = "runningExtractions";
+  static const String residentPlayers = "residentPlayers";
+  static const String players = "players";
 }
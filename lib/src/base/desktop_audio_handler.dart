@@ -1,16 +1,25 @@
 import 'dart:async';
 import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
 
+import 'package:flutter/services.dart';
 import 'package:just_audio/just_audio.dart' as ja;
 import 'package:record/record.dart'
     show AudioRecorder, RecordConfig, AudioEncoder;
 import 'package:just_waveform/just_waveform.dart';
 
+import '../models/media_info.dart';
 import '../models/recorder_settings.dart';
+import '../models/resource_budget.dart';
+import '../models/silence_detection.dart';
+import '../models/waveform_extraction_result.dart';
 import 'constants.dart';
 import 'utils.dart';
 import 'player_identifier.dart';
 import 'platform_streams.dart';
+import 'playback_clock.dart';
+import 'shared_float_buffer.dart';
 
 typedef _WaveformExtractor = Stream<dynamic> Function({
   required File audioInFile,
@@ -23,17 +32,133 @@ class DesktopAudioHandler {
     AudioRecorder? recorder,
     ja.AudioPlayer Function()? playerFactory,
     _WaveformExtractor? waveformExtractor,
-  })  : _recorder = recorder ?? AudioRecorder(),
+    Future<int?> Function(String path)? durationProbe,
+    this.maxResidentPlayers = 8,
+  })  : assert(maxResidentPlayers > 0),
+        _recorder = recorder ?? AudioRecorder(),
         _playerFactory = playerFactory ?? (() => ja.AudioPlayer()),
-        _waveformExtractor =
-            waveformExtractor ?? JustWaveform.extract;
+        _waveformExtractor = waveformExtractor ?? JustWaveform.extract,
+        _durationProbe = durationProbe ??
+            (Platform.isLinux ? _probeDurationNatively : null);
+
+  static const MethodChannel _methodChannel =
+      MethodChannel(Constants.methodChannelName);
 
   final AudioRecorder _recorder;
   final ja.AudioPlayer Function() _playerFactory;
-  final Map<String, ja.AudioPlayer> _players = {};
+
+  /// Maximum number of players which keep an open decoder. Prepared players
+  /// beyond this limit are evicted in least recently used order and are
+  /// re-opened on their next [startPlayer] or [seekTo].
+  final int maxResidentPlayers;
+
+  /// Prepared players in least recently used order, first entry being the
+  /// least recently used one.
+  final Map<String, _PreparedPlayer> _prepared = {};
+
+  /// Reads the duration of a file without opening a player for it. When it
+  /// is not provided or can't tell the duration, the player is opened.
+  /// Defaults to the native header probe on Linux, see [probeMedia].
+  final Future<int?> Function(String path)? _durationProbe;
+
   final _waveformSubscriptions = <String, StreamSubscription>{};
+  final _nativeExtractions = <String, Object>{};
+  final _spectrumKeys = <String>{};
+
+  /// Rings of spectrum frames shared by the plugin, by player key.
+  final _spectrumRings = <String, _SpectrumRing>{};
+  final _clockSubscriptions = <String, List<StreamSubscription>>{};
   final _waveformCompleters = <String, Completer<List<double>>>{};
   final _WaveformExtractor _waveformExtractor;
+  Future<Directory>? _waveformTempDirectory;
+
+  /// Path of the recording written by the native writer, see [_startWriter].
+  String? _writerPath;
+  RecorderSettings? _writerSettings;
+  StreamSubscription<Uint8List>? _writerSubscription;
+  Completer<void>? _writerDone;
+
+  /// Reads the codec, duration, sample rate and channel count of every file
+  /// in [paths] from its headers, in a single native call. Files which
+  /// can't be probed, and all files on platforms without a native probe,
+  /// have a null entry.
+  ///
+  /// With [exactDuration], the frames of MP3 and AAC files are walked for
+  /// their exact duration.
+  static Future<List<MediaInfo?>> probeMedia(
+    List<String> paths, {
+    bool exactDuration = false,
+  }) async {
+    final nothing = List<MediaInfo?>.filled(paths.length, null);
+    if (!Platform.isLinux || paths.isEmpty) return nothing;
+    final Object? result;
+    try {
+      result = await _methodChannel.invokeMethod(
+        Constants.probeMedia,
+        {
+          Constants.paths: paths,
+          Constants.exactDuration: exactDuration,
+        },
+      );
+    } on MissingPluginException {
+      return nothing;
+    }
+    if (result is! List || result.length != paths.length) return nothing;
+    return [
+      for (final info in result)
+        info is Map ? MediaInfo.fromMap(info) : null,
+    ];
+  }
+
+  /// Sets the budget of the native resource governor. Returns false on
+  /// platforms without one.
+  static Future<bool> setResourceBudget(ResourceBudget budget) async {
+    if (!Platform.isLinux) return false;
+    try {
+      final result = await _methodChannel.invokeMethod<bool>(
+        Constants.setResourceBudget,
+        budget.toJson(),
+      );
+      return result ?? false;
+    } on MissingPluginException {
+      return false;
+    }
+  }
+
+  /// Resources reserved under the budget of the native resource governor,
+  /// or null on platforms without one.
+  static Future<ResourceUsage?> getResourceUsage() async {
+    if (!Platform.isLinux) return null;
+    try {
+      final usage =
+          await _methodChannel.invokeMapMethod(Constants.getResourceUsage);
+      return usage == null ? null : ResourceUsage.fromMap(usage);
+    } on MissingPluginException {
+      return null;
+    }
+  }
+
+  /// Reads the duration from the headers only, as scanning the frames of a
+  /// long file would delay preparing it. See [_measureDuration].
+  static Future<int?> _probeDurationNatively(String path) async {
+    final info = (await probeMedia([path])).single;
+    return info?.duration?.inMilliseconds;
+  }
+
+  /// Walks the frames of the file of [prepared] in the background the first
+  /// time it is seeked, and replaces its duration with the exact one, which
+  /// headers of VBR files only estimate. Later seek gestures then map to
+  /// positions exactly.
+  void _measureDuration(_PreparedPlayer prepared) {
+    if (!Platform.isLinux || prepared.measured) return;
+    prepared.measured = true;
+    unawaited(
+      probeMedia([prepared.path], exactDuration: true).then((infos) {
+        final duration = infos.single?.duration?.inMilliseconds;
+        if (duration != null) prepared.duration = duration;
+      }),
+    );
+  }
 
   Future<bool> record({
     required RecorderSettings settings,
@@ -42,6 +167,11 @@ class DesktopAudioHandler {
     if (!await _recorder.hasPermission()) return false;
     final recordPath = path ??
         '${(await Directory.systemTemp.createTemp()).path}/recording.m4a';
+    if (Platform.isLinux &&
+        recordPath.toLowerCase().endsWith('.wav') &&
+        await _startWriter(recordPath, settings)) {
+      return true;
+    }
     await _recorder.start(
       RecordConfig(
         encoder: AudioEncoder.aacLc,
@@ -53,6 +183,104 @@ class DesktopAudioHandler {
     return true;
   }
 
+  /// Streams PCM from the recorder into the native writer, which encodes
+  /// [path] on its own thread so a slow disk can't interrupt capture.
+  /// Returns false, with nothing left running, if either side can't start.
+  Future<bool> _startWriter(String path, RecorderSettings settings) async {
+    final encoderSettings = settings.iosEncoderSettings;
+    final writerSettings = settings.writerSettings;
+    final bool? opened;
+    try {
+      opened = await _methodChannel.invokeMethod<bool>(
+        Constants.startRecordingWriter,
+        {
+          Constants.path: path,
+          Constants.sampleRate: settings.sampleRate,
+          Constants.linearPCMBitDepth: encoderSettings.linearPCMBitDepth ?? 16,
+          Constants.linearPCMIsFloat:
+              encoderSettings.linearPCMIsFloat ?? false,
+          ...writerSettings.toJson(),
+        },
+      );
+    } on MissingPluginException {
+      return false;
+    }
+    if (opened != true) {
+      // The plugin keeps a writer which failed to open, along with its share
+      // of the resource budget, until it is stopped.
+      await _methodChannel.invokeMethod(Constants.stopRecordingWriter);
+      return false;
+    }
+    try {
+      final stream = await _recorder.startStream(
+        RecordConfig(
+          encoder: AudioEncoder.pcm16bits,
+          sampleRate: settings.sampleRate,
+          numChannels: writerSettings.channels,
+        ),
+      );
+      final done = Completer<void>();
+      // Every message costs a copy and a trip through the main thread, so
+      // blocks are sent in batches of about 50 ms. Blocks which don't fit
+      // into the native queue are dropped and counted there, so the results
+      // aren't awaited.
+      final batchBytes =
+          settings.sampleRate * writerSettings.channels * 2 ~/ 20;
+      final batch = BytesBuilder(copy: false);
+      void send() {
+        if (batch.isEmpty) return;
+        _methodChannel.invokeMethod(
+          Constants.writeRecordingData,
+          {Constants.data: batch.takeBytes()},
+        );
+      }
+
+      _writerSubscription = stream.listen(
+        (data) {
+          batch.add(data);
+          if (batch.length >= batchBytes) send();
+        },
+        onDone: () {
+          send();
+          done.complete();
+        },
+      );
+      _writerDone = done;
+    } catch (_) {
+      await _methodChannel.invokeMethod(Constants.stopRecordingWriter);
+      return false;
+    }
+    _writerPath = path;
+    _writerSettings = settings;
+    return true;
+  }
+
+  /// Stops capture, waits for the recorder to deliver its last block and
+  /// drains the native writer, which also returns the waveform buckets of
+  /// the file.
+  Future<Map<String, dynamic>> _stopWriter(String path) async {
+    _writerPath = null;
+    _writerSettings = null;
+    await stopSpectrumAnalysis(Constants.recorderSpectrumKey);
+    await _recorder.stop();
+    await _writerDone?.future
+        .timeout(const Duration(seconds: 1), onTimeout: () {});
+    await _writerSubscription?.cancel();
+    _writerSubscription = null;
+    _writerDone = null;
+    final stats = await _methodChannel.invokeMapMethod<String, dynamic>(
+      Constants.stopRecordingWriter,
+    );
+    if (stats == null) return {};
+    return {
+      Constants.resultFilePath: path,
+      Constants.resultDuration: stats[Constants.duration],
+      Constants.writerStats: stats,
+      Constants.waveformData: stats[Constants.waveformData],
+      Constants.waveformPeaks: stats[Constants.waveformPeaks],
+    };
+  }
+
   Future<bool> initRecorder({
     String? path,
     required RecorderSettings settings,
@@ -73,12 +301,18 @@ class DesktopAudioHandler {
   }
 
   Future<Map<String, dynamic>> stop() async {
+    final writerPath = _writerPath;
+    if (writerPath != null) return _stopWriter(writerPath);
     final filePath = await _recorder.stop();
     if (filePath == null) return {};
-    final player = ja.AudioPlayer();
-    await player.setFilePath(filePath);
-    final duration = player.duration?.inMilliseconds ?? 0;
-    await player.dispose();
+    // Only open a player for the duration when the header can't tell it.
+    var duration = await _durationProbe?.call(filePath);
+    if (duration == null) {
+      final player = _playerFactory();
+      await player.setFilePath(filePath);
+      duration = player.duration?.inMilliseconds ?? 0;
+      await player.dispose();
+    }
     return {
       Constants.resultFilePath: filePath,
       Constants.resultDuration: duration
@@ -99,72 +333,99 @@ class DesktopAudioHandler {
     return await _recorder.hasPermission();
   }
 
+  /// Registers [path] for [key] without opening it. A player is only
+  /// instantiated when it is first started or seeked, see [_activate].
   Future<bool> preparePlayer({
     required String path,
     required String key,
     required int frequency,
     double? volume,
   }) async {
-    final player = _players.putIfAbsent(key, () => _playerFactory());
-    await player.setFilePath(path);
-    if (volume != null) await player.setVolume(volume.clamp(0.0, 1.0));
+    final entry = _prepared.remove(key);
+    final prepared = _PreparedPlayer(path)
+      ..volume = volume?.clamp(0.0, 1.0) ?? entry?.volume
+      ..speed = entry?.speed
+      ..finishMode = entry?.finishMode;
+    _prepared[key] = prepared;
+    final player = entry?.player;
+    if (player != null) {
+      // Already resident, so reuse the decoder instead of evicting it.
+      prepared
+        ..player = player
+        ..duration = (await player.setFilePath(path))?.inMilliseconds;
+      if (prepared.volume != null) await player.setVolume(prepared.volume!);
+    }
     return true;
   }
 
   Future<bool> startPlayer(String key) async {
-    final player = _players[key];
+    final player = await _activate(key);
     if (player == null) return false;
     await player.play();
     return true;
   }
 
   Future<bool> stopPlayer(String key) async {
-    final player = _players[key];
-    if (player == null) return false;
-    await player.stop();
+    final prepared = _prepared[key];
+    if (prepared == null) return false;
+    prepared.position = Duration.zero;
+    await prepared.player?.stop();
     return true;
   }
 
   Future<bool> release(String key) async {
-    final player = _players.remove(key);
-    await player?.dispose();
+    await stopSpectrumAnalysis(key);
+    final prepared = _prepared.remove(key);
+    if (prepared != null) await _deactivate(key, prepared);
     return true;
   }
 
   Future<bool> pausePlayer(String key) async {
-    final player = _players[key];
-    if (player == null) return false;
-    await player.pause();
+    final prepared = _prepared[key];
+    if (prepared == null) return false;
+    await prepared.player?.pause();
     return true;
   }
 
   Future<int?> getDuration(String key, int durationType) async {
-    final player = _players[key];
-    if (player == null) return null;
+    final prepared = _prepared[key];
+    if (prepared == null) return null;
     if (durationType == 0) {
-      return player.position.inMilliseconds;
+      return (prepared.player?.position ?? prepared.position).inMilliseconds;
+    }
+    if (prepared.duration != null) return prepared.duration;
+    final probe = _durationProbe;
+    if (probe != null) {
+      prepared.duration = await probe(prepared.path);
+      if (prepared.duration != null) return prepared.duration;
     }
-    await player.load();
-    return player.duration?.inMilliseconds;
+    final player = await _activate(key);
+    await player?.load();
+    prepared.duration = player?.duration?.inMilliseconds;
+    return prepared.duration;
   }
 
   Future<bool> setVolume(double volume, String key) async {
-    final player = _players[key];
-    if (player == null) return false;
-    await player.setVolume(volume.clamp(0.0, 1.0));
+    final prepared = _prepared[key];
+    if (prepared == null) return false;
+    prepared.volume = volume.clamp(0.0, 1.0);
+    await prepared.player?.setVolume(prepared.volume!);
     return true;
   }
 
   Future<bool> setRate(double rate, String key) async {
-    final player = _players[key];
-    if (player == null) return false;
-    await player.setSpeed(rate);
+    final prepared = _prepared[key];
+    if (prepared == null) return false;
+    prepared.speed = rate;
+    await prepared.player?.setSpeed(rate);
     return true;
   }
 
   Future<bool> seekTo(String key, int progress) async {
-    final player = _players[key];
-    if (player == null) return false;
+    final prepared = _prepared[key];
+    final player = await _activate(key);
+    if (prepared == null || player == null) return false;
+    _measureDuration(prepared);
     await player.seek(Duration(milliseconds: progress));
     return true;
   }
@@ -173,9 +434,18 @@ class DesktopAudioHandler {
       _completionSubscriptions = {};
 
   Future<void> setReleaseMode(String key, FinishMode mode) async {
-    final player = _players[key];
-    if (player == null) return;
+    final prepared = _prepared[key];
+    if (prepared == null) return;
+    prepared.finishMode = mode;
+    final player = prepared.player;
+    if (player != null) await _applyFinishMode(key, player, mode);
+  }
 
+  Future<void> _applyFinishMode(
+    String key,
+    ja.AudioPlayer player,
+    FinishMode mode,
+  ) async {
     await _completionSubscriptions[key]?.cancel();
     _completionSubscriptions.remove(key);
 
@@ -205,65 +475,416 @@ class DesktopAudioHandler {
     }
   }
 
+  /// Returns the resident player for [key], opening it first if it was
+  /// never opened or has been evicted. The entry becomes the most recently
+  /// used one.
+  Future<ja.AudioPlayer?> _activate(String key) async {
+    final prepared = _prepared.remove(key);
+    if (prepared == null) return null;
+    _prepared[key] = prepared;
+    return prepared.player ??
+        await (prepared.opening ??= _open(key, prepared));
+  }
+
+  Future<ja.AudioPlayer?> _open(String key, _PreparedPlayer prepared) async {
+    try {
+      await _evictIdlePlayers(maxResidentPlayers - 1);
+      // Idle players are evicted through relieveResourcePressure if the
+      // budget can't hold another one.
+      await _updatePlayerResources(Constants.acquirePlayerResources, key);
+      final player = _playerFactory();
+      try {
+        final duration = await player.setFilePath(prepared.path);
+        prepared.duration ??= duration?.inMilliseconds;
+      } catch (_) {
+        await player.dispose();
+        await _updatePlayerResources(Constants.releasePlayerResources, key);
+        rethrow;
+      }
+      if (_prepared[key] != prepared) {
+        // Released or re-prepared while the file was being opened.
+        await player.dispose();
+        await _updatePlayerResources(Constants.releasePlayerResources, key);
+        return null;
+      }
+      prepared.player = player;
+      _listenPlaybackClock(key, player);
+      if (prepared.volume != null) await player.setVolume(prepared.volume!);
+      if (prepared.speed != null) await player.setSpeed(prepared.speed!);
+      if (prepared.finishMode != null) {
+        await _applyFinishMode(key, player, prepared.finishMode!);
+      }
+      if (prepared.position > Duration.zero) {
+        await player.seek(prepared.position);
+      }
+      return player;
+    } finally {
+      prepared.opening = null;
+    }
+  }
+
+  /// Disposes least recently used players which are not playing until at
+  /// most [limit] players are resident. Playing players are never evicted,
+  /// so the limit may be exceeded while they are active.
+  Future<void> _evictIdlePlayers(int limit) async {
+    var resident = _prepared.values.where((p) => p.player != null).length;
+    for (final entry in _prepared.entries.toList()) {
+      if (resident <= limit) return;
+      final player = entry.value.player;
+      if (player == null || player.playing) continue;
+      entry.value.position = player.position;
+      await _deactivate(entry.key, entry.value);
+      resident--;
+    }
+  }
+
+  Future<void> _deactivate(String key, _PreparedPlayer prepared) async {
+    await _completionSubscriptions.remove(key)?.cancel();
+    _cancelPlaybackClock(key);
+    final player = prepared.player;
+    if (player == null) return;
+    prepared.player = null;
+    await player.dispose();
+    await _updatePlayerResources(Constants.releasePlayerResources, key);
+  }
+
+  /// Evicts up to [players] idle players because the native resource
+  /// budget is short, see [ResourceBudget].
+  Future<void> relieveResourcePressure(int players) async {
+    final resident = _prepared.values.where((p) => p.player != null).length;
+    await _evictIdlePlayers(resident - players);
+  }
+
+  /// Reserves or releases the share of the native resource budget of the
+  /// player of [key], on platforms with a resource governor.
+  Future<void> _updatePlayerResources(String method, String key) async {
+    if (!Platform.isLinux) return;
+    try {
+      await _methodChannel.invokeMethod(method, {Constants.playerKey: key});
+    } on MissingPluginException {
+      // Not governed without the plugin, for example in unit tests.
+    }
+  }
+
+  /// Starts native spectrum analysis of the file prepared for [key]. The
+  /// native side only knows the file, so playback state changes of the
+  /// player are forwarded to it while the analysis is running, see
+  /// [_updatePlaybackClock].
+  Future<bool> startSpectrumAnalysis({
+    required String key,
+    required int bands,
+    required int fftSize,
+  }) async {
+    final prepared = _prepared[key];
+    if (prepared == null) return false;
+    final started = await _methodChannel
+        .invokeMethod<Object>(Constants.startSpectrumAnalysis, {
+      Constants.playerKey: key,
+      Constants.path: prepared.path,
+      Constants.bands: bands,
+      Constants.fftSize: fftSize,
+      if (SharedFloatBuffer.isSupported) Constants.sharedBuffers: true,
+    });
+    if (!_adoptSpectrum(key, started)) return false;
+    await _updatePlaybackClock(key);
+    return true;
+  }
+
+  /// Starts native spectrum analysis of the audio being recorded, whose
+  /// frames are sent for [Constants.recorderSpectrumKey]. Only recordings
+  /// written by the native writer can be analysed, see [_startWriter]. The
+  /// analysis stops with the recording.
+  Future<bool> startRecordingSpectrum({
+    required int bands,
+    required int fftSize,
+  }) async {
+    final settings = _writerSettings;
+    if (_writerPath == null || settings == null) return false;
+    const key = Constants.recorderSpectrumKey;
+    final started = await _methodChannel
+        .invokeMethod<Object>(Constants.startRecordingSpectrum, {
+      Constants.playerKey: key,
+      Constants.bands: bands,
+      Constants.fftSize: fftSize,
+      Constants.sampleRate: settings.sampleRate,
+      Constants.channels: settings.writerSettings.channels,
+      if (SharedFloatBuffer.isSupported) Constants.sharedBuffers: true,
+    });
+    return _adoptSpectrum(key, started);
+  }
+
+  /// Tracks the analysis of [key] if the plugin [started] it, along with the
+  /// ring of frames it shares.
+  bool _adoptSpectrum(String key, Object? started) {
+    if (started is Map) {
+      // The plugin reduces the bands when the FFT is too short to fill them.
+      _spectrumRings[key] = _SpectrumRing(
+        SharedFloatBuffer.adopt(started[Constants.sharedBuffer] as int),
+        started[Constants.bands] as int,
+      );
+    } else if (started != true) {
+      return false;
+    }
+    _spectrumKeys.add(key);
+    return true;
+  }
+
+  Future<void> stopSpectrumAnalysis(String key) async {
+    _spectrumRings.remove(key);
+    if (!_spectrumKeys.remove(key)) return;
+    await _methodChannel.invokeMethod(Constants.stopSpectrumAnalysis, {
+      Constants.playerKey: key,
+    });
+  }
+
+  /// Frame [version] of the spectrum ring of [key], without copying it.
+  /// Null if the analysis of [key] doesn't share a ring.
+  Float32List? spectrumFrame(String key, int version) =>
+      _spectrumRings[key]?.frame(version);
+
+  void _listenPlaybackClock(String key, ja.AudioPlayer player) {
+    _cancelPlaybackClock(key);
+    // A stream event has no one to report to, and a failed update is
+    // superseded by the next event of the player.
+    void update(_) => _updatePlaybackClock(key).catchError((Object _) {});
+    _clockSubscriptions[key] = [
+      player.playingStream.listen(update),
+      player.playbackEventStream.listen(update),
+      player.speedStream.listen(update),
+    ];
+  }
+
+  void _cancelPlaybackClock(String key) {
+    for (final subscription in _clockSubscriptions.remove(key) ?? const []) {
+      subscription.cancel();
+    }
+  }
+
+  /// Anchors the playback clock of the controller of [key], which has no
+  /// platform reporting positions on desktop, and forwards the same state to
+  /// the native spectrum analysis if it is running.
+  Future<void> _updatePlaybackClock(String key) async {
+    final prepared = _prepared[key];
+    if (prepared == null) return;
+    final player = prepared.player;
+    final position = (player?.position ?? prepared.position).inMilliseconds;
+    final rate = player?.speed ?? prepared.speed ?? 1.0;
+    final isPlaying = player != null &&
+        player.playing &&
+        player.processingState != ja.ProcessingState.completed;
+    PlatformStreams.instance.addPlaybackAnchor(
+      key,
+      position: position,
+      timestamp: PlaybackClock.now(),
+      rate: rate,
+      isPlaying: isPlaying,
+    );
+    if (!_spectrumKeys.contains(key)) return;
+    await _methodChannel.invokeMethod(Constants.updateSpectrumClock, {
+      Constants.playerKey: key,
+      Constants.progress: position,
+      Constants.rate: rate,
+      Constants.isPlaying: isPlaying,
+    });
+  }
+
+  /// Extracts the waveform with the native extractor of the plugin.
+  /// Returns null if the file can't be decoded natively, in which case
+  /// [extractWaveformData] should be used.
+  Future<WaveformExtractionResult?> extractWaveformNatively({
+    required String key,
+    required String path,
+    required int noOfSamples,
+    SilenceDetection? silenceDetection,
+    bool measureLoudness = false,
+    bool progressive = false,
+    ChannelMode channelMode = ChannelMode.mixed,
+  }) async {
+    await stopWaveformExtraction(key);
+    final token = Object();
+    _nativeExtractions[key] = token;
+    final Object? result;
+    try {
+      result = await _methodChannel.invokeMethod(
+        Constants.extractWaveformData,
+        {
+          Constants.playerKey: key,
+          Constants.path: path,
+          Constants.noOfSamples: noOfSamples,
+          ...?silenceDetection?.toJson(),
+          if (measureLoudness) Constants.measureLoudness: true,
+          if (progressive) Constants.progressive: true,
+          if (channelMode != ChannelMode.mixed)
+            Constants.channelMode: channelMode.index,
+          if (SharedFloatBuffer.isSupported) Constants.sharedBuffers: true,
+        },
+      );
+    } finally {
+      if (_nativeExtractions[key] == token) _nativeExtractions.remove(key);
+    }
+    if (result == null) return null;
+    if (result is Map && result[Constants.cancelled] == true) {
+      // Stopped extractions never complete, same as the fallback extractor.
+      return Completer<WaveformExtractionResult>().future;
+    }
+    return WaveformExtractionResult.fromPlatform(result);
+  }
+
+  /// Extracts the waveform with just_waveform, for files the native
+  /// extraction doesn't support. Completes with the maximum of every pixel,
+  /// converted on a background isolate for long waveforms.
   Future<List<double>> extractWaveformData({
     required String key,
     required String path,
     required int noOfSamples,
   }) async {
     await stopWaveformExtraction(key);
-    final tempFile =
-        File('${(await Directory.systemTemp.createTemp()).path}/waveform_$key');
+    final completer = Completer<List<double>>();
+    _waveformCompleters[key] = completer;
+    final directory = await _waveformDirectory();
+    // Stopped or replaced while the directory was created.
+    if (_waveformCompleters[key] != completer) return completer.future;
+    final tempFile = File('${directory.path}/waveform_$key');
     final stream = _waveformExtractor(
       audioInFile: File(path),
       waveOutFile: tempFile,
       zoom: WaveformZoom.pixelsPerSecond(noOfSamples),
     );
-    final completer = Completer<List<double>>();
-    _waveformCompleters[key] = completer;
-    _waveformSubscriptions[key] = stream.listen(
-      (event) {
+    late final StreamSubscription subscription;
+    subscription = stream.listen(
+      (event) async {
         final progress = event.progress as double? ?? 0.0;
         PlatformStreams.instance.addExtractionProgress(
           PlayerIdentifier<double>(key, progress),
         );
         if (progress == 1.0 && event.waveform != null) {
-          final waveform = event.waveform as Waveform;
-          final points = <double>[];
-          for (var i = 0; i < waveform.length; i++) {
-            points.add(waveform.getPixelMax(i).toDouble());
-          }
+          final points = await _pixelMaxima(event.waveform as Waveform);
+          if (_waveformCompleters[key] != completer) return;
+          _waveformCompleters.remove(key);
           PlatformStreams.instance.addExtractedWaveformDataEvent(
             PlayerIdentifier<List<double>>(key, points),
           );
           completer.complete(points);
         }
       },
-      onError: completer.completeError,
-      onDone: () {
-        _waveformSubscriptions.remove(key);
+      onError: (Object error, StackTrace stackTrace) {
+        if (_waveformCompleters[key] != completer) return;
         _waveformCompleters.remove(key);
+        completer.completeError(error, stackTrace);
+      },
+      onDone: () {
+        if (_waveformSubscriptions[key] == subscription) {
+          _waveformSubscriptions.remove(key);
+        }
+        _deleteQuietly(tempFile);
       },
     );
+    _waveformSubscriptions[key] = subscription;
     return completer.future;
   }
 
+  /// Directory holding the output of running just_waveform extractions,
+  /// created once and shared by every extraction of this handler. Files are
+  /// deleted as soon as their extraction ends.
+  Future<Directory> _waveformDirectory() async {
+    final directory = await (_waveformTempDirectory ??=
+        Directory.systemTemp.createTemp('audio_waveforms_'));
+    // Temp cleaners may remove it while the app is running.
+    if (!await directory.exists()) await directory.create(recursive: true);
+    return directory;
+  }
+
+  static Future<void> _deleteQuietly(File file) async {
+    try {
+      await file.delete();
+    } on FileSystemException {
+      // Never written, or already gone.
+    }
+  }
+
+  /// Waveforms with fewer pixels are converted on the calling isolate, as
+  /// spawning an isolate costs more than converting them.
+  static const _isolateConversionThreshold = 1 << 14;
+
+  static Future<Float64List> _pixelMaxima(Waveform waveform) async {
+    Float64List convert() {
+      final points = Float64List(waveform.length);
+      for (var i = 0; i < points.length; i++) {
+        points[i] = waveform.getPixelMax(i).toDouble();
+      }
+      return points;
+    }
+
+    if (waveform.length < _isolateConversionThreshold) return convert();
+    return Isolate.run(convert);
+  }
+
   Future<void> stopWaveformExtraction(String key) async {
-    await _waveformSubscriptions[key]?.cancel();
-    _waveformSubscriptions.remove(key);
+    if (_nativeExtractions.remove(key) != null) {
+      await _methodChannel.invokeMethod(Constants.stopExtraction, {
+        Constants.playerKey: key,
+      });
+    }
     _waveformCompleters.remove(key);
+    // Cancelling doesn't run onDone, so the output is deleted here.
+    final subscription = _waveformSubscriptions.remove(key);
+    if (subscription != null) {
+      await subscription.cancel();
+      final directory = await _waveformTempDirectory;
+      if (directory != null) {
+        await _deleteQuietly(File('${directory.path}/waveform_$key'));
+      }
+    }
   }
 
   Future<bool> stopAllPlayers() async {
-    for (final player in _players.values) {
-      await player.stop();
+    for (final prepared in _prepared.values) {
+      prepared.position = Duration.zero;
+      await prepared.player?.stop();
     }
     return true;
   }
 
   Future<bool> pauseAllPlayers() async {
-    for (final player in _players.values) {
-      await player.pause();
+    for (final prepared in _prepared.values) {
+      await prepared.player?.pause();
     }
     return true;
   }
 }
+
+/// The frames of a spectrum analysis written by the plugin in turn.
+class _SpectrumRing {
+  _SpectrumRing(this.buffer, this.bands);
+
+  final SharedFloatBuffer buffer;
+  final int bands;
+
+  /// A view of frame [version], which is overwritten once the plugin wrapped
+  /// around the ring.
+  Float32List? frame(int version) {
+    final frames = buffer.data.length ~/ bands;
+    if (version <= 0 || frames == 0) return null;
+    final start = (version - 1) % frames * bands;
+    return Float32List.sublistView(buffer.data, start, start + bands);
+  }
+}
+
+/// Playback configuration of a prepared player. [player] is only set while
+/// the decoder is resident, the remaining fields survive eviction so the
+/// player can be re-opened transparently.
+class _PreparedPlayer {
+  _PreparedPlayer(this.path);
+
+  final String path;
+  ja.AudioPlayer? player;
+  double? volume;
+  double? speed;
+  FinishMode? finishMode;
+  Future<ja.AudioPlayer?>? opening;
+  Duration position = Duration.zero;
+  int? duration;
+
+  /// Whether the frames of the file were walked for its exact duration.
+  bool measured = false;
+}
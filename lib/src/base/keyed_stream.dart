@@ -0,0 +1,74 @@
+import 'dart:async';
+
+import 'player_identifier.dart';
+
+/// Broadcasts events of many players and routes each of them only to the
+/// listeners of its player, so the cost of an event doesn't grow with the
+/// number of players which are listened to.
+///
+/// The [stream] of all events is kept for listeners interested in every
+/// player, events are only added to it while it has a listener.
+class KeyedStreamController<T> {
+  final _all = StreamController<PlayerIdentifier<T>>.broadcast();
+  final _listeners = <String, List<MultiStreamController<T>>>{};
+  bool _isClosed = false;
+
+  bool get isClosed => _isClosed;
+
+  /// Whether any stream, of all players or of one, has a listener.
+  bool get hasListener => _all.hasListener || _listeners.isNotEmpty;
+
+  /// Events of all players, identified by their player key.
+  KeyedStream<T> get stream => KeyedStream._(this);
+
+  /// Events of the player identified by [key]. Listeners are registered
+  /// with the key on listen and dropped again on cancel.
+  Stream<T> forKey(String key) {
+    return Stream<T>.multi((controller) {
+      if (_isClosed) {
+        controller.closeSync();
+        return;
+      }
+      final listeners = _listeners.putIfAbsent(key, () => []);
+      listeners.add(controller);
+      controller.onCancel = () {
+        listeners.remove(controller);
+        if (listeners.isEmpty && _listeners[key] == listeners) {
+          _listeners.remove(key);
+        }
+      };
+    }, isBroadcast: true);
+  }
+
+  void add(PlayerIdentifier<T> event) {
+    if (_isClosed) return;
+    if (_all.hasListener) _all.add(event);
+    final listeners = _listeners[event.playerKey];
+    if (listeners == null) return;
+    for (final listener in listeners) {
+      listener.add(event.type);
+    }
+  }
+
+  void close() {
+    if (_isClosed) return;
+    _isClosed = true;
+    _all.close();
+    final listeners = _listeners.values.expand((l) => l).toList();
+    _listeners.clear();
+    for (final listener in listeners) {
+      listener.close();
+    }
+  }
+}
+
+/// The stream of all events of a [KeyedStreamController], which also
+/// provides the events of a single player without filtering the others.
+class KeyedStream<T> extends StreamView<PlayerIdentifier<T>> {
+  KeyedStream._(this._controller) : super(_controller._all.stream);
+
+  final KeyedStreamController<T> _controller;
+
+  /// Events of the player identified by [key].
+  Stream<T> forKey(String key) => _controller.forKey(key);
+}
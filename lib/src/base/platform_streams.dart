@@ -1,9 +1,16 @@
-import 'dart:async';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
 
 import '../../audio_waveforms.dart';
+import 'keyed_stream.dart';
+import 'playback_clock.dart';
 import 'player_identifier.dart';
 
 ///This class should be used for any type of native streams.
+///
+///Events are dispatched by player key, controllers listen to the events of
+///their own player with [KeyedStream.forKey].
 class PlatformStreams {
   PlatformStreams._();
 
@@ -12,6 +19,10 @@ class PlatformStreams {
   ///PlayerController.
   final Map<String, PlayerController> playerControllerFactory = {};
 
+  /// Playback clocks of the players in [playerControllerFactory], which
+  /// extrapolate their positions between anchors sent by the platform.
+  final Map<String, PlaybackClock> playbackClocks = {};
+
   static PlatformStreams instance = PlatformStreams._();
 
   bool isInitialised = false;
@@ -23,78 +34,110 @@ class PlatformStreams {
     // initialised due to race condition when using widget in ListView.builder.
     isInitialised = true;
 
-    _currentDurationController =
-        StreamController<PlayerIdentifier<int>>.broadcast();
-    _playerStateController =
-        StreamController<PlayerIdentifier<PlayerState>>.broadcast();
-    _extractedWaveformDataController =
-        StreamController<PlayerIdentifier<List<double>>>.broadcast();
-    _extractionProgressController =
-        StreamController<PlayerIdentifier<double>>.broadcast();
-    _completionController =
-        StreamController<PlayerIdentifier<void>>.broadcast();
+    _currentDurationController = KeyedStreamController<int>();
+    _playerStateController = KeyedStreamController<PlayerState>();
+    _extractedWaveformDataController = KeyedStreamController<List<double>>();
+    _extractionProgressController = KeyedStreamController<double>();
+    _extractionResolutionController = KeyedStreamController<int>();
+    _completionController = KeyedStreamController<void>();
+    _spectrumController = KeyedStreamController<Float32List>();
     await AudioWaveformsInterface.instance.setMethodCallHandler();
   }
 
-  Stream<PlayerIdentifier<int>> get onDurationChanged =>
-      _currentDurationController.stream;
+  KeyedStream<int> get onDurationChanged => _currentDurationController.stream;
 
-  Stream<PlayerIdentifier<PlayerState>> get onPlayerStateChanged =>
+  KeyedStream<PlayerState> get onPlayerStateChanged =>
       _playerStateController.stream;
 
-  Stream<PlayerIdentifier<List<double>>> get onCurrentExtractedWaveformData =>
+  KeyedStream<List<double>> get onCurrentExtractedWaveformData =>
       _extractedWaveformDataController.stream;
 
-  Stream<PlayerIdentifier<double>> get onExtractionProgress =>
+  KeyedStream<double> get onExtractionProgress =>
       _extractionProgressController.stream;
 
-  Stream<PlayerIdentifier<void>> get onCompletion =>
-      _completionController.stream;
-
-  late StreamController<PlayerIdentifier<int>> _currentDurationController;
-  late StreamController<PlayerIdentifier<PlayerState>> _playerStateController;
-  late StreamController<PlayerIdentifier<List<double>>>
-      _extractedWaveformDataController;
-  late StreamController<PlayerIdentifier<double>> _extractionProgressController;
-  late StreamController<PlayerIdentifier<void>> _completionController;
+  KeyedStream<int> get onExtractionResolution =>
+      _extractionResolutionController.stream;
+
+  KeyedStream<void> get onCompletion => _completionController.stream;
+
+  KeyedStream<Float32List> get onSpectrumData => _spectrumController.stream;
+
+  /// Whether any stream still has a subscriber. Used to detect
+  /// subscriptions which outlive the widgets and controllers that made them.
+  @visibleForTesting
+  bool get hasListeners =>
+      isInitialised &&
+      (_currentDurationController.hasListener ||
+          _playerStateController.hasListener ||
+          _extractedWaveformDataController.hasListener ||
+          _extractionProgressController.hasListener ||
+          _extractionResolutionController.hasListener ||
+          _completionController.hasListener ||
+          _spectrumController.hasListener);
+
+  late KeyedStreamController<int> _currentDurationController;
+  late KeyedStreamController<PlayerState> _playerStateController;
+  late KeyedStreamController<List<double>> _extractedWaveformDataController;
+  late KeyedStreamController<double> _extractionProgressController;
+  late KeyedStreamController<int> _extractionResolutionController;
+  late KeyedStreamController<void> _completionController;
+  late KeyedStreamController<Float32List> _spectrumController;
 
   void addCurrentDurationEvent(PlayerIdentifier<int> playerIdentifier) {
-    if (!_currentDurationController.isClosed) {
-      _currentDurationController.add(playerIdentifier);
-    }
+    _currentDurationController.add(playerIdentifier);
+  }
+
+  /// Anchors the playback clock of the player identified by [key]. The
+  /// [position] in milliseconds was read at [timestamp], in microseconds of
+  /// a monotonic clock.
+  void addPlaybackAnchor(
+    String key, {
+    required int position,
+    required int timestamp,
+    required double rate,
+    required bool isPlaying,
+  }) {
+    playbackClocks[key]?.anchor(
+      position: position,
+      timestamp: timestamp,
+      rate: rate,
+      isPlaying: isPlaying,
+    );
   }
 
   void addPlayerStateEvent(PlayerIdentifier<PlayerState> playerIdentifier) {
-    if (!_playerStateController.isClosed) {
-      _playerStateController.add(playerIdentifier);
-    }
+    _playerStateController.add(playerIdentifier);
   }
 
   void addExtractedWaveformDataEvent(
       PlayerIdentifier<List<double>> playerIdentifier) {
-    if (!_extractedWaveformDataController.isClosed) {
-      _extractedWaveformDataController.add(playerIdentifier);
-    }
+    _extractedWaveformDataController.add(playerIdentifier);
   }
 
   void addExtractionProgress(PlayerIdentifier<double> progress) {
-    if (!_extractionProgressController.isClosed) {
-      _extractionProgressController.add(progress);
-    }
+    _extractionProgressController.add(progress);
+  }
+
+  void addExtractionResolution(PlayerIdentifier<int> level) {
+    _extractionResolutionController.add(level);
   }
 
   void addCompletionEvent(PlayerIdentifier<void> event) {
-    if (!_completionController.isClosed) {
-      _completionController.add(event);
-    }
+    _completionController.add(event);
+  }
+
+  void addSpectrumEvent(PlayerIdentifier<Float32List> event) {
+    _spectrumController.add(event);
   }
 
   void dispose() {
     _currentDurationController.close();
     _playerStateController.close();
     _extractedWaveformDataController.close();
-    _currentDurationController.close();
+    _extractionProgressController.close();
+    _extractionResolutionController.close();
     _completionController.close();
+    _spectrumController.close();
     AudioWaveformsInterface.instance.removeMethodCallHandler();
     isInitialised = false;
   }
@@ -0,0 +1,70 @@
+import 'dart:math' show max, min;
+
+/// Extrapolates the playback position of a player from the last anchor
+/// reported by the platform, a position together with the time it was read,
+/// the playback rate and whether the player was playing.
+///
+/// Anchor timestamps come from a monotonic clock of the platform whose origin
+/// is unknown to Dart. The offset to [now] is estimated as the smallest one
+/// seen so far, which also removes the fixed part of the channel latency.
+/// An offset larger than the smallest by more than [maxLatency] is taken as
+/// a clock discontinuity and replaces the estimate.
+class PlaybackClock {
+  PlaybackClock({
+    int Function()? now,
+    this.maxLatency = const Duration(milliseconds: 250),
+  }) : _now = now ?? PlaybackClock.now;
+
+  static final Stopwatch _stopwatch = Stopwatch()..start();
+
+  /// Monotonic time in microseconds, the clock anchors are mapped onto.
+  static int now() => _stopwatch.elapsedMicroseconds;
+
+  final int Function() _now;
+
+  /// Delivery delay beyond which an anchor is assumed to come from a clock
+  /// which jumped instead of being late.
+  final Duration maxLatency;
+
+  /// Called after every anchor.
+  void Function()? onAnchor;
+
+  int? _offset;
+  int _position = 0;
+  int _time = 0;
+  double _rate = 1.0;
+  bool _isPlaying = false;
+
+  bool get isPlaying => _isPlaying;
+
+  /// Sets the anchor, [position] in milliseconds read at [timestamp] in
+  /// microseconds of the platform clock.
+  void anchor({
+    required int position,
+    required int timestamp,
+    required double rate,
+    required bool isPlaying,
+  }) {
+    final offset = _now() - timestamp;
+    final estimate = _offset;
+    if (estimate == null ||
+        offset < estimate ||
+        offset - estimate > maxLatency.inMicroseconds) {
+      _offset = offset;
+    }
+    _position = position;
+    _time = timestamp + _offset!;
+    _rate = rate;
+    _isPlaying = isPlaying;
+    onAnchor?.call();
+  }
+
+  /// Position in milliseconds at [now], clamped to [maxDuration] when it is
+  /// known.
+  int position({int maxDuration = -1}) {
+    if (!_isPlaying) return _position;
+    final elapsed = max(0, _now() - _time);
+    final position = _position + (elapsed * _rate / 1000).round();
+    return maxDuration < 0 ? position : min(position, maxDuration);
+  }
+}
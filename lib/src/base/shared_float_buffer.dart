@@ -0,0 +1,63 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+
+/// Floats owned by the native plugin which are read in place through
+/// dart:ffi, instead of being copied into and out of platform messages.
+///
+/// The plugin hands over a reference to the buffer with its address. The
+/// reference is released once [data] and every view of it are garbage
+/// collected, so views may be kept without keeping this object.
+class SharedFloatBuffer {
+  SharedFloatBuffer._(this._version, this.data);
+
+  /// Takes over the reference to the buffer at [address].
+  factory SharedFloatBuffer.adopt(
+    int address, {
+    @visibleForTesting Pointer<NativeFinalizerFunction>? release,
+  }) {
+    final version = Pointer<Int64>.fromAddress(address);
+    final length = Pointer<Int64>.fromAddress(address + _lengthOffset).value;
+    final floats = Pointer<Float>.fromAddress(address + _dataOffset);
+    return SharedFloatBuffer._(
+      version,
+      floats.asTypedList(
+        length,
+        finalizer: release ?? _release,
+        token: version.cast(),
+      ),
+    );
+  }
+
+  /// The version and the length precede the floats, see shared_buffer.h.
+  static const _lengthOffset = 8;
+  static const _dataOffset = 32;
+
+  static final Pointer<NativeFinalizerFunction>? _release = _lookupRelease();
+
+  /// Whether the plugin can hand over shared buffers. Otherwise floats
+  /// are sent in platform messages.
+  static bool get isSupported => _release != null;
+
+  final Pointer<Int64> _version;
+
+  /// The floats of the buffer, which the plugin may keep changing.
+  final Float32List data;
+
+  /// Number of times the plugin changed [data], so a reader can tell
+  /// whether it missed a change.
+  int get version => _version.value;
+
+  static Pointer<NativeFinalizerFunction>? _lookupRelease() {
+    if (!Platform.isLinux) return null;
+    try {
+      return DynamicLibrary.process().lookup<NativeFinalizerFunction>(
+          'audio_waveforms_shared_buffer_release');
+    } on ArgumentError {
+      // Not linked into this process, for example in unit tests.
+      return null;
+    }
+  }
+}
@@ -157,6 +157,22 @@ enum WaveformType {
   long
 }
 
+/// Waveforms extracted besides the mixed one, see
+/// [WaveformExtractionController.channelWaveforms]. The mixed waveform is
+/// the RMS of the mono downmix of all channels in every mode.
+enum ChannelMode {
+  /// Only the mixed waveform.
+  mixed,
+
+  /// One waveform per channel, for example one per speaker when every
+  /// speaker was recorded on their own channel.
+  perChannel,
+
+  /// The mid (L + R) / 2 and side (L - R) / 2 waveforms of the first two
+  /// channels. Mono files have a silent side.
+  midSide,
+}
+
 extension WaveformTypeExtension on WaveformType {
   /// Check WaveformType is equals to fitWidth or not.
   bool get isFitWidth => this == WaveformType.fitWidth;
@@ -187,7 +203,7 @@ extension RecorderStateExtension on RecorderState {
 
 /// Rate of updating the reported current duration.
 enum UpdateFrequency {
-  /// Reports duration at every 50 milliseconds.
+  /// Reports duration every frame.
   high(50),
 
   /// Reports duration at every 100 milliseconds.
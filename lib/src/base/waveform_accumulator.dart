@@ -0,0 +1,115 @@
+import 'dart:math' show sqrt;
+import 'dart:typed_data';
+
+/// Accumulates the levels reported while recording into a bounded number of
+/// buckets, so the waveform of a recording is ready as soon as it stops
+/// instead of decoding the file again.
+///
+/// Once every bucket is in use, adjacent buckets are merged and each bucket
+/// covers twice as many levels from then on. Buckets keep sums of squares,
+/// so merged values are the exact RMS of the levels they cover.
+///
+/// The levels are those of the live recorder waveform, normalised against
+/// the quietest and loudest level so far, not the RMS of the samples the
+/// waveform extraction computes.
+class WaveformAccumulator {
+  WaveformAccumulator({this.capacity = 4096})
+      : assert(capacity >= 2 && capacity.isEven),
+        _sums = Float64List(capacity),
+        _counts = Int32List(capacity);
+
+  /// Maximum number of buckets.
+  final int capacity;
+
+  final Float64List _sums;
+  final Int32List _counts;
+  int _length = 0;
+  int _levelsPerBucket = 1;
+
+  bool get isEmpty => _length == 0;
+
+  void add(double level) {
+    final last = _length - 1;
+    if (last >= 0 && _counts[last] < _levelsPerBucket) {
+      _sums[last] += level * level;
+      _counts[last]++;
+      return;
+    }
+    if (_length == capacity) _merge();
+    _sums[_length] = level * level;
+    _counts[_length] = 1;
+    _length++;
+  }
+
+  void _merge() {
+    for (var i = 0; i < capacity ~/ 2; i++) {
+      _sums[i] = _sums[2 * i] + _sums[2 * i + 1];
+      _counts[i] = _counts[2 * i] + _counts[2 * i + 1];
+    }
+    _length = capacity ~/ 2;
+    _levelsPerBucket *= 2;
+  }
+
+  /// RMS level of every bucket in recording order.
+  Float32List get buckets => Float32List.fromList([
+        for (var i = 0; i < _length; i++) sqrt(_sums[i] / _counts[i]),
+      ]);
+
+  /// Waveform with [noOfSamples] points covering the whole recording, the
+  /// same shape `extractWaveformData` returns.
+  List<double> toWaveform(int noOfSamples) {
+    return List<double>.generate(noOfSamples, (i) {
+      if (_length == 0) return 0;
+      var (start, end) = _span(i, noOfSamples, _length);
+      var sum = 0.0;
+      var count = 0;
+      for (; start < end; start++) {
+        sum += _sums[start];
+        count += _counts[start];
+      }
+      return sqrt(sum / count);
+    });
+  }
+
+  void clear() {
+    _length = 0;
+    _levelsPerBucket = 1;
+  }
+
+  /// Resamples RMS [values] to [noOfSamples] points, for buckets which were
+  /// persisted without their level counts.
+  static List<double> resample(List<double> values, int noOfSamples) {
+    return List<double>.generate(noOfSamples, (i) {
+      if (values.isEmpty) return 0;
+      var (start, end) = _span(i, noOfSamples, values.length);
+      var sum = 0.0;
+      final count = end - start;
+      for (; start < end; start++) {
+        sum += values[start] * values[start];
+      }
+      return sqrt(sum / count);
+    });
+  }
+
+  /// Resamples peak [values] to [noOfSamples] points, each the loudest of
+  /// the buckets it covers.
+  static List<double> resamplePeaks(List<double> values, int noOfSamples) {
+    return List<double>.generate(noOfSamples, (i) {
+      if (values.isEmpty) return 0;
+      var (start, end) = _span(i, noOfSamples, values.length);
+      var peak = 0.0;
+      for (; start < end; start++) {
+        if (values[start] > peak) peak = values[start];
+      }
+      return peak;
+    });
+  }
+
+  /// Buckets covered by point [index] out of [points]. Every point covers at
+  /// least one bucket, so short recordings repeat buckets.
+  static (int, int) _span(int index, int points, int length) {
+    final start = index * length ~/ points;
+    final end = (index + 1) * length ~/ points;
+    return (start, end > start ? end : start + 1);
+  }
+}
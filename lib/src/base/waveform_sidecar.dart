@@ -0,0 +1,104 @@
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'waveform_accumulator.dart';
+
+/// Waveform of a recording persisted next to its audio file, so it can be
+/// shown without decoding the file.
+///
+/// The buckets are computed from the recorded samples, so their RMS levels
+/// are the ones waveform extraction of the file returns.
+///
+/// The file holds a 4 byte magic, the recording duration in milliseconds,
+/// the number of buckets, the RMS levels and then the peaks of the buckets
+/// as little-endian floats.
+class WaveformSidecar {
+  const WaveformSidecar({
+    required this.buckets,
+    required this.peaks,
+    required this.duration,
+  });
+
+  static const _magic = 0x32465741; // "AWF2"
+  static const _headerLength = 12;
+
+  /// RMS levels of equally long buckets covering the recording in order.
+  final List<double> buckets;
+
+  /// Peak levels of the same buckets, as many as [buckets].
+  final List<double> peaks;
+
+  final Duration duration;
+
+  /// Waveform with [noOfSamples] points.
+  List<double> toWaveform(int noOfSamples) =>
+      WaveformAccumulator.resample(buckets, noOfSamples);
+
+  /// Peak levels with [noOfSamples] points.
+  List<double> toPeaks(int noOfSamples) =>
+      WaveformAccumulator.resamplePeaks(peaks, noOfSamples);
+
+  /// Location of the sidecar of [audioPath].
+  static String pathFor(String audioPath) => '$audioPath.waveform';
+
+  /// Writes the sidecar of [audioPath] and returns its path.
+  Future<String> write(String audioPath) async {
+    final count = buckets.length;
+    final data = ByteData(_headerLength + count * 8)
+      ..setUint32(0, _magic, Endian.little)
+      ..setUint32(4, duration.inMilliseconds, Endian.little)
+      ..setUint32(8, count, Endian.little);
+    for (var i = 0; i < count; i++) {
+      data.setFloat32(_headerLength + i * 4, buckets[i], Endian.little);
+      data.setFloat32(
+          _headerLength + (count + i) * 4, peaks[i], Endian.little);
+    }
+    final path = pathFor(audioPath);
+    await File(path).writeAsBytes(data.buffer.asUint8List(), flush: true);
+    return path;
+  }
+
+  /// Reads the sidecar of [audioPath]. Returns null if there is none, it is
+  /// malformed, of an older format or the audio file changed after it was
+  /// written.
+  static Future<WaveformSidecar?> read(String audioPath) async {
+    final file = File(pathFor(audioPath));
+    try {
+      final audio = File(audioPath);
+      if (!await file.exists() ||
+          (await file.lastModified()).isBefore(await audio.lastModified())) {
+        return null;
+      }
+      final bytes = await file.readAsBytes();
+      if (bytes.length < _headerLength) return null;
+      final data = ByteData.sublistView(bytes);
+      final count = data.getUint32(8, Endian.little);
+      if (data.getUint32(0, Endian.little) != _magic ||
+          bytes.length != _headerLength + count * 8) {
+        return null;
+      }
+      return WaveformSidecar(
+        duration: Duration(milliseconds: data.getUint32(4, Endian.little)),
+        buckets: [
+          for (var i = 0; i < count; i++)
+            data.getFloat32(_headerLength + i * 4, Endian.little),
+        ],
+        peaks: [
+          for (var i = 0; i < count; i++)
+            data.getFloat32(_headerLength + (count + i) * 4, Endian.little),
+        ],
+      );
+    } on FileSystemException {
+      return null;
+    }
+  }
+
+  /// Removes a stale sidecar of [audioPath], if any.
+  static Future<void> delete(String audioPath) async {
+    try {
+      await File(pathFor(audioPath)).delete();
+    } on FileSystemException {
+      // There was none.
+    }
+  }
+}
@@ -2,13 +2,16 @@ import 'dart:async';
 import 'dart:io';
 
 import 'package:flutter/foundation.dart';
+import 'package:flutter/scheduler.dart';
 import 'package:flutter/services.dart';
 
 import '../../audio_waveforms.dart';
 import '../base/constants.dart';
 import '../base/platform_streams.dart';
+import '../base/playback_clock.dart';
 import '../base/player_identifier.dart';
 import '../base/desktop_audio_handler.dart';
+import '../base/waveform_sidecar.dart';
 
 part '../base/audio_waveforms_interface.dart';
 part 'waveform_extraction_controller.dart';
@@ -46,11 +49,14 @@ class PlayerController extends ChangeNotifier {
   bool get shouldClearLabels => _shouldClearLabels;
 
   /// Rate of updating the reported current duration. Making it high will
-  /// cause reporting duration at faster rate which also causes UI to look
+  /// cause reporting duration every frame which also causes UI to look
   /// smoother.
   ///
-  /// **Important** -: As duration is reported from platform, low-end devices
-  /// may have higher impact if UpdateFrequency is set to high.
+  /// The platform only reports the position when playback starts, stops,
+  /// seeks or changes rate and about once a second to correct drift, the
+  /// position in between is extrapolated in Dart. The frequency therefore
+  /// doesn't add platform channel traffic, but high keeps frames scheduled
+  /// while playing.
   ///
   /// Defaults to low (updates every 200 milliseconds).
   ///
@@ -78,22 +84,93 @@ class PlayerController extends ChangeNotifier {
   /// A stream to get current state of the player. This stream
   /// will emit event whenever there is change in the playerState.
   Stream<PlayerState> get onPlayerStateChanged =>
-      PlatformStreams.instance.onPlayerStateChanged.filter(playerKey);
+      PlatformStreams.instance.onPlayerStateChanged.forKey(playerKey);
 
-  /// A stream to get current duration. This stream will emit
-  /// every 200 milliseconds. Emitted duration is in milliseconds.
+  /// A stream to get current duration. While playing, this stream emits at
+  /// the rate set with [updateFrequency]. Emitted duration is in
+  /// milliseconds.
   Stream<int> get onCurrentDurationChanged =>
-      PlatformStreams.instance.onDurationChanged.filter(playerKey);
+      PlatformStreams.instance.onDurationChanged.forKey(playerKey);
 
   /// A stream to get events when audio is finished playing.
   Stream<void> get onCompletion =>
-      PlatformStreams.instance.onCompletion.filter(playerKey);
+      PlatformStreams.instance.onCompletion.forKey(playerKey);
+
+  /// A stream to get spectrum frames while spectrum analysis is running.
+  /// Each frame holds one value between 0.0 and 1.0 per frequency band,
+  /// ordered from low to high frequencies.
+  ///
+  /// On Linux frames are views of a ring shared with the plugin, which is
+  /// overwritten eight frames later. Copy a frame to keep it longer.
+  ///
+  /// See also:
+  /// * [startSpectrumAnalysis]
+  Stream<Float32List> get onSpectrumChanged =>
+      PlatformStreams.instance.onSpectrumData.forKey(playerKey);
+
+  final _playbackClock = PlaybackClock();
+  Timer? _positionTimer;
+  int? _positionFrameCallback;
+  int? _lastPosition;
 
   PlayerController() {
     if (!PlatformStreams.instance.isInitialised) {
       PlatformStreams.instance.init();
     }
     PlatformStreams.instance.playerControllerFactory.addAll({playerKey: this});
+    PlatformStreams.instance.playbackClocks[playerKey] = _playbackClock
+      ..onAnchor = _onPlaybackAnchor;
+  }
+
+  void _onPlaybackAnchor() {
+    _emitPosition();
+    if (_playbackClock.isPlaying && !_isDisposed) {
+      _startPositionUpdates();
+    } else {
+      _stopPositionUpdates();
+    }
+  }
+
+  void _startPositionUpdates() {
+    if (updateFrequency == UpdateFrequency.high) {
+      _positionTimer?.cancel();
+      _positionTimer = null;
+      _positionFrameCallback ??= _scheduleFramePosition();
+    } else {
+      _cancelFramePosition();
+      _positionTimer ??= Timer.periodic(
+        Duration(milliseconds: updateFrequency.value),
+        (_) => _emitPosition(),
+      );
+    }
+  }
+
+  void _stopPositionUpdates() {
+    _positionTimer?.cancel();
+    _positionTimer = null;
+    _cancelFramePosition();
+  }
+
+  int _scheduleFramePosition() {
+    return SchedulerBinding.instance.scheduleFrameCallback((_) {
+      _positionFrameCallback = _scheduleFramePosition();
+      _emitPosition();
+    });
+  }
+
+  void _cancelFramePosition() {
+    final id = _positionFrameCallback;
+    if (id == null) return;
+    SchedulerBinding.instance.cancelFrameCallbackWithId(id);
+    _positionFrameCallback = null;
+  }
+
+  void _emitPosition() {
+    final position = _playbackClock.position(maxDuration: _maxDuration);
+    if (position == _lastPosition) return;
+    _lastPosition = position;
+    PlatformStreams.instance
+        .addCurrentDurationEvent(PlayerIdentifier<int>(playerKey, position));
   }
 
   void _setPlayerState(PlayerState state) {
@@ -125,11 +202,22 @@ class PlayerController extends ChangeNotifier {
   /// number of bars in the waveform.
   ///
   /// Defaults to 100.
+  ///
+  /// [silenceDetection], [measureLoudness], [progressive] and [channelMode]
+  /// are passed to the waveform extraction, see
+  /// [WaveformExtractionController.audioSegments],
+  /// [WaveformExtractionController.loudness],
+  /// [WaveformExtractionController.channelWaveforms] and
+  /// [WaveformExtractionController.extractWaveformData].
   Future<void> preparePlayer({
     required String path,
     double? volume,
     bool shouldExtractWaveform = true,
     int noOfSamples = 100,
+    SilenceDetection? silenceDetection,
+    bool measureLoudness = false,
+    bool progressive = false,
+    ChannelMode channelMode = ChannelMode.mixed,
   }) async {
     path = Uri.parse(path).path;
     final isPrepared = await AudioWaveformsInterface.instance.preparePlayer(
@@ -149,6 +237,10 @@ class PlayerController extends ChangeNotifier {
           .extractWaveformData(
         path: path,
         noOfSamples: noOfSamples,
+        silenceDetection: silenceDetection,
+        measureLoudness: measureLoudness,
+        progressive: progressive,
+        channelMode: channelMode,
       )
           .then(
         (value) {
@@ -254,6 +346,32 @@ class PlayerController extends ChangeNotifier {
     await AudioWaveformsInterface.instance.seekTo(playerKey, progress);
   }
 
+  /// Starts computing the frequency spectrum of the prepared audio file in
+  /// sync with its playback. Frames are emitted with [onSpectrumChanged] at
+  /// display frame rate while playing and once after every pause or seek.
+  ///
+  /// [bands] is the number of logarithmically spaced frequency bands and
+  /// [fftSize] the number of samples analysed per frame. It must be a power
+  /// of two between 64 and 32768.
+  ///
+  /// Returns false if spectrum analysis isn't available for the file.
+  /// Currently it is only supported on Linux for PCM WAV files.
+  Future<bool> startSpectrumAnalysis({
+    int bands = 32,
+    int fftSize = 2048,
+  }) async {
+    return AudioWaveformsInterface.instance.startSpectrumAnalysis(
+      key: playerKey,
+      bands: bands,
+      fftSize: fftSize,
+    );
+  }
+
+  /// Stops spectrum analysis started with [startSpectrumAnalysis].
+  Future<void> stopSpectrumAnalysis() async {
+    return AudioWaveformsInterface.instance.stopSpectrumAnalysis(playerKey);
+  }
+
   /// This method will be used to change behaviour of player when audio
   /// is finished playing.
   ///
@@ -275,6 +393,8 @@ class PlayerController extends ChangeNotifier {
   /// new controller.
   @override
   void dispose() async {
+    _stopPositionUpdates();
+    PlatformStreams.instance.playbackClocks.remove(playerKey);
     if (playerState != PlayerState.stopped) await stopPlayer();
     await release();
     PlatformStreams.instance.playerControllerFactory.remove(playerKey);
@@ -285,6 +405,39 @@ class PlayerController extends ChangeNotifier {
     super.dispose();
   }
 
+  /// Reads the codec, duration, sample rate and channel count of all
+  /// [paths] from their headers without preparing players or decoding
+  /// them, which makes it suitable for laying out lists of recordings.
+  ///
+  /// Returns an entry per path, null if the file couldn't be probed.
+  /// Currently files are probed on Linux, other platforms return nulls.
+  ///
+  /// With [exactDuration], MP3 files without a VBR header and AAC (ADTS)
+  /// files are measured by walking all of their frames instead of
+  /// estimating from the first ones, which reads through the whole file.
+  /// Players on Linux do this the first time they are seeked.
+  static Future<List<MediaInfo?>> probeMedia(
+    List<String> paths, {
+    bool exactDuration = false,
+  }) {
+    return AudioWaveformsInterface.instance
+        .probeMedia(paths, exactDuration: exactDuration);
+  }
+
+  /// Limits the memory and threads the native side of the plugin uses at
+  /// once across all players, recorders and extractions, see
+  /// [ResourceBudget]. Returns false on platforms where it isn't enforced,
+  /// currently all but Linux.
+  static Future<bool> setResourceBudget(ResourceBudget budget) {
+    return AudioWaveformsInterface.instance.setResourceBudget(budget);
+  }
+
+  /// Resources currently reserved under the [ResourceBudget], or null on
+  /// platforms where it isn't enforced.
+  static Future<ResourceUsage?> getResourceUsage() {
+    return AudioWaveformsInterface.instance.getResourceUsage();
+  }
+
   /// Frees [resources] used by all players simultaneously.
   ///
   /// This method closes the stream and releases resources allocated by all
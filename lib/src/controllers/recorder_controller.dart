@@ -1,18 +1,28 @@
 import 'dart:async';
-import 'dart:io' show Platform;
+import 'dart:io' show FileSystemException, Platform;
 import 'dart:math' show max;
+import 'dart:typed_data';
 
 import 'package:flutter/material.dart';
 
 import '/src/base/utils.dart';
 import '../base/constants.dart';
+import '../base/platform_streams.dart';
+import '../base/waveform_accumulator.dart';
+import '../base/waveform_sidecar.dart';
 import '../models/recorder_settings.dart';
+import '../models/recording_result.dart';
+import '../models/recording_writer_stats.dart';
 import 'player_controller.dart';
 
 // ignore_for_file: deprecated_member_use_from_same_package
 class RecorderController extends ChangeNotifier {
   final List<double> _waveData = [];
 
+  /// Waveform of the current recording, independent of [reset] and bounded
+  /// in size for recordings of any length.
+  final WaveformAccumulator _accumulator = WaveformAccumulator();
+
   /// At which rate waveform needs to be updated
   Duration updateFrequency = const Duration(milliseconds: 100);
 
@@ -129,6 +139,20 @@ class RecorderController extends ChangeNotifier {
   Stream<Duration> get onRecordingEnded =>
       _recordedFileDurationController.stream;
 
+  /// A stream to get spectrum frames of the audio being recorded while
+  /// spectrum analysis is running. Frames are like those of
+  /// [PlayerController.onSpectrumChanged].
+  ///
+  /// See also:
+  /// * [startSpectrumAnalysis]
+  Stream<Float32List> get onSpectrumChanged {
+    if (!PlatformStreams.instance.isInitialised) {
+      PlatformStreams.instance.init();
+    }
+    return PlatformStreams.instance.onSpectrumData
+        .forKey(Constants.recorderSpectrumKey);
+  }
+
   /// A class having controls for recording audio and other useful handlers.
   ///
   /// Use [useLegacyNormalization] parameter to use normalization before
@@ -201,6 +225,7 @@ class RecorderController extends ChangeNotifier {
           _setRecorderState(RecorderState.initialized);
         }
         if (_recorderState.isInitialized) {
+          _accumulator.clear();
           _isRecording = await AudioWaveformsInterface.instance.record(
             recorderSetting: recorderSettings,
             path: path,
@@ -270,6 +295,35 @@ class RecorderController extends ChangeNotifier {
     notifyListeners();
   }
 
+  /// Starts computing the frequency spectrum of the audio being recorded.
+  /// Frames are emitted with [onSpectrumChanged] at display frame rate
+  /// while audio arrives, and analysis stops with the recording.
+  ///
+  /// [bands] and [fftSize] are like in
+  /// [PlayerController.startSpectrumAnalysis].
+  ///
+  /// Returns false if spectrum analysis isn't available for the recording.
+  /// Currently it is only supported on Linux while recording to a `.wav`
+  /// path.
+  Future<bool> startSpectrumAnalysis({
+    int bands = 32,
+    int fftSize = 2048,
+  }) async {
+    if (!_recorderState.isRecording && !_recorderState.isPaused) return false;
+    if (!PlatformStreams.instance.isInitialised) {
+      PlatformStreams.instance.init();
+    }
+    return AudioWaveformsInterface.instance.startRecordingSpectrum(
+      bands: bands,
+      fftSize: fftSize,
+    );
+  }
+
+  /// Stops spectrum analysis started with [startSpectrumAnalysis].
+  Future<void> stopSpectrumAnalysis() async {
+    return AudioWaveformsInterface.instance.stopRecordingSpectrum();
+  }
+
   /// Stops the current recording.
   ///
   /// Resources are freed after calling this and file is saved and
@@ -282,27 +336,110 @@ class RecorderController extends ChangeNotifier {
   /// manually else it will start showing waveforms from same place where it
   /// left of for previous recording.
   Future<String?> stop([bool callReset = true]) async {
+    return (await stopRecording(callReset: callReset))?.path;
+  }
+
+  /// Stops the current recording like [stop] and also returns its duration
+  /// and waveform, so the recording can be shown right away without
+  /// decoding the file again.
+  ///
+  /// The waveform has [noOfSamples] points like
+  /// [WaveformExtractionController.extractWaveformData]. When the native
+  /// writer wrote the recording (Linux, `.wav` paths) it is computed from
+  /// the written samples, with the values extraction of the file returns.
+  /// Otherwise it is accumulated from the levels measured while recording,
+  /// which follow the live recorder waveform, and it is empty when
+  /// [useLegacyNormalization] is enabled, as legacy levels aren't
+  /// normalised.
+  ///
+  /// Setting [saveWaveform] persists the waveform of a recording written by
+  /// the native writer next to the file. Waveform extraction of that file
+  /// then reads it instead of decoding the file.
+  ///
+  /// Returns null if nothing was being recorded.
+  Future<RecordingResult?> stopRecording({
+    bool callReset = true,
+    int noOfSamples = 100,
+    bool saveWaveform = false,
+  }) async {
     if (_recorderState.isRecording || _recorderState.isPaused) {
       final audioInfo = await AudioWaveformsInterface.instance.stop();
       _isRecording = false;
       _timer?.cancel();
       _recorderTimer?.cancel();
+      Duration? duration;
       if (audioInfo[Constants.resultDuration] != null) {
-        final duration = audioInfo[Constants.resultDuration];
-
-        _recordedDuration = Duration(milliseconds: duration);
+        duration =
+            Duration(milliseconds: audioInfo[Constants.resultDuration]);
+        _recordedDuration = duration;
         _recordedFileDurationController.add(recordedDuration);
       }
+      final String? path = audioInfo[Constants.resultFilePath];
+      final samples = _writtenWaveform(
+        audioInfo,
+        duration ?? _elapsedDuration,
+      );
+      final waveformPath = path == null
+          ? null
+          : await _persistWaveform(path, samples, save: saveWaveform);
+      final result = RecordingResult(
+        path: path,
+        duration: duration,
+        waveformData: samples != null
+            ? samples.toWaveform(noOfSamples)
+            : _accumulator.isEmpty
+                ? const []
+                : _accumulator.toWaveform(noOfSamples),
+        peakData: samples?.toPeaks(noOfSamples) ?? const [],
+        waveformPath: waveformPath,
+        writerStats: audioInfo[Constants.writerStats] is Map
+            ? RecordingWriterStats.fromMap(audioInfo[Constants.writerStats])
+            : null,
+      );
       _elapsedDuration = Duration.zero;
       _setRecorderState(RecorderState.stopped);
       if (callReset) reset();
-      return audioInfo[Constants.resultFilePath];
+      return result;
     }
 
     notifyListeners();
     return null;
   }
 
+  /// The waveform buckets of the samples the native writer wrote, if it
+  /// wrote the recording.
+  WaveformSidecar? _writtenWaveform(
+    Map<String, dynamic> audioInfo,
+    Duration duration,
+  ) {
+    final buckets = audioInfo[Constants.waveformData];
+    final peaks = audioInfo[Constants.waveformPeaks];
+    if (buckets is! List || peaks is! List || buckets.isEmpty) return null;
+    return WaveformSidecar(
+      buckets: List<double>.from(buckets),
+      peaks: List<double>.from(peaks),
+      duration: duration,
+    );
+  }
+
+  /// Writes the waveform sidecar of [path] when [save] is set, otherwise
+  /// removes a sidecar left by an earlier recording to the same path.
+  Future<String?> _persistWaveform(
+    String path,
+    WaveformSidecar? waveform, {
+    required bool save,
+  }) async {
+    if (!save || waveform == null) {
+      await WaveformSidecar.delete(path);
+      return null;
+    }
+    try {
+      return await waveform.write(path);
+    } on FileSystemException {
+      return null;
+    }
+  }
+
   /// Clears WaveData and labels from the list. This will effectively remove
   /// waves and labels from the UI.
   void reset() {
@@ -382,6 +519,7 @@ class RecorderController extends ChangeNotifier {
 
     final scaledWave = (absDb - _currentMin) / (_maxPeak - _currentMin);
     _waveData.add(scaledWave);
+    _accumulator.add(scaledWave);
     notifyListeners();
   }
 
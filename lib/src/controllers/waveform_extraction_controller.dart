@@ -31,15 +31,53 @@ class WaveformExtractionController {
   /// to display waveforms.
   List<double> get waveformData => _waveformData.toList();
 
+  List<List<double>>? _channelWaveforms;
+
+  /// Waveforms of the [ChannelMode] the last file was extracted with, each
+  /// with as many points as [waveformData]. [AudioFileWaveforms] draws one
+  /// lane per waveform once extraction completes. Null for
+  /// [ChannelMode.mixed] or if the platform can't split the file.
+  ///
+  /// Currently channels are split on Android, iOS and Linux (PCM WAV
+  /// files).
+  List<List<double>>? get channelWaveforms => _channelWaveforms;
+
+  List<AudioSegment>? _audioSegments;
+
+  /// Silent and non-silent segments of the last extracted file, computed in
+  /// the same pass as the waveform when [extractWaveformData] was called
+  /// with `silenceDetection`. Null if detection wasn't requested or isn't
+  /// supported on the platform.
+  ///
+  /// Currently segments are computed on Linux for PCM WAV files.
+  List<AudioSegment>? get audioSegments => _audioSegments;
+
+  LoudnessInfo? _loudness;
+
+  /// Integrated loudness, loudness range and peaks of the last extracted
+  /// file, measured in the same pass as the waveform when
+  /// [extractWaveformData] was called with `measureLoudness`. Null if it
+  /// wasn't requested or isn't supported on the platform.
+  ///
+  /// Currently loudness is measured on Linux for PCM WAV files.
+  LoudnessInfo? get loudness => _loudness;
+
   /// A stream to get current extracted waveform data. This stream will emit
   /// list of doubles which are waveform data point.
   Stream<List<double>> get onCurrentExtractedWaveformData =>
       PlatformStreams.instance.onCurrentExtractedWaveformData
-          .filter(_extractorKey);
+          .forKey(_extractorKey);
 
   /// A stream to get current progress of waveform extraction.
   Stream<double> get onExtractionProgress =>
-      PlatformStreams.instance.onExtractionProgress.filter(_extractorKey);
+      PlatformStreams.instance.onExtractionProgress.forKey(_extractorKey);
+
+  /// A stream of the resolution level of every waveform emitted by
+  /// [onCurrentExtractedWaveformData] while extracting with `progressive`.
+  /// Levels start at 0 for the coarsest preview and increase as it is
+  /// refined, the waveform is exact once [onExtractionProgress] reaches 1.
+  Stream<int> get onResolutionLevel =>
+      PlatformStreams.instance.onExtractionResolution.forKey(_extractorKey);
 
   /// Extracts waveform data from provided audio file path.
   /// [noOfSamples] indicates number of extracted data points. This will
@@ -57,14 +95,77 @@ class WaveformExtractionController {
   /// still have to decode whole file.
   ///
   /// noOfSamples defaults to 100.
+  ///
+  /// Providing [silenceDetection] also splits the file into silent and
+  /// non-silent segments while decoding, which are available with
+  /// [audioSegments] once extraction completes.
+  ///
+  /// Setting [measureLoudness] measures the loudness of the file while
+  /// decoding, which is available with [loudness] once extraction completes.
+  ///
+  /// Setting [progressive] makes the first update already span the whole
+  /// file as a rough preview, which is then refined in place instead of
+  /// being filled from start to end, see [onResolutionLevel]. It doesn't
+  /// decode more of the file in total. Progressive extraction is supported
+  /// on Android, iOS and Linux (PCM WAV files, without [silenceDetection]
+  /// or [measureLoudness]), elsewhere the flag is ignored.
+  ///
+  /// Setting [channelMode] also computes the waveform of every channel, or
+  /// the mid and side waveforms, in the same pass, which are available
+  /// with [channelWaveforms] once extraction completes.
+  ///
+  /// The waveform persisted by [RecorderController.stopRecording] with
+  /// `saveWaveform` is read instead of decoding the file when it is still
+  /// current, unless segments, loudness or channels are requested. It holds
+  /// the levels decoding computes, at a resolution of at least 10 ms. Set
+  /// [useSavedWaveform] to false to always decode the file.
   Future<List<double>> extractWaveformData({
     required String path,
     int noOfSamples = 100,
+    SilenceDetection? silenceDetection,
+    bool measureLoudness = false,
+    bool progressive = false,
+    ChannelMode channelMode = ChannelMode.mixed,
+    bool useSavedWaveform = true,
   }) async {
-    return await AudioWaveformsInterface.instance.extractWaveformData(
+    if (useSavedWaveform &&
+        silenceDetection == null &&
+        !measureLoudness &&
+        channelMode == ChannelMode.mixed) {
+      final sidecar = await WaveformSidecar.read(path);
+      if (sidecar != null) {
+        final waveformData = sidecar.toWaveform(noOfSamples);
+        _channelWaveforms = null;
+        _audioSegments = null;
+        _loudness = null;
+        _emitSidecar(waveformData);
+        return waveformData;
+      }
+    }
+    final result = await AudioWaveformsInterface.instance.extractWaveformData(
       key: _extractorKey,
       path: path,
       noOfSamples: noOfSamples,
+      silenceDetection: silenceDetection,
+      measureLoudness: measureLoudness,
+      progressive: progressive,
+      channelMode: channelMode,
+    );
+    _channelWaveforms = result.channelWaveforms;
+    _audioSegments = result.segments;
+    _loudness = result.loudness;
+    return result.waveformData;
+  }
+
+  /// Reports a persisted waveform like a completed extraction.
+  void _emitSidecar(List<double> waveformData) {
+    final streams = PlatformStreams.instance;
+    if (!streams.isInitialised) return;
+    streams.addExtractedWaveformDataEvent(
+      PlayerIdentifier<List<double>>(_extractorKey, waveformData),
+    );
+    streams.addExtractionProgress(
+      PlayerIdentifier<double>(_extractorKey, 1.0),
     );
   }
 
@@ -24,6 +24,8 @@ class IosEncoderSetting {
   /// Higher values (e.g., 24 or 32) improve audio quality but increase file size.
   /// Supported values: 8, 16, 24, 32.
   /// Default value 16 bits.
+  ///
+  /// Also applies to recordings to `.wav` paths on Linux.
   final int? linearPCMBitDepth;
 
   /// Specifies the byte order:
@@ -36,5 +38,8 @@ class IosEncoderSetting {
   ///   false: Integer format.
   ///   true: Floating-point format, often used in scientific or high-precision audio processing.
   /// Default value false.
+  ///
+  /// Also applies to recordings to `.wav` paths on Linux, which only
+  /// support 32 bit floating-point samples.
   final bool? linearPCMIsFloat;
 }
@@ -0,0 +1,32 @@
+import '../base/constants.dart';
+
+/// Properties of an audio file read from its container headers, without
+/// decoding it.
+class MediaInfo {
+  const MediaInfo({
+    required this.codec,
+    required this.duration,
+    required this.sampleRate,
+    required this.channels,
+  });
+
+  factory MediaInfo.fromMap(Map map) {
+    final duration = map[Constants.duration] as int?;
+    return MediaInfo(
+      codec: map[Constants.codec] as String,
+      duration: duration == null ? null : Duration(milliseconds: duration),
+      sampleRate: map[Constants.sampleRate] as int,
+      channels: map[Constants.channels] as int,
+    );
+  }
+
+  /// Short codec name such as `pcm`, `mp3`, `aac`, `vorbis` or `opus`.
+  final String codec;
+
+  /// Null if the headers don't tell the duration.
+  final Duration? duration;
+
+  final int sampleRate;
+
+  final int channels;
+}
@@ -1,6 +1,7 @@
 import '../base/constants.dart';
 import 'android_encoder_settings.dart';
 import 'ios_encoder_setting.dart';
+import 'recording_writer_settings.dart';
 
 /// Class to configure audio recording settings for Android and iOS.
 class RecorderSettings {
@@ -10,11 +11,13 @@ class RecorderSettings {
   /// [iosEncoderSettings] - Specifies encoder settings for iOS devices.
   /// [sampleRate] - Defines the sampling rate for audio recording (default: 44100 Hz).
   /// [bitRate] - Specifies the bit rate for encoding audio (optional).
+  /// [writerSettings] - Configures the writer of WAV recordings on Linux.
   const RecorderSettings({
     this.androidEncoderSettings = const AndroidEncoderSettings(),
     this.iosEncoderSettings = const IosEncoderSetting(),
     this.sampleRate = 44100,
     this.bitRate,
+    this.writerSettings = const RecordingWriterSettings(),
   });
 
   /// Encoder settings for Android devices.
@@ -31,6 +34,10 @@ class RecorderSettings {
   /// Higher values provide better quality but larger file sizes.
   final int? bitRate;
 
+  /// Configures the native writer which records to `.wav` paths on Linux.
+  /// The bit depth and sample format are taken from [iosEncoderSettings].
+  final RecordingWriterSettings writerSettings;
+
   /// Converts the RecorderSettings instance to a JSON map for iOS.
   Map<String, dynamic> iosToJson({
     String? path,
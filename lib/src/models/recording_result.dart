@@ -0,0 +1,38 @@
+import 'recording_writer_stats.dart';
+
+/// Everything known about a recording when it stops.
+class RecordingResult {
+  const RecordingResult({
+    required this.path,
+    required this.duration,
+    required this.waveformData,
+    this.peakData = const [],
+    this.waveformPath,
+    this.writerStats,
+  });
+
+  /// Path of the recorded file. Null if the platform couldn't save it, for
+  /// example when stopping right after starting.
+  final String? path;
+
+  /// Duration of the recorded file. Null if the platform couldn't tell it.
+  final Duration? duration;
+
+  /// Waveform of the recording accumulated while capturing, with the
+  /// requested number of points. It can be passed to [AudioFileWaveforms]
+  /// without extracting the waveform from the file.
+  final List<double> waveformData;
+
+  /// Peak level of every point of [waveformData]. Only available for
+  /// recordings written by the native writer, empty otherwise.
+  final List<double> peakData;
+
+  /// Path of the persisted waveform, if it was requested and the recording
+  /// was written by the native writer. Waveform extraction of [path] reads
+  /// it instead of decoding the file.
+  final String? waveformPath;
+
+  /// Statistics of the native writer, if it wrote the recording. See
+  /// [RecordingWriterSettings].
+  final RecordingWriterStats? writerStats;
+}
@@ -0,0 +1,43 @@
+import '../base/constants.dart';
+
+/// Configures the native writer which encodes WAV recordings on Linux.
+///
+/// Captured audio is queued in memory and written to disk on a dedicated
+/// thread, so a slow disk only fills the queue instead of interrupting the
+/// recording. Audio which doesn't fit into the queue is dropped and
+/// reported in [RecordingResult.writerStats].
+class RecordingWriterSettings {
+  const RecordingWriterSettings({
+    this.channels = 1,
+    this.bufferSize = 1 << 20,
+    this.flushInterval = const Duration(milliseconds: 500),
+    this.syncInterval = const Duration(seconds: 5),
+    this.queueDuration = const Duration(seconds: 10),
+  }) : assert(channels >= 1 && channels <= 8);
+
+  /// Number of channels captured and written, from 1 to 8.
+  final int channels;
+
+  /// Size of the write buffer in bytes. Larger buffers mean fewer, larger
+  /// writes.
+  final int bufferSize;
+
+  /// Longest time encoded audio waits in the write buffer before it is
+  /// written. [Duration.zero] only writes full buffers.
+  final Duration flushInterval;
+
+  /// Interval at which written audio is synced to the disk. [Duration.zero]
+  /// leaves syncing to the operating system.
+  final Duration syncInterval;
+
+  /// Amount of audio the queue holds while the disk is stalled.
+  final Duration queueDuration;
+
+  Map<String, dynamic> toJson() => {
+        Constants.channels: channels,
+        Constants.bufferSize: bufferSize,
+        Constants.flushInterval: flushInterval.inMilliseconds,
+        Constants.syncInterval: syncInterval.inMilliseconds,
+        Constants.queueDuration: queueDuration.inMilliseconds,
+      };
+}
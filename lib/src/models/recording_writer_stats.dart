@@ -0,0 +1,54 @@
+import '../base/constants.dart';
+
+/// How the native writer kept up with a recording, see
+/// [RecordingWriterSettings].
+class RecordingWriterStats {
+  const RecordingWriterStats({
+    required this.framesWritten,
+    required this.droppedBlocks,
+    required this.droppedFrames,
+    required this.backpressureEvents,
+    required this.queueCapacity,
+    required this.peakQueued,
+    required this.longestWrite,
+    required this.ioError,
+  });
+
+  factory RecordingWriterStats.fromMap(Map map) {
+    return RecordingWriterStats(
+      framesWritten: map[Constants.framesWritten] as int,
+      droppedBlocks: map[Constants.droppedBlocks] as int,
+      droppedFrames: map[Constants.droppedFrames] as int,
+      backpressureEvents: map[Constants.backpressureEvents] as int,
+      queueCapacity: map[Constants.queueCapacity] as int,
+      peakQueued: map[Constants.peakQueued] as int,
+      longestWrite: Duration(milliseconds: map[Constants.longestWrite] as int),
+      ioError: map[Constants.ioError] as bool,
+    );
+  }
+
+  final int framesWritten;
+
+  /// Blocks of captured audio which didn't fit into the queue. The
+  /// recording has gaps where they were dropped.
+  final int droppedBlocks;
+
+  final int droppedFrames;
+
+  /// Times the queue filled beyond three quarters of its capacity, a sign
+  /// that the disk falls behind.
+  final int backpressureEvents;
+
+  /// Frames the queue can hold.
+  final int queueCapacity;
+
+  /// Most frames which waited in the queue at once.
+  final int peakQueued;
+
+  /// Longest single write or sync.
+  final Duration longestWrite;
+
+  /// Whether writing failed. Audio captured after the failure is missing
+  /// from the file.
+  final bool ioError;
+}
@@ -0,0 +1,71 @@
+import '../base/constants.dart';
+
+/// Memory and threads the native side of the plugin may use at once,
+/// shared by waveform extractions, spectrum analysis, the recording writer
+/// and open players. Currently only enforced on Linux.
+///
+/// Extractions which don't fit wait until running work finishes. Live work,
+/// such as recording and spectrum analysis, never waits: the recording
+/// queue shrinks instead, down to 100 ms of audio. Whenever the budget is
+/// short, idle players are closed in least recently used order and are
+/// re-opened when they are played or seeked again.
+class ResourceBudget {
+  const ResourceBudget({
+    this.memory = 256 << 20,
+    this.threads = 4,
+  })  : assert(memory > 0),
+        assert(threads > 0);
+
+  /// Bytes of memory. Each open player is accounted with an estimate of
+  /// 16 MB.
+  final int memory;
+
+  /// Threads decoding, analyzing or writing audio at once.
+  final int threads;
+
+  Map<String, dynamic> toJson() => {
+        Constants.memory: memory,
+        Constants.threads: threads,
+      };
+}
+
+/// Resources reserved under the [ResourceBudget] at one point in time.
+class ResourceUsage {
+  const ResourceUsage({
+    required this.budget,
+    required this.memory,
+    required this.threads,
+    required this.queuedJobs,
+    required this.runningExtractions,
+    required this.residentPlayers,
+  });
+
+  factory ResourceUsage.fromMap(Map map) {
+    return ResourceUsage(
+      budget: ResourceBudget(
+        memory: map[Constants.memoryBudget] as int,
+        threads: map[Constants.threadBudget] as int,
+      ),
+      memory: map[Constants.memory] as int,
+      threads: map[Constants.threads] as int,
+      queuedJobs: map[Constants.queuedJobs] as int,
+      runningExtractions: map[Constants.runningExtractions] as int,
+      residentPlayers: map[Constants.residentPlayers] as int,
+    );
+  }
+
+  final ResourceBudget budget;
+
+  /// Bytes reserved, which exceeds the budget while live work can't fit.
+  final int memory;
+
+  final int threads;
+
+  /// Extractions waiting for resources.
+  final int queuedJobs;
+
+  final int runningExtractions;
+
+  /// Players holding an open decoder.
+  final int residentPlayers;
+}
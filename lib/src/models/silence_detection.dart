@@ -0,0 +1,29 @@
+import '../base/constants.dart';
+
+/// Class to configure detection of silent segments during waveform
+/// extraction.
+class SilenceDetection {
+  /// Constructor for SilenceDetection.
+  ///
+  /// [thresholdDb] - Level in dBFS below which audio is silent (default: -50).
+  /// [minDuration] - Shortest silence which is reported as its own segment (default: 300 ms).
+  const SilenceDetection({
+    this.thresholdDb = -50,
+    this.minDuration = const Duration(milliseconds: 300),
+  });
+
+  /// Level in dBFS below which audio is considered silent. It is compared
+  /// with the RMS level of every 10 milliseconds of audio.
+  /// Default is -50 dBFS.
+  final double thresholdDb;
+
+  /// Silence shorter than this is treated as part of the surrounding sound.
+  /// Default is 300 milliseconds.
+  final Duration minDuration;
+
+  /// Converts the SilenceDetection instance to a JSON map for platforms.
+  Map<String, dynamic> toJson() => {
+        Constants.silenceThreshold: thresholdDb,
+        Constants.silenceMinDuration: minDuration.inMilliseconds,
+      };
+}
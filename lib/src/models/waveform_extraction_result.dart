@@ -0,0 +1,123 @@
+import '../base/constants.dart';
+import '../base/shared_float_buffer.dart';
+import '../base/utils.dart';
+
+/// A span of an audio file which is either silent or not.
+class AudioSegment {
+  const AudioSegment({
+    required this.start,
+    required this.end,
+    required this.isSilent,
+  });
+
+  /// Position where the segment starts.
+  final Duration start;
+
+  /// Position where the segment ends.
+  final Duration end;
+
+  /// Whether the audio of this segment is below the silence threshold.
+  final bool isSilent;
+
+  Duration get duration => end - start;
+}
+
+/// Loudness of an audio file measured as specified by EBU R128.
+class LoudnessInfo {
+  const LoudnessInfo({
+    required this.integratedLoudness,
+    required this.loudnessRange,
+    required this.samplePeak,
+    required this.truePeak,
+  });
+
+  factory LoudnessInfo.fromMap(Map map) {
+    return LoudnessInfo(
+      integratedLoudness: map[Constants.integratedLoudness] as double,
+      loudnessRange: map[Constants.loudnessRange] as double,
+      samplePeak: map[Constants.samplePeak] as double,
+      truePeak: map[Constants.truePeak] as double,
+    );
+  }
+
+  /// Gated loudness of the whole file in LUFS. It is
+  /// [double.negativeInfinity] for silent files.
+  final double integratedLoudness;
+
+  /// Loudness range (LRA) in LU, the spread between quiet and loud parts.
+  final double loudnessRange;
+
+  /// Highest absolute sample value in dBFS.
+  final double samplePeak;
+
+  /// Highest level between samples in dBTP, measured by oversampling.
+  final double truePeak;
+
+  /// Gain in dB which brings [integratedLoudness] to [targetLufs], for
+  /// example -23 for EBU R128 broadcast or -14 for most streaming services.
+  double gainTo(double targetLufs) => targetLufs - integratedLoudness;
+}
+
+/// Everything computed by a single waveform extraction pass.
+class WaveformExtractionResult {
+  const WaveformExtractionResult({
+    required this.waveformData,
+    this.channelWaveforms,
+    this.segments,
+    this.loudness,
+  });
+
+  /// Parses the result of a platform extraction. Platforms which only
+  /// compute the waveform return the data points as a list. Waveforms in
+  /// shared buffers are the addresses of the buffers and are not copied.
+  factory WaveformExtractionResult.fromPlatform(dynamic result) {
+    if (result is! Map) {
+      return WaveformExtractionResult(
+        waveformData: List<double>.from(result ?? []),
+      );
+    }
+    final segments = result[Constants.segments] as List<int>?;
+    final loudness = result[Constants.loudness] as Map?;
+    final channels = result[Constants.channelWaveforms] as List?;
+    return WaveformExtractionResult(
+      waveformData: _parseWaveform(result[Constants.waveformData]),
+      channelWaveforms: channels?.map(_parseWaveform).toList(),
+      segments: segments == null ? null : _parseSegments(segments),
+      loudness: loudness == null ? null : LoudnessInfo.fromMap(loudness),
+    );
+  }
+
+  /// Waveform data points, which can be used by [AudioFileWaveforms].
+  final List<double> waveformData;
+
+  /// Waveforms of the requested [ChannelMode], each with as many points as
+  /// [waveformData]. Null for [ChannelMode.mixed] or when the platform
+  /// can't split the file into channels.
+  final List<List<double>>? channelWaveforms;
+
+  /// Silent and non-silent segments covering the whole file in
+  /// chronological order. Null when silence detection wasn't requested or
+  /// isn't supported by the platform.
+  final List<AudioSegment>? segments;
+
+  /// Loudness and peaks of the file. Null when loudness measurement wasn't
+  /// requested or isn't supported by the platform.
+  final LoudnessInfo? loudness;
+
+  static List<double> _parseWaveform(Object? waveform) {
+    if (waveform is int) return SharedFloatBuffer.adopt(waveform).data;
+    return List<double>.from(waveform as List? ?? const []);
+  }
+
+  /// Segments are encoded as (start ms, end ms, silent) triples.
+  static List<AudioSegment> _parseSegments(List<int> values) {
+    return [
+      for (var i = 0; i + 2 < values.length; i += 3)
+        AudioSegment(
+          start: Duration(milliseconds: values[i]),
+          end: Duration(milliseconds: values[i + 1]),
+          isSilent: values[i + 2] != 0,
+        ),
+    ];
+  }
+}
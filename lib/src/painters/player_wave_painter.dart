@@ -6,6 +6,10 @@ import '../base/utils.dart';
 
 class PlayerWavePainter extends CustomPainter {
   final List<double> waveformData;
+
+  /// Drawn in lanes of equal height from top to bottom instead of
+  /// [waveformData], which still decides the number of points.
+  final List<List<double>> channelWaveforms;
   final double animValue;
   final Offset totalBackDistance;
   final Offset dragOffset;
@@ -26,6 +30,7 @@ class PlayerWavePainter extends CustomPainter {
 
   PlayerWavePainter({
     required this.waveformData,
+    this.channelWaveforms = const [],
     required this.animValue,
     required this.dragOffset,
     required this.totalBackDistance,
@@ -80,7 +85,11 @@ class PlayerWavePainter extends CustomPainter {
   void _drawWave(Size size, Canvas canvas) {
     final length = waveformData.length;
     final halfWidth = size.width * 0.5;
-    final halfHeight = size.height * 0.5;
+    final lanes = channelWaveforms.isEmpty ? [waveformData] : channelWaveforms;
+    final laneHeight = size.height / lanes.length;
+    // Waves are scaled down with the lanes so they keep their proportions.
+    final scale =
+        playerWaveStyle.scaleFactor * scrollScale * animValue / lanes.length;
     if (cachedAudioProgress != audioProgress) {
       pushBack();
     }
@@ -91,20 +100,21 @@ class PlayerWavePainter extends CustomPainter {
           currentDragPointer +
           emptySpace +
           (waveformType.isFitWidth ? 0 : halfWidth);
-      final waveHeight = (waveformData[i] * animValue) *
-          playerWaveStyle.scaleFactor *
-          scrollScale;
-      final bottomDy =
-          halfHeight + (playerWaveStyle.showBottom ? waveHeight : 0);
-      final topDy = halfHeight + (playerWaveStyle.showTop ? -waveHeight : 0);
 
       // Only draw waves which are in visible viewport.
       if (dx > 0 && dx < halfWidth * 2) {
-        canvas.drawLine(
-          Offset(dx, bottomDy),
-          Offset(dx, topDy),
-          i < audioProgress * length ? liveWavePaint : fixedWavePaint,
-        );
+        final paint =
+            i < audioProgress * length ? liveWavePaint : fixedWavePaint;
+        for (var lane = 0; lane < lanes.length; lane++) {
+          final data = lanes[lane];
+          if (i >= data.length) continue;
+          final centerDy = laneHeight * (lane + 0.5);
+          final waveHeight = data[i] * scale;
+          final bottomDy =
+              centerDy + (playerWaveStyle.showBottom ? waveHeight : 0);
+          final topDy = centerDy + (playerWaveStyle.showTop ? -waveHeight : 0);
+          canvas.drawLine(Offset(dx, bottomDy), Offset(dx, topDy), paint);
+        }
         if (playerWaveStyle.showDurationLabel) {
           _addLabel(canvas, dx, size, i);
           _drawTextInRange(canvas, i, size);
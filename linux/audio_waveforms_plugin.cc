@@ -4,22 +4,1059 @@
 #include <gtk/gtk.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "media_probe.h"
+#include "recording_writer.h"
+#include "resource_governor.h"
+#include "shared_buffer.h"
+#include "spectrum_stream.h"
+#include "wav_reader.h"
+#include "waveform_extractor.h"
+#include "worker_pool.h"
+
+namespace {
+
+// Work posted to the worker pool for a playerKey. It is current while the
+// plugin maps the key to it, and cancelled when stopped or replaced.
+struct AsyncJob {
+  std::atomic<bool> cancelled{false};
+};
+
+using AsyncJobMap = std::map<std::string, std::shared_ptr<AsyncJob>>;
+
+// Frames of a spectrum stream kept in its shared ring, so Dart can still
+// read a frame after the next ones were analyzed.
+constexpr size_t kSpectrumRingFrames = 8;
+
+// Memory reserved for each player Dart keeps open. Players run outside the
+// plugin, so this is an estimate of their decoder and buffers.
+constexpr size_t kPlayerMemoryBytes = size_t{16} << 20;
+
+using LeaseMap =
+    std::map<std::string, audio_waveforms::ResourceGovernor::LeasePtr>;
+
+}  // namespace
+
 struct _AudioWaveformsPlugin {
   GObject parent_instance;
+
+  // Weak, the messenger owns the channel and the channel's handler owns the
+  // plugin. Null once the channel is gone.
+  FlMethodChannel* channel;
+
+  // Active spectrum streams by playerKey. Only accessed on the main thread.
+  std::map<std::string, std::unique_ptr<audio_waveforms::SpectrumStream>>*
+      spectrums;
+
+  // The stream in |spectrums| fed with the audio of the running recording,
+  // if any. Only accessed on the main thread.
+  audio_waveforms::RecordingSpectrum* recording_spectrum;
+
+  // Spectrum streams whose file is still being opened, by playerKey. Only
+  // accessed on the main thread.
+  AsyncJobMap* spectrum_starts;
+
+  // Running extractions by playerKey. Only accessed on the main thread.
+  AsyncJobMap* extractions;
+
+  // Writer of the running recording, if any. Only accessed on the main
+  // thread.
+  std::shared_ptr<audio_waveforms::RecordingWriter>* recording_writer;
+
+  // Runs every call which decodes or reads files.
+  audio_waveforms::WorkerPool* workers;
+
+  // Budget shared by extractions, spectrum streams, the recording writer
+  // and the players Dart keeps open.
+  audio_waveforms::ResourceGovernor* governor;
+
+  // Resources of the players Dart keeps open, by playerKey. Only accessed
+  // on the main thread.
+  LeaseMap* player_leases;
 };
 
 G_DEFINE_TYPE(AudioWaveformsPlugin, audio_waveforms_plugin, g_object_get_type())
 
+namespace {
+
+constexpr char kPlayerKey[] = "playerKey";
+constexpr char kPath[] = "path";
+constexpr char kBands[] = "bands";
+constexpr char kFftSize[] = "fftSize";
+constexpr char kProgress[] = "progress";
+constexpr char kRate[] = "rate";
+constexpr char kIsPlaying[] = "isPlaying";
+constexpr char kOnSpectrumData[] = "onSpectrumData";
+constexpr char kNoOfSamples[] = "noOfSamples";
+constexpr char kWaveformData[] = "waveformData";
+constexpr char kSegments[] = "segments";
+constexpr char kSilenceThreshold[] = "silenceThreshold";
+constexpr char kSilenceMinDuration[] = "silenceMinDuration";
+constexpr char kMeasureLoudness[] = "measureLoudness";
+constexpr char kLoudness[] = "loudness";
+constexpr char kIntegratedLoudness[] = "integratedLoudness";
+constexpr char kLoudnessRange[] = "loudnessRange";
+constexpr char kSamplePeak[] = "samplePeak";
+constexpr char kTruePeak[] = "truePeak";
+constexpr char kProgressive[] = "progressive";
+constexpr char kResolutionLevel[] = "resolutionLevel";
+constexpr char kCancelled[] = "cancelled";
+constexpr char kChannelMode[] = "channelMode";
+constexpr char kChannelWaveforms[] = "channelWaveforms";
+constexpr char kSharedBuffers[] = "sharedBuffers";
+constexpr char kSharedBuffer[] = "sharedBuffer";
+constexpr char kVersion[] = "version";
+constexpr char kPaths[] = "paths";
+constexpr char kExactDuration[] = "exactDuration";
+constexpr char kCodec[] = "codec";
+constexpr char kDuration[] = "duration";
+constexpr char kSampleRate[] = "sampleRate";
+constexpr char kChannels[] = "channels";
+constexpr char kData[] = "data";
+constexpr char kLinearPcmBitDepth[] = "linearPCMBitDepth";
+constexpr char kLinearPcmIsFloat[] = "linearPCMIsFloat";
+constexpr char kBufferSize[] = "bufferSize";
+constexpr char kFlushInterval[] = "flushInterval";
+constexpr char kSyncInterval[] = "syncInterval";
+constexpr char kQueueDuration[] = "queueDuration";
+constexpr char kFramesWritten[] = "framesWritten";
+constexpr char kDroppedBlocks[] = "droppedBlocks";
+constexpr char kDroppedFrames[] = "droppedFrames";
+constexpr char kBackpressureEvents[] = "backpressureEvents";
+constexpr char kQueueCapacity[] = "queueCapacity";
+constexpr char kPeakQueued[] = "peakQueued";
+constexpr char kLongestWrite[] = "longestWrite";
+constexpr char kIoError[] = "ioError";
+constexpr char kWaveformPeaks[] = "waveformPeaks";
+constexpr char kMemory[] = "memory";
+constexpr char kThreads[] = "threads";
+constexpr char kMemoryBudget[] = "memoryBudget";
+constexpr char kThreadBudget[] = "threadBudget";
+constexpr char kQueuedJobs[] = "queuedJobs";
+constexpr char kRunningExtractions[] = "runningExtractions";
+constexpr char kResidentPlayers[] = "residentPlayers";
+constexpr char kPlayers[] = "players";
+constexpr char kOnResourcePressure[] = "onResourcePressure";
+constexpr char kOnCurrentExtractedWaveformData[] =
+    "onCurrentExtractedWaveformData";
+
+FlValue* lookup_value(FlValue* args, const gchar* key, FlValueType type) {
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return nullptr;
+  }
+  FlValue* value = fl_value_lookup_string(args, key);
+  return value != nullptr && fl_value_get_type(value) == type ? value
+                                                              : nullptr;
+}
+
+const gchar* lookup_string(FlValue* args, const gchar* key) {
+  FlValue* value = lookup_value(args, key, FL_VALUE_TYPE_STRING);
+  return value != nullptr ? fl_value_get_string(value) : nullptr;
+}
+
+int64_t lookup_int(FlValue* args, const gchar* key, int64_t fallback) {
+  FlValue* value = lookup_value(args, key, FL_VALUE_TYPE_INT);
+  return value != nullptr ? fl_value_get_int(value) : fallback;
+}
+
+double lookup_double(FlValue* args, const gchar* key, double fallback) {
+  FlValue* value = lookup_value(args, key, FL_VALUE_TYPE_FLOAT);
+  return value != nullptr ? fl_value_get_float(value) : fallback;
+}
+
+bool lookup_bool(FlValue* args, const gchar* key, bool fallback) {
+  FlValue* value = lookup_value(args, key, FL_VALUE_TYPE_BOOL);
+  return value != nullptr ? fl_value_get_bool(value) : fallback;
+}
+
+FlMethodResponse* missing_argument_response(const gchar* argument) {
+  gchar* details = g_strdup_printf("Argument '%s' is required.", argument);
+  FlMethodResponse* response = FL_METHOD_RESPONSE(
+      fl_method_error_response_new("INVALID_ARGUMENTS", details, nullptr));
+  g_free(details);
+  return response;
+}
+
+// Returns true if |key| still maps to |job| in |jobs|.
+bool is_current_job(AsyncJobMap* jobs, const std::string& key,
+                    const AsyncJob* job) {
+  if (jobs == nullptr) return false;
+  auto it = jobs->find(key);
+  return it != jobs->end() && it->second.get() == job;
+}
+
+void cancel_job(AsyncJobMap* jobs, const std::string& key) {
+  auto it = jobs->find(key);
+  if (it == jobs->end()) return;
+  it->second->cancelled = true;
+  jobs->erase(it);
+}
+
+// A spectrum frame travelling from an analysis thread to the main thread.
+// Streams with a shared ring only send the |version| of the ring.
+struct SpectrumFrame {
+  AudioWaveformsPlugin* plugin;
+  std::string key;
+  audio_waveforms::SpectrumStream* spectrum;
+  std::vector<float> bands;
+  uint64_t version;
+};
+
+// Holds a reference to a shared buffer and releases it when destroyed.
+using SharedBufferRef = std::shared_ptr<audio_waveforms::SharedBuffer>;
+
+SharedBufferRef retain_shared_buffer(audio_waveforms::SharedBuffer* buffer) {
+  buffer->Retain();
+  return SharedBufferRef(buffer, [](audio_waveforms::SharedBuffer* buffer) {
+    buffer->Release();
+  });
+}
+
+// Copies |values| into a new shared buffer whose reference is handed to
+// Dart with the returned address.
+FlValue* new_shared_buffer_value(const std::vector<float>& values) {
+  audio_waveforms::SharedBuffer* buffer =
+      audio_waveforms::SharedBuffer::Create(values.size());
+  if (buffer == nullptr) {
+    return fl_value_new_float32_list(values.data(), values.size());
+  }
+  std::copy(values.begin(), values.end(), buffer->data());
+  buffer->Publish();
+  return fl_value_new_int(reinterpret_cast<intptr_t>(buffer));
+}
+
+gboolean deliver_spectrum_frame(gpointer user_data) {
+  auto* frame = static_cast<SpectrumFrame*>(user_data);
+  auto* spectrums = frame->plugin->spectrums;
+  if (spectrums == nullptr || frame->plugin->channel == nullptr) {
+    return G_SOURCE_REMOVE;
+  }
+  // The stream may have been stopped or replaced in the meantime.
+  auto it = spectrums->find(frame->key);
+  if (it == spectrums->end() || it->second.get() != frame->spectrum) {
+    return G_SOURCE_REMOVE;
+  }
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, kPlayerKey,
+                           fl_value_new_string(frame->key.c_str()));
+  if (frame->version > 0) {
+    fl_value_set_string_take(
+        args, kVersion, fl_value_new_int(static_cast<int64_t>(frame->version)));
+  } else {
+    fl_value_set_string_take(
+        args, kBands,
+        fl_value_new_float32_list(frame->bands.data(), frame->bands.size()));
+  }
+  fl_method_channel_invoke_method(frame->plugin->channel, kOnSpectrumData,
+                                  args, nullptr, nullptr, nullptr);
+  frame->spectrum->FrameDelivered();
+  return G_SOURCE_REMOVE;
+}
+
+void free_spectrum_frame(gpointer user_data) {
+  auto* frame = static_cast<SpectrumFrame*>(user_data);
+  g_object_unref(frame->plugin);
+  delete frame;
+}
+
+// Stopping a stream joins its analysis thread, which is left to a worker.
+void release_spectrum(AudioWaveformsPlugin* self, const std::string& key) {
+  auto it = self->spectrums->find(key);
+  if (it == self->spectrums->end()) return;
+  if (it->second.get() == self->recording_spectrum) {
+    self->recording_spectrum = nullptr;
+  }
+  std::shared_ptr<audio_waveforms::SpectrumStream> spectrum(
+      std::move(it->second));
+  self->spectrums->erase(it);
+  // Moved so the worker holds the last reference.
+  self->workers->Post([spectrum = std::move(spectrum)]() {});
+}
+
+// Makes a spectrum stream which reports its frames to |callback|.
+using SpectrumFactory =
+    std::function<std::unique_ptr<audio_waveforms::SpectrumStream>(
+        audio_waveforms::SpectrumStream::FrameCallback callback)>;
+
+// Runs the stream made by |make| for |key| and returns the result of its
+// start: true, or with |shared| the address of the ring of frames and the
+// number of bands in each of them. |bands| is the band count of the
+// stream's analyzer, which sets the stride of the ring.
+FlValue* run_spectrum(AudioWaveformsPlugin* self, const std::string& key,
+                      size_t bands, size_t memory, bool shared,
+                      const SpectrumFactory& make) {
+  // Analysis is live and can't wait, so it goes over budget if it has to.
+  // The lease is held by the callback and released with the stream.
+  const size_t ring_bytes =
+      shared ? kSpectrumRingFrames * bands * sizeof(float) : 0;
+  std::shared_ptr<audio_waveforms::ResourceGovernor::Lease> lease =
+      self->governor->Acquire(audio_waveforms::ResourceKind::kSpectrum,
+                              memory + ring_bytes, memory + ring_bytes, true);
+
+  // Frames are written to the ring on the analysis thread and only their
+  // version is sent. Dart owns the reference the ring is created with.
+  audio_waveforms::SharedBuffer* ring =
+      shared ? audio_waveforms::SharedBuffer::Create(kSpectrumRingFrames * bands)
+             : nullptr;
+  SharedBufferRef ring_ref =
+      ring != nullptr ? retain_shared_buffer(ring) : nullptr;
+
+  // The callback can't refer to the stream before it is constructed, so
+  // the frame is tagged with it through this slot.
+  auto slot = std::make_shared<audio_waveforms::SpectrumStream*>(nullptr);
+  std::unique_ptr<audio_waveforms::SpectrumStream> spectrum =
+      make([self, key, slot, ring_ref, bands,
+            lease](std::vector<float> values) {
+        uint64_t version = 0;
+        if (ring_ref != nullptr) {
+          const size_t frame_index = ring_ref->version() % kSpectrumRingFrames;
+          std::copy_n(values.begin(), std::min(values.size(), bands),
+                      ring_ref->data() + frame_index * bands);
+          ring_ref->Publish();
+          version = ring_ref->version();
+          values.clear();
+        }
+        auto* frame = new SpectrumFrame{
+            AUDIO_WAVEFORMS_PLUGIN(g_object_ref(self)), key, *slot,
+            std::move(values), version};
+        g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT,
+                                   deliver_spectrum_frame, frame,
+                                   free_spectrum_frame);
+      });
+  *slot = spectrum.get();
+  (*self->spectrums)[key] = std::move(spectrum);
+  if (ring == nullptr) return fl_value_new_bool(true);
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(
+      result, kSharedBuffer,
+      fl_value_new_int(reinterpret_cast<intptr_t>(ring)));
+  fl_value_set_string_take(result, kBands,
+                           fl_value_new_int(static_cast<int64_t>(bands)));
+  return result;
+}
+
+// A file opened by a worker for a spectrum stream. |reader| is null if it
+// couldn't be opened or the start was cancelled.
+struct SpectrumStart {
+  AudioWaveformsPlugin* plugin;
+  std::string key;
+  std::shared_ptr<AsyncJob> job;
+  FlMethodCall* method_call;
+  std::unique_ptr<audio_waveforms::WavReader> reader;
+  size_t fft_size;
+  size_t bands;
+  bool shared;
+};
+
+gboolean deliver_spectrum_start(gpointer user_data) {
+  auto* start = static_cast<SpectrumStart*>(user_data);
+  AudioWaveformsPlugin* self = start->plugin;
+  // The start may have been stopped or replaced in the meantime.
+  const bool is_current =
+      is_current_job(self->spectrum_starts, start->key, start->job.get());
+  if (is_current) self->spectrum_starts->erase(start->key);
+  if (!is_current || start->reader == nullptr ||
+      self->spectrums == nullptr) {
+    fl_method_call_respond_success(start->method_call,
+                                   fl_value_new_bool(false), nullptr);
+    return G_SOURCE_REMOVE;
+  }
+
+  // The analyzer has fewer bands than requested when the FFT is too short
+  // to fill them, which sets the stride of the ring.
+  const size_t bands = audio_waveforms::SpectrumAnalyzer::BandCount(
+      start->fft_size, start->bands, start->reader->format().sample_rate);
+
+  const size_t memory = audio_waveforms::PlaybackSpectrum::EstimateMemory(
+      start->fft_size, bands, start->reader->format().channels);
+  g_autoptr(FlValue) result = run_spectrum(
+      self, start->key, bands, memory, start->shared,
+      [start, bands](audio_waveforms::SpectrumStream::FrameCallback callback) {
+        return std::make_unique<audio_waveforms::PlaybackSpectrum>(
+            std::move(start->reader), start->fft_size, bands,
+            std::move(callback));
+      });
+  fl_method_call_respond_success(start->method_call, result, nullptr);
+  return G_SOURCE_REMOVE;
+}
+
+void free_spectrum_start(gpointer user_data) {
+  auto* start = static_cast<SpectrumStart*>(user_data);
+  g_object_unref(start->plugin);
+  g_object_unref(start->method_call);
+  delete start;
+}
+
+bool is_valid_spectrum(int64_t bands, int64_t fft_size) {
+  return bands > 0 &&
+         audio_waveforms::SpectrumAnalyzer::IsValidFftSize(fft_size);
+}
+
+FlMethodResponse* invalid_spectrum_response() {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      "INVALID_ARGUMENTS",
+      "bands must be positive and fftSize a power of two between 64 and "
+      "32768.",
+      nullptr));
+}
+
+// Opens the file on a worker and responds once the stream runs, so returns
+// no response unless the arguments are invalid. With sharedBuffers, the
+// response instead of true holds the address of the ring of frames and the
+// number of bands in each of them.
+FlMethodResponse* start_spectrum_analysis(AudioWaveformsPlugin* self,
+                                          FlMethodCall* method_call,
+                                          FlValue* args) {
+  const gchar* key = lookup_string(args, kPlayerKey);
+  const gchar* path = lookup_string(args, kPath);
+  if (key == nullptr) return missing_argument_response(kPlayerKey);
+  if (path == nullptr) return missing_argument_response(kPath);
+  const int64_t bands = lookup_int(args, kBands, 32);
+  const int64_t fft_size = lookup_int(args, kFftSize, 2048);
+  if (!is_valid_spectrum(bands, fft_size)) {
+    return invalid_spectrum_response();
+  }
+
+  cancel_job(self->spectrum_starts, key);
+  release_spectrum(self, key);
+  auto job = std::make_shared<AsyncJob>();
+  (*self->spectrum_starts)[key] = job;
+  auto* start = new SpectrumStart{
+      AUDIO_WAVEFORMS_PLUGIN(g_object_ref(self)),
+      key,
+      job,
+      FL_METHOD_CALL(g_object_ref(method_call)),
+      nullptr,
+      static_cast<size_t>(fft_size),
+      static_cast<size_t>(bands),
+      lookup_bool(args, kSharedBuffers, false)};
+  std::string file(path);
+  self->workers->Post([start, file]() {
+    auto reader = std::make_unique<audio_waveforms::WavReader>();
+    // Only PCM WAV files can be decoded natively.
+    if (!start->job->cancelled && reader->Open(file)) {
+      start->reader = std::move(reader);
+    }
+    g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT,
+                               deliver_spectrum_start, start,
+                               free_spectrum_start);
+  });
+  return nullptr;
+}
+
+// Starts the stream of playerKey on the audio of the running recording,
+// which is fed to it as it is queued to the writer. Replaces the stream of
+// a previous recording. Responds like startSpectrumAnalysis.
+FlMethodResponse* start_recording_spectrum(AudioWaveformsPlugin* self,
+                                           FlValue* args) {
+  const gchar* key = lookup_string(args, kPlayerKey);
+  if (key == nullptr) return missing_argument_response(kPlayerKey);
+  const int64_t bands = lookup_int(args, kBands, 32);
+  const int64_t fft_size = lookup_int(args, kFftSize, 2048);
+  if (!is_valid_spectrum(bands, fft_size)) {
+    return invalid_spectrum_response();
+  }
+  const auto sample_rate = static_cast<uint32_t>(
+      std::max<int64_t>(1, lookup_int(args, kSampleRate, 44100)));
+  const auto channels = static_cast<uint16_t>(
+      std::clamp<int64_t>(lookup_int(args, kChannels, 1), 1, 8));
+
+  cancel_job(self->spectrum_starts, key);
+  release_spectrum(self, key);
+  std::string previous;
+  for (const auto& entry : *self->spectrums) {
+    if (entry.second.get() == self->recording_spectrum) previous = entry.first;
+  }
+  if (!previous.empty()) release_spectrum(self, previous);
+  const size_t band_count = audio_waveforms::SpectrumAnalyzer::BandCount(
+      fft_size, bands, sample_rate);
+  audio_waveforms::RecordingSpectrum* stream = nullptr;
+  g_autoptr(FlValue) result = run_spectrum(
+      self, key, band_count,
+      audio_waveforms::RecordingSpectrum::EstimateMemory(fft_size, band_count,
+                                                         sample_rate),
+      lookup_bool(args, kSharedBuffers, false),
+      [&](audio_waveforms::SpectrumStream::FrameCallback callback) {
+        auto spectrum = std::make_unique<audio_waveforms::RecordingSpectrum>(
+            sample_rate, channels, fft_size, band_count, std::move(callback));
+        stream = spectrum.get();
+        return spectrum;
+      });
+  self->recording_spectrum = stream;
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+FlMethodResponse* update_spectrum_clock(AudioWaveformsPlugin* self,
+                                        FlValue* args) {
+  const gchar* key = lookup_string(args, kPlayerKey);
+  if (key == nullptr) return missing_argument_response(kPlayerKey);
+  auto it = self->spectrums->find(key);
+  if (it != self->spectrums->end()) {
+    it->second->UpdateClock(lookup_int(args, kProgress, 0),
+                            lookup_double(args, kRate, 1.0),
+                            lookup_bool(args, kIsPlaying, false));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(
+      fl_value_new_bool(it != self->spectrums->end())));
+}
+
+FlMethodResponse* stop_spectrum_analysis(AudioWaveformsPlugin* self,
+                                         FlValue* args) {
+  const gchar* key = lookup_string(args, kPlayerKey);
+  if (key == nullptr) return missing_argument_response(kPlayerKey);
+  cancel_job(self->spectrum_starts, key);
+  release_spectrum(self, key);
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+// Progress or completion of an extraction travelling from its worker to the
+// main thread. |method_call| is only set for the completion, which responds
+// to it with |args|.
+struct ExtractionUpdate {
+  AudioWaveformsPlugin* plugin;
+  std::string key;
+  const AsyncJob* job;
+  FlMethodCall* method_call;
+  FlValue* args;
+};
+
+gboolean deliver_extraction_update(gpointer user_data) {
+  auto* update = static_cast<ExtractionUpdate*>(user_data);
+  auto* extractions = update->plugin->extractions;
+  // The extraction may have been stopped or replaced in the meantime.
+  const bool is_current =
+      is_current_job(extractions, update->key, update->job);
+  if (update->method_call != nullptr) {
+    fl_method_call_respond_success(update->method_call, update->args,
+                                   nullptr);
+    if (is_current) extractions->erase(update->key);
+  } else if (is_current && update->plugin->channel != nullptr) {
+    fl_method_channel_invoke_method(update->plugin->channel,
+                                    kOnCurrentExtractedWaveformData,
+                                    update->args, nullptr, nullptr, nullptr);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+void free_extraction_update(gpointer user_data) {
+  auto* update = static_cast<ExtractionUpdate*>(user_data);
+  g_object_unref(update->plugin);
+  if (update->method_call != nullptr) g_object_unref(update->method_call);
+  fl_value_unref(update->args);
+  delete update;
+}
+
+void post_extraction_update(AudioWaveformsPlugin* self, const std::string& key,
+                            const AsyncJob* job, FlMethodCall* method_call,
+                            FlValue* args) {
+  auto* update = new ExtractionUpdate{
+      AUDIO_WAVEFORMS_PLUGIN(g_object_ref(self)), key, job, method_call,
+      args};
+  g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT,
+                             deliver_extraction_update, update,
+                             free_extraction_update);
+}
+
+// Waveforms are handed over in shared buffers if Dart asked for them.
+FlValue* new_waveform_value(const std::vector<float>& waveform, bool shared) {
+  if (shared) return new_shared_buffer_value(waveform);
+  return fl_value_new_float32_list(waveform.data(), waveform.size());
+}
+
+// Encodes segments as a flat list of (start ms, end ms, silent) triples.
+FlValue* new_segments_value(
+    const std::vector<audio_waveforms::AudioSegment>& segments) {
+  std::vector<int64_t> values;
+  values.reserve(segments.size() * 3);
+  for (const auto& segment : segments) {
+    values.push_back(segment.start_ms);
+    values.push_back(segment.end_ms);
+    values.push_back(segment.silent ? 1 : 0);
+  }
+  return fl_value_new_int64_list(values.data(), values.size());
+}
+
+FlValue* new_loudness_value(const audio_waveforms::LoudnessResult& loudness) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, kIntegratedLoudness,
+                           fl_value_new_float(loudness.integrated_lufs));
+  fl_value_set_string_take(value, kLoudnessRange,
+                           fl_value_new_float(loudness.loudness_range_lu));
+  fl_value_set_string_take(value, kSamplePeak,
+                           fl_value_new_float(loudness.sample_peak_dbfs));
+  fl_value_set_string_take(value, kTruePeak,
+                           fl_value_new_float(loudness.true_peak_dbtp));
+  return value;
+}
+
+void run_extraction(AudioWaveformsPlugin* self, std::string key,
+                    std::string path,
+                    audio_waveforms::ExtractionOptions options,
+                    bool shared, const AsyncJob* job,
+                    FlMethodCall* method_call) {
+  audio_waveforms::WavReader reader;
+  if (!reader.Open(path)) {
+    // Not decodable natively, Dart falls back to its own extractor.
+    post_extraction_update(self, key, job, method_call, fl_value_new_null());
+    return;
+  }
+  audio_waveforms::WaveformExtractor extractor(options);
+  audio_waveforms::ExtractionResult result;
+  const bool completed = extractor.Extract(
+      &reader, job->cancelled,
+      [&](const std::vector<float>& waveform, float progress, int level) {
+        FlValue* args = fl_value_new_map();
+        fl_value_set_string_take(args, kPlayerKey,
+                                 fl_value_new_string(key.c_str()));
+        fl_value_set_string_take(args, kWaveformData,
+                                 new_waveform_value(waveform, false));
+        fl_value_set_string_take(args, kProgress,
+                                 fl_value_new_float(progress));
+        if (level >= 0) {
+          fl_value_set_string_take(args, kResolutionLevel,
+                                   fl_value_new_int(level));
+        }
+        post_extraction_update(self, key, job, nullptr, args);
+      },
+      &result);
+
+  FlValue* response = fl_value_new_map();
+  if (!completed) {
+    fl_value_set_string_take(response, kCancelled, fl_value_new_bool(true));
+  } else {
+    fl_value_set_string_take(response, kWaveformData,
+                             new_waveform_value(result.waveform, shared));
+    if (!result.channel_waveforms.empty()) {
+      FlValue* channels = fl_value_new_list();
+      for (const auto& waveform : result.channel_waveforms) {
+        fl_value_append_take(channels, new_waveform_value(waveform, shared));
+      }
+      fl_value_set_string_take(response, kChannelWaveforms, channels);
+    }
+    if (options.detect_silence) {
+      fl_value_set_string_take(response, kSegments,
+                               new_segments_value(result.segments));
+    }
+    if (result.has_loudness) {
+      fl_value_set_string_take(response, kLoudness,
+                               new_loudness_value(result.loudness));
+    }
+  }
+  post_extraction_update(self, key, job, method_call, response);
+}
+
+// Responds later from a worker, so returns no response. Extractions wait
+// for their memory and a thread in the governor before they are posted.
+FlMethodResponse* extract_waveform_data(AudioWaveformsPlugin* self,
+                                        FlMethodCall* method_call,
+                                        FlValue* args) {
+  const gchar* key = lookup_string(args, kPlayerKey);
+  const gchar* path = lookup_string(args, kPath);
+  if (key == nullptr) return missing_argument_response(kPlayerKey);
+  if (path == nullptr) return missing_argument_response(kPath);
+  audio_waveforms::ExtractionOptions options;
+  options.sample_count = static_cast<size_t>(
+      std::max<int64_t>(1, lookup_int(args, kNoOfSamples, 100)));
+  FlValue* threshold =
+      lookup_value(args, kSilenceThreshold, FL_VALUE_TYPE_FLOAT);
+  if (threshold != nullptr) {
+    options.detect_silence = true;
+    options.silence_threshold_db =
+        static_cast<float>(fl_value_get_float(threshold));
+    options.min_silence_ms = lookup_int(args, kSilenceMinDuration, 300);
+  }
+  options.measure_loudness = lookup_bool(args, kMeasureLoudness, false);
+  options.progressive = lookup_bool(args, kProgressive, false);
+  switch (lookup_int(args, kChannelMode, 0)) {
+    case 1:
+      options.channel_mode = audio_waveforms::ChannelMode::kPerChannel;
+      break;
+    case 2:
+      options.channel_mode = audio_waveforms::ChannelMode::kMidSide;
+      break;
+    default:
+      options.channel_mode = audio_waveforms::ChannelMode::kMixed;
+  }
+
+  const bool shared = lookup_bool(args, kSharedBuffers, false);
+
+  cancel_job(self->extractions, key);
+  auto job = std::make_shared<AsyncJob>();
+  (*self->extractions)[key] = job;
+  FlMethodCall* call = FL_METHOD_CALL(g_object_ref(method_call));
+  std::string player_key(key);
+  std::string file(path);
+  self->governor->Enqueue(
+      audio_waveforms::ResourceKind::kExtraction,
+      audio_waveforms::WaveformExtractor::EstimateMemory(options),
+      [self, player_key, file, options, shared, job,
+       call](audio_waveforms::ResourceGovernor::LeasePtr lease) {
+        // Released once the task is done with, after the response was
+        // posted.
+        std::shared_ptr<audio_waveforms::ResourceGovernor::Lease> held(
+            std::move(lease));
+        self->workers->Post(
+            [self, player_key, file, options, shared, job, call, held]() {
+              run_extraction(self, player_key, file, options, shared,
+                             job.get(), call);
+            });
+      });
+  return nullptr;
+}
+
+// A result computed by a worker for |method_call|.
+struct MethodResult {
+  AudioWaveformsPlugin* plugin;
+  FlMethodCall* method_call;
+  FlValue* value;
+};
+
+gboolean deliver_method_result(gpointer user_data) {
+  auto* result = static_cast<MethodResult*>(user_data);
+  fl_method_call_respond_success(result->method_call, result->value, nullptr);
+  return G_SOURCE_REMOVE;
+}
+
+void free_method_result(gpointer user_data) {
+  auto* result = static_cast<MethodResult*>(user_data);
+  g_object_unref(result->plugin);
+  g_object_unref(result->method_call);
+  fl_value_unref(result->value);
+  delete result;
+}
+
+// Responds to |method_call| with |value| on the main thread.
+void post_method_result(AudioWaveformsPlugin* self, FlMethodCall* method_call,
+                        FlValue* value) {
+  auto* result = new MethodResult{AUDIO_WAVEFORMS_PLUGIN(g_object_ref(self)),
+                                  method_call, value};
+  g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT,
+                             deliver_method_result, result,
+                             free_method_result);
+}
+
+FlValue* new_media_info_value(const std::string& path, bool exact_duration) {
+  audio_waveforms::MediaInfo info;
+  if (!audio_waveforms::ProbeMedia(path, &info, exact_duration)) {
+    return fl_value_new_null();
+  }
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, kCodec,
+                           fl_value_new_string(info.codec.c_str()));
+  fl_value_set_string_take(value, kDuration,
+                           info.duration_ms >= 0
+                               ? fl_value_new_int(info.duration_ms)
+                               : fl_value_new_null());
+  fl_value_set_string_take(value, kSampleRate,
+                           fl_value_new_int(info.sample_rate));
+  fl_value_set_string_take(value, kChannels, fl_value_new_int(info.channels));
+  return value;
+}
+
+// Reads the headers of every file in the paths list on a worker and
+// responds with a list of the same length, holding null for files which
+// couldn't be probed. Returns no response unless the arguments are invalid.
+// With exactDuration, the frames of MP3 and ADTS files are walked for their
+// exact duration.
+FlMethodResponse* probe_media(AudioWaveformsPlugin* self,
+                              FlMethodCall* method_call, FlValue* args) {
+  FlValue* list = lookup_value(args, kPaths, FL_VALUE_TYPE_LIST);
+  if (list == nullptr) return missing_argument_response(kPaths);
+  std::vector<std::string> paths;
+  for (size_t i = 0; i < fl_value_get_length(list); ++i) {
+    FlValue* path = fl_value_get_list_value(list, i);
+    paths.push_back(fl_value_get_type(path) == FL_VALUE_TYPE_STRING
+                        ? fl_value_get_string(path)
+                        : "");
+  }
+  const bool exact_duration = lookup_bool(args, kExactDuration, false);
+  FlMethodCall* call = FL_METHOD_CALL(g_object_ref(method_call));
+  self->workers->Post([self, call, paths, exact_duration]() {
+    FlValue* results = fl_value_new_list();
+    for (const auto& path : paths) {
+      fl_value_append_take(results, new_media_info_value(path, exact_duration));
+    }
+    post_method_result(self, call, results);
+  });
+  return nullptr;
+}
+
+// Closes |writer| on a worker, as draining it may wait on the disk.
+void close_recording_writer(
+    AudioWaveformsPlugin* self,
+    std::shared_ptr<audio_waveforms::RecordingWriter> writer) {
+  if (writer == nullptr) return;
+  self->workers->Post([writer]() { writer->Close(); });
+}
+
+// Creates the file on a worker and responds once the writer accepts audio,
+// replacing the writer of a previous recording. Returns no response unless
+// the arguments are invalid.
+FlMethodResponse* start_recording_writer(AudioWaveformsPlugin* self,
+                                         FlMethodCall* method_call,
+                                         FlValue* args) {
+  const gchar* path = lookup_string(args, kPath);
+  if (path == nullptr) return missing_argument_response(kPath);
+  audio_waveforms::PcmFormat format;
+  format.sample_rate = static_cast<uint32_t>(std::max<int64_t>(
+      1, lookup_int(args, kSampleRate, format.sample_rate)));
+  format.channels = static_cast<uint16_t>(
+      std::clamp<int64_t>(lookup_int(args, kChannels, 1), 1, 8));
+  format.bits_per_sample = static_cast<uint16_t>(
+      lookup_int(args, kLinearPcmBitDepth, format.bits_per_sample));
+  format.is_float = lookup_bool(args, kLinearPcmIsFloat, false);
+  audio_waveforms::FlushPolicy policy;
+  policy.buffer_bytes = static_cast<size_t>(std::max<int64_t>(
+      1, lookup_int(args, kBufferSize,
+                    static_cast<int64_t>(policy.buffer_bytes))));
+  policy.flush_interval_ms = std::max<int64_t>(
+      0, lookup_int(args, kFlushInterval, policy.flush_interval_ms));
+  policy.sync_interval_ms = std::max<int64_t>(
+      0, lookup_int(args, kSyncInterval, policy.sync_interval_ms));
+  int64_t queue_ms =
+      std::max<int64_t>(100, lookup_int(args, kQueueDuration, 10000));
+
+  close_recording_writer(self, std::move(*self->recording_writer));
+  // Recording can't wait, so over budget the queue shrinks towards its
+  // minimum of 100 ms instead. Memory grows linearly with the duration.
+  const size_t wanted = audio_waveforms::RecordingWriter::EstimateMemory(
+      format, policy, queue_ms);
+  const size_t least =
+      audio_waveforms::RecordingWriter::EstimateMemory(format, policy, 100);
+  std::shared_ptr<audio_waveforms::ResourceGovernor::Lease> lease =
+      self->governor->Acquire(audio_waveforms::ResourceKind::kRecording,
+                              least, wanted, true);
+  if (wanted > least) {
+    queue_ms = 100 + static_cast<int64_t>(
+                         static_cast<double>(lease->bytes() - least) /
+                         (wanted - least) * (queue_ms - 100));
+  }
+  // The lease is released together with the writer.
+  std::shared_ptr<audio_waveforms::RecordingWriter> writer(
+      new audio_waveforms::RecordingWriter(),
+      [lease](audio_waveforms::RecordingWriter* writer) { delete writer; });
+  *self->recording_writer = writer;
+  FlMethodCall* call = FL_METHOD_CALL(g_object_ref(method_call));
+  std::string file(path);
+  self->workers->Post([self, call, writer, file, format, policy, queue_ms]() {
+    const bool opened = writer->Open(file, format, policy, queue_ms);
+    post_method_result(self, call, fl_value_new_bool(opened));
+  });
+  return nullptr;
+}
+
+// Queues a block of 16-bit PCM. Never waits for the disk, blocks which
+// don't fit into the queue are dropped and counted. The spectrum of the
+// recording sees every block.
+FlMethodResponse* write_recording_data(AudioWaveformsPlugin* self,
+                                       FlValue* args) {
+  FlValue* data = lookup_value(args, kData, FL_VALUE_TYPE_UINT8_LIST);
+  if (data == nullptr) return missing_argument_response(kData);
+  if (self->recording_spectrum != nullptr) {
+    self->recording_spectrum->PushPcm16(fl_value_get_uint8_list(data),
+                                        fl_value_get_length(data));
+  }
+  const auto& writer = *self->recording_writer;
+  const bool queued =
+      writer != nullptr &&
+      writer->PushPcm16(fl_value_get_uint8_list(data),
+                        fl_value_get_length(data));
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(queued)));
+}
+
+FlValue* new_writer_stats_value(
+    const audio_waveforms::WriterStats& stats,
+    const audio_waveforms::PcmFormat& format,
+    const audio_waveforms::RecordingWaveform& waveform) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(
+      value, kDuration,
+      fl_value_new_int(static_cast<int64_t>(stats.frames_written * 1000 /
+                                            format.sample_rate)));
+  fl_value_set_string_take(
+      value, kFramesWritten,
+      fl_value_new_int(static_cast<int64_t>(stats.frames_written)));
+  fl_value_set_string_take(
+      value, kDroppedBlocks,
+      fl_value_new_int(static_cast<int64_t>(stats.dropped_blocks)));
+  fl_value_set_string_take(
+      value, kDroppedFrames,
+      fl_value_new_int(static_cast<int64_t>(stats.dropped_frames)));
+  fl_value_set_string_take(
+      value, kBackpressureEvents,
+      fl_value_new_int(static_cast<int64_t>(stats.backpressure_events)));
+  fl_value_set_string_take(
+      value, kQueueCapacity,
+      fl_value_new_int(static_cast<int64_t>(stats.queue_capacity_frames)));
+  fl_value_set_string_take(
+      value, kPeakQueued,
+      fl_value_new_int(static_cast<int64_t>(stats.peak_queued_frames)));
+  fl_value_set_string_take(value, kLongestWrite,
+                           fl_value_new_int(stats.longest_write_ms));
+  fl_value_set_string_take(value, kIoError,
+                           fl_value_new_bool(stats.io_error));
+  fl_value_set_string_take(
+      value, kWaveformData,
+      fl_value_new_float32_list(waveform.rms.data(), waveform.rms.size()));
+  fl_value_set_string_take(
+      value, kWaveformPeaks,
+      fl_value_new_float32_list(waveform.peaks.data(), waveform.peaks.size()));
+  return value;
+}
+
+// Drains and closes the writer on a worker and responds with its
+// statistics and the waveform of the file, or null if no recording is
+// written.
+FlMethodResponse* stop_recording_writer(AudioWaveformsPlugin* self,
+                                        FlMethodCall* method_call) {
+  std::shared_ptr<audio_waveforms::RecordingWriter> writer =
+      std::move(*self->recording_writer);
+  if (writer == nullptr) {
+    return FL_METHOD_RESPONSE(
+        fl_method_success_response_new(fl_value_new_null()));
+  }
+  FlMethodCall* call = FL_METHOD_CALL(g_object_ref(method_call));
+  self->workers->Post([self, call, writer]() {
+    writer->Close();
+    post_method_result(
+        self, call,
+        new_writer_stats_value(writer->Stats(), writer->format(),
+                               writer->Waveform()));
+  });
+  return nullptr;
+}
+
+// Asks Dart to close idle players when a reservation didn't fit into the
+// budget. Called on the main thread, where everything reserves.
+void notify_resource_pressure(AudioWaveformsPlugin* self,
+                              size_t missing_bytes) {
+  if (self->channel == nullptr) return;
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(
+      args, kPlayers,
+      fl_value_new_int(static_cast<int64_t>(
+          (missing_bytes + kPlayerMemoryBytes - 1) / kPlayerMemoryBytes)));
+  fl_method_channel_invoke_method(self->channel, kOnResourcePressure, args,
+                                  nullptr, nullptr, nullptr);
+}
+
+FlMethodResponse* set_resource_budget(AudioWaveformsPlugin* self,
+                                      FlValue* args) {
+  audio_waveforms::ResourceBudget budget = self->governor->Usage().budget;
+  budget.memory_bytes = static_cast<size_t>(std::max<int64_t>(
+      1, lookup_int(args, kMemory,
+                    static_cast<int64_t>(budget.memory_bytes))));
+  budget.threads = static_cast<size_t>(std::max<int64_t>(
+      1, lookup_int(args, kThreads, static_cast<int64_t>(budget.threads))));
+  self->governor->SetBudget(budget);
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+FlMethodResponse* get_resource_usage(AudioWaveformsPlugin* self) {
+  const audio_waveforms::ResourceUsage usage = self->governor->Usage();
+  auto leases = [&usage](audio_waveforms::ResourceKind kind) {
+    return fl_value_new_int(
+        static_cast<int64_t>(usage.leases[static_cast<size_t>(kind)]));
+  };
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(
+      value, kMemory,
+      fl_value_new_int(static_cast<int64_t>(usage.memory_bytes)));
+  fl_value_set_string_take(
+      value, kThreads, fl_value_new_int(static_cast<int64_t>(usage.threads)));
+  fl_value_set_string_take(
+      value, kMemoryBudget,
+      fl_value_new_int(static_cast<int64_t>(usage.budget.memory_bytes)));
+  fl_value_set_string_take(
+      value, kThreadBudget,
+      fl_value_new_int(static_cast<int64_t>(usage.budget.threads)));
+  fl_value_set_string_take(
+      value, kQueuedJobs,
+      fl_value_new_int(static_cast<int64_t>(usage.queued_jobs)));
+  fl_value_set_string_take(value, kRunningExtractions,
+                           leases(audio_waveforms::ResourceKind::kExtraction));
+  fl_value_set_string_take(value, kResidentPlayers,
+                           leases(audio_waveforms::ResourceKind::kPlayer));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(value));
+}
+
+// Reserves the estimate of a player Dart opens for playerKey, replacing a
+// previous reservation of the key.
+FlMethodResponse* acquire_player_resources(AudioWaveformsPlugin* self,
+                                           FlValue* args) {
+  const gchar* key = lookup_string(args, kPlayerKey);
+  if (key == nullptr) return missing_argument_response(kPlayerKey);
+  self->player_leases->erase(key);
+  (*self->player_leases)[key] =
+      self->governor->Acquire(audio_waveforms::ResourceKind::kPlayer,
+                              kPlayerMemoryBytes, kPlayerMemoryBytes, false);
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+FlMethodResponse* release_player_resources(AudioWaveformsPlugin* self,
+                                           FlValue* args) {
+  const gchar* key = lookup_string(args, kPlayerKey);
+  if (key == nullptr) return missing_argument_response(kPlayerKey);
+  self->player_leases->erase(key);
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+}  // namespace
+
 // Called when a method call is received from Flutter.
 static void audio_waveforms_plugin_handle_method_call(
     AudioWaveformsPlugin* self,
     FlMethodCall* method_call) {
   g_autoptr(FlMethodResponse) response = nullptr;
   const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
 
   if (strcmp(method, "checkPermission") == 0) {
     // Linux does not require microphone permission by default.
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_bool(true)));
+  } else if (strcmp(method, "startSpectrumAnalysis") == 0) {
+    response = start_spectrum_analysis(self, method_call, args);
+  } else if (strcmp(method, "startRecordingSpectrum") == 0) {
+    response = start_recording_spectrum(self, args);
+  } else if (strcmp(method, "updateSpectrumClock") == 0) {
+    response = update_spectrum_clock(self, args);
+  } else if (strcmp(method, "stopSpectrumAnalysis") == 0) {
+    response = stop_spectrum_analysis(self, args);
+  } else if (strcmp(method, "probeMedia") == 0) {
+    response = probe_media(self, method_call, args);
+  } else if (strcmp(method, "startRecordingWriter") == 0) {
+    response = start_recording_writer(self, method_call, args);
+  } else if (strcmp(method, "writeRecordingData") == 0) {
+    response = write_recording_data(self, args);
+  } else if (strcmp(method, "stopRecordingWriter") == 0) {
+    response = stop_recording_writer(self, method_call);
+  } else if (strcmp(method, "extractWaveformData") == 0) {
+    response = extract_waveform_data(self, method_call, args);
+  } else if (strcmp(method, "setResourceBudget") == 0) {
+    response = set_resource_budget(self, args);
+  } else if (strcmp(method, "getResourceUsage") == 0) {
+    response = get_resource_usage(self);
+  } else if (strcmp(method, "acquirePlayerResources") == 0) {
+    response = acquire_player_resources(self, args);
+  } else if (strcmp(method, "releasePlayerResources") == 0) {
+    response = release_player_resources(self, args);
+  } else if (strcmp(method, "stopExtraction") == 0) {
+    const gchar* key = lookup_string(args, kPlayerKey);
+    if (key != nullptr) cancel_job(self->extractions, key);
+    response = FL_METHOD_RESPONSE(
+        fl_method_success_response_new(fl_value_new_bool(true)));
   } else {
     gchar* details = g_strdup_printf(
         "Method '%s' is not implemented for desktop. Try using RecorderController or PlayerController from the audio_waveforms package instead.",
@@ -30,10 +1067,44 @@ static void audio_waveforms_plugin_handle_method_call(
         fl_value_new_string(method)));
     g_free(details);
   }
-  fl_method_call_respond(method_call, response, nullptr);
+  // Calls which complete asynchronously respond on their own.
+  if (response != nullptr) {
+    fl_method_call_respond(method_call, response, nullptr);
+  }
 }
 
 static void audio_waveforms_plugin_dispose(GObject* object) {
+  AudioWaveformsPlugin* self = AUDIO_WAVEFORMS_PLUGIN(object);
+  for (AsyncJobMap* jobs : {self->spectrum_starts, self->extractions}) {
+    if (jobs == nullptr) continue;
+    for (auto& entry : *jobs) entry.second->cancelled = true;
+  }
+  // Joins the analysis and worker threads before the channel goes away.
+  // Cancelled work still responds, after the maps are gone.
+  self->recording_spectrum = nullptr;
+  delete self->spectrums;
+  self->spectrums = nullptr;
+  // Extractions still waiting for resources respond as cancelled.
+  if (self->governor != nullptr) self->governor->AdmitAll();
+  delete self->workers;
+  self->workers = nullptr;
+  // Finishes the file of a recording which was never stopped.
+  delete self->recording_writer;
+  self->recording_writer = nullptr;
+  // Every lease is gone once the players are forgotten.
+  delete self->player_leases;
+  self->player_leases = nullptr;
+  delete self->governor;
+  self->governor = nullptr;
+  delete self->spectrum_starts;
+  self->spectrum_starts = nullptr;
+  delete self->extractions;
+  self->extractions = nullptr;
+  if (self->channel != nullptr) {
+    g_object_remove_weak_pointer(G_OBJECT(self->channel),
+                                 reinterpret_cast<gpointer*>(&self->channel));
+    self->channel = nullptr;
+  }
   G_OBJECT_CLASS(audio_waveforms_plugin_parent_class)->dispose(object);
 }
 
@@ -41,7 +1112,22 @@ static void audio_waveforms_plugin_class_init(AudioWaveformsPluginClass* klass)
   G_OBJECT_CLASS(klass)->dispose = audio_waveforms_plugin_dispose;
 }
 
-static void audio_waveforms_plugin_init(AudioWaveformsPlugin* self) {}
+static void audio_waveforms_plugin_init(AudioWaveformsPlugin* self) {
+  self->spectrums = new std::map<
+      std::string, std::unique_ptr<audio_waveforms::SpectrumStream>>();
+  self->recording_spectrum = nullptr;
+  self->spectrum_starts = new AsyncJobMap();
+  self->extractions = new AsyncJobMap();
+  self->recording_writer =
+      new std::shared_ptr<audio_waveforms::RecordingWriter>();
+  self->workers = new audio_waveforms::WorkerPool();
+  self->player_leases = new LeaseMap();
+  self->governor = new audio_waveforms::ResourceGovernor();
+  self->governor->SetPressureCallback(
+      [self](size_t missing_bytes) {
+        notify_resource_pressure(self, missing_bytes);
+      });
+}
 
 static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
                            gpointer user_data) {
@@ -58,6 +1144,11 @@ void audio_waveforms_plugin_register_with_registrar(FlPluginRegistrar* registrar
       fl_plugin_registrar_get_messenger(registrar),
       "simform_audio_waveforms_plugin/methods",
       FL_METHOD_CODEC(codec));
+  // A strong reference would be a cycle through the handler, and dispose
+  // would never run.
+  plugin->channel = channel;
+  g_object_add_weak_pointer(G_OBJECT(channel),
+                            reinterpret_cast<gpointer*>(&plugin->channel));
   fl_method_channel_set_method_call_handler(channel, method_call_cb,
                                             g_object_ref(plugin),
                                             g_object_unref);
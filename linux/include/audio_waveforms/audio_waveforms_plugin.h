@@ -15,6 +15,10 @@ G_DECLARE_FINAL_TYPE(AudioWaveformsPlugin, audio_waveforms_plugin, AUDIO_WAVEFOR
 
 FLUTTER_PLUGIN_EXPORT void audio_waveforms_plugin_register_with_registrar(FlPluginRegistrar* registrar);
 
+// Releases a reference to a buffer of floats which Dart reads through
+// dart:ffi. It is the finalizer of the Dart views of the buffer.
+FLUTTER_PLUGIN_EXPORT void audio_waveforms_shared_buffer_release(void* buffer);
+
 G_END_DECLS
 
 #endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_PLUGIN_H_
@@ -0,0 +1,236 @@
+#include "loudness_meter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace audio_waveforms {
+
+namespace {
+
+// Blocks below this are never counted, and below the relative gates of
+// BS.1770-4 (integrated) and Tech 3342 (loudness range).
+constexpr double kAbsoluteGateLufs = -70.0;
+constexpr double kIntegratedRelativeGateLu = -10.0;
+constexpr double kRangeRelativeGateLu = -20.0;
+constexpr double kRangeLowPercentile = 0.10;
+constexpr double kRangeHighPercentile = 0.95;
+
+// Histogram range and resolution. Louder blocks fall into the top bin.
+constexpr double kHistogramMaxLufs = 5.0;
+constexpr double kBinsPerLu = 100.0;
+
+// Gating blocks are 400 ms (momentary) and 3 s (short-term) long and
+// start every 100 ms.
+constexpr size_t kMomentarySubBlocks = 4;
+constexpr size_t kShortTermSubBlocks = 30;
+
+constexpr size_t kTapsPerPhase = 12;
+constexpr double kPi = 3.14159265358979323846;
+
+double EnergyToLufs(double energy) {
+  return -0.691 + 10.0 * std::log10(energy);
+}
+
+double ToDecibels(float amplitude) {
+  if (amplitude <= 0.0f) return -std::numeric_limits<double>::infinity();
+  return 20.0 * std::log10(amplitude);
+}
+
+}  // namespace
+
+LoudnessMeter::Histogram::Histogram()
+    : counts_(static_cast<size_t>((kHistogramMaxLufs - kAbsoluteGateLufs) *
+                                  kBinsPerLu)),
+      energies_(counts_.size()) {}
+
+void LoudnessMeter::Histogram::Add(double energy) {
+  if (energy <= 0.0) return;
+  const double lufs = EnergyToLufs(energy);
+  if (lufs < kAbsoluteGateLufs) return;
+  const size_t bin = std::min(
+      counts_.size() - 1,
+      static_cast<size_t>((lufs - kAbsoluteGateLufs) * kBinsPerLu));
+  ++counts_[bin];
+  energies_[bin] += energy;
+  ++count_;
+}
+
+double LoudnessMeter::Histogram::MeanAbove(double gate_lufs) const {
+  const size_t first = static_cast<size_t>(
+      std::max(0.0, (gate_lufs - kAbsoluteGateLufs) * kBinsPerLu));
+  uint64_t count = 0;
+  double energy = 0.0;
+  for (size_t i = first; i < counts_.size(); ++i) {
+    count += counts_[i];
+    energy += energies_[i];
+  }
+  return count > 0 ? energy / count : 0.0;
+}
+
+double LoudnessMeter::Histogram::Percentile(double gate_lufs,
+                                            double fraction) const {
+  const size_t first = static_cast<size_t>(
+      std::max(0.0, (gate_lufs - kAbsoluteGateLufs) * kBinsPerLu));
+  uint64_t count = 0;
+  for (size_t i = first; i < counts_.size(); ++i) count += counts_[i];
+  if (count == 0) return gate_lufs;
+
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(fraction * count)));
+  uint64_t seen = 0;
+  size_t bin = first;
+  for (; bin < counts_.size(); ++bin) {
+    seen += counts_[bin];
+    if (seen >= rank) break;
+  }
+  return kAbsoluteGateLufs + (bin + 0.5) / kBinsPerLu;
+}
+
+LoudnessMeter::LoudnessMeter(uint32_t sample_rate, uint16_t channels)
+    : channels_(std::max<uint16_t>(1, channels)),
+      sub_block_frames_(std::max<uint32_t>(1, sample_rate / 10)),
+      weights_(channels_, 1.0),
+      state_(channels_ * 4, 0.0),
+      sub_block_energy_(kShortTermSubBlocks, 0.0) {
+  // K-weighting, the two filter stages of BS.1770-4 derived for any sample
+  // rate rather than the tabulated 48 kHz coefficients.
+  const double rate = std::max<uint32_t>(1, sample_rate);
+  {
+    const double f0 = 1681.974450955533;
+    const double gain_db = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    const double k = std::tan(kPi * f0 / rate);
+    const double vh = std::pow(10.0, gain_db / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+    shelf_ = {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0,
+              (vh - vb * k / q + k * k) / a0, 2.0 * (k * k - 1.0) / a0,
+              (1.0 - k / q + k * k) / a0};
+  }
+  {
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    const double k = std::tan(kPi * f0 / rate);
+    const double a0 = 1.0 + k / q + k * k;
+    high_pass_ = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0,
+                  (1.0 - k / q + k * k) / a0};
+  }
+
+  // Surround channels in WAVE order are weighted up, LFE is left out.
+  if (channels_ == 5) {
+    weights_ = {1.0, 1.0, 1.0, 1.41, 1.41};
+  } else if (channels_ == 6) {
+    weights_ = {1.0, 1.0, 1.0, 0.0, 1.41, 1.41};
+  }
+
+  // Inter-sample peaks are found by upsampling to at least 192 kHz with a
+  // windowed-sinc interpolator.
+  oversampling_ = sample_rate < 96000 ? 4 : sample_rate < 192000 ? 2 : 1;
+  taps_per_phase_ = oversampling_ > 1 ? kTapsPerPhase : 0;
+  if (taps_per_phase_ > 0) {
+    const size_t length = taps_per_phase_ * oversampling_;
+    const double center = (length - 1) / 2.0;
+    std::vector<double> prototype(length);
+    for (size_t n = 0; n < length; ++n) {
+      const double x = (n - center) / oversampling_;
+      const double sinc = x == 0.0 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+      const double window =
+          0.5 - 0.5 * std::cos(2.0 * kPi * (n + 1) / (length + 1));
+      prototype[n] = sinc * window;
+    }
+    // Phase p is applied to the history oldest sample first.
+    interpolation_.resize(length);
+    for (size_t p = 0; p < oversampling_; ++p) {
+      for (size_t j = 0; j < taps_per_phase_; ++j) {
+        interpolation_[p * taps_per_phase_ + j] = static_cast<float>(
+            prototype[(taps_per_phase_ - 1 - j) * oversampling_ + p]);
+      }
+    }
+    history_.assign(channels_ * taps_per_phase_ * 2, 0.0f);
+  }
+}
+
+void LoudnessMeter::Process(const float* samples, size_t frames) {
+  for (size_t i = 0; i < frames; ++i, samples += channels_) {
+    for (uint16_t c = 0; c < channels_; ++c) {
+      const double x = samples[c];
+      sample_peak_ = std::max(sample_peak_, std::fabs(samples[c]));
+      if (weights_[c] == 0.0) continue;
+      double* s = &state_[c * 4];
+      const double y1 = shelf_.b0 * x + s[0];
+      s[0] = shelf_.b1 * x - shelf_.a1 * y1 + s[1];
+      s[1] = shelf_.b2 * x - shelf_.a2 * y1;
+      const double y2 = high_pass_.b0 * y1 + s[2];
+      s[2] = high_pass_.b1 * y1 - high_pass_.a1 * y2 + s[3];
+      s[3] = high_pass_.b2 * y1 - high_pass_.a2 * y2;
+      current_energy_ += weights_[c] * y2 * y2;
+    }
+    if (taps_per_phase_ > 0) TrackTruePeak(samples);
+    if (++current_frames_ == sub_block_frames_) EndSubBlock();
+  }
+}
+
+void LoudnessMeter::TrackTruePeak(const float* frame) {
+  const size_t taps = taps_per_phase_;
+  for (uint16_t c = 0; c < channels_; ++c) {
+    // Every sample is written twice so the last |taps| samples are always
+    // contiguous.
+    float* history = &history_[c * taps * 2];
+    history[history_pos_] = frame[c];
+    history[history_pos_ + taps] = frame[c];
+    const float* window = history + history_pos_ + 1;
+    for (size_t p = 0; p < oversampling_; ++p) {
+      const float* coefficients = &interpolation_[p * taps];
+      float sum = 0.0f;
+      for (size_t j = 0; j < taps; ++j) sum += coefficients[j] * window[j];
+      true_peak_ = std::max(true_peak_, std::fabs(sum));
+    }
+  }
+  history_pos_ = (history_pos_ + 1) % taps;
+}
+
+void LoudnessMeter::EndSubBlock() {
+  sub_block_energy_[sub_blocks_ % kShortTermSubBlocks] = current_energy_;
+  ++sub_blocks_;
+  current_energy_ = 0.0;
+  current_frames_ = 0;
+
+  auto block_energy = [&](size_t sub_blocks) {
+    double sum = 0.0;
+    for (size_t i = 1; i <= sub_blocks; ++i) {
+      sum += sub_block_energy_[(sub_blocks_ - i) % kShortTermSubBlocks];
+    }
+    return sum / (sub_blocks * sub_block_frames_);
+  };
+  if (sub_blocks_ >= kMomentarySubBlocks) {
+    momentary_.Add(block_energy(kMomentarySubBlocks));
+  }
+  if (sub_blocks_ >= kShortTermSubBlocks) {
+    short_term_.Add(block_energy(kShortTermSubBlocks));
+  }
+}
+
+LoudnessResult LoudnessMeter::Finish() const {
+  LoudnessResult result;
+  result.integrated_lufs = -std::numeric_limits<double>::infinity();
+  result.loudness_range_lu = 0.0;
+  if (!momentary_.empty()) {
+    const double gate = EnergyToLufs(momentary_.MeanAbove(kAbsoluteGateLufs)) +
+                        kIntegratedRelativeGateLu;
+    result.integrated_lufs = EnergyToLufs(momentary_.MeanAbove(gate));
+  }
+  if (!short_term_.empty()) {
+    const double gate =
+        EnergyToLufs(short_term_.MeanAbove(kAbsoluteGateLufs)) +
+        kRangeRelativeGateLu;
+    result.loudness_range_lu =
+        short_term_.Percentile(gate, kRangeHighPercentile) -
+        short_term_.Percentile(gate, kRangeLowPercentile);
+  }
+  result.sample_peak_dbfs = ToDecibels(sample_peak_);
+  result.true_peak_dbtp = ToDecibels(std::max(true_peak_, sample_peak_));
+  return result;
+}
+
+}  // namespace audio_waveforms
@@ -0,0 +1,87 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_LOUDNESS_METER_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_LOUDNESS_METER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio_waveforms {
+
+struct LoudnessResult {
+  // Gated loudness of the whole input in LUFS, -inf for silence.
+  double integrated_lufs;
+  // Spread of short-term loudness in LU.
+  double loudness_range_lu;
+  double sample_peak_dbfs;
+  double true_peak_dbtp;
+};
+
+// Measures loudness as specified by ITU-R BS.1770-4 and EBU R128/Tech 3342.
+//
+// Gating blocks are accumulated into fixed histograms with 0.01 LU
+// resolution instead of being stored, so memory doesn't grow with the
+// input length.
+class LoudnessMeter {
+ public:
+  LoudnessMeter(uint32_t sample_rate, uint16_t channels);
+
+  // Measures |frames| interleaved frames.
+  void Process(const float* samples, size_t frames);
+
+  LoudnessResult Finish() const;
+
+ private:
+  struct Biquad {
+    double b0, b1, b2, a1, a2;
+  };
+
+  // Energy histogram of gating blocks by loudness.
+  class Histogram {
+   public:
+    Histogram();
+    void Add(double energy);
+    // Mean energy of blocks louder than |gate_lufs|.
+    double MeanAbove(double gate_lufs) const;
+    // Loudness below which |fraction| of the blocks louder than
+    // |gate_lufs| are.
+    double Percentile(double gate_lufs, double fraction) const;
+    bool empty() const { return count_ == 0; }
+
+   private:
+    std::vector<uint64_t> counts_;
+    std::vector<double> energies_;
+    uint64_t count_ = 0;
+  };
+
+  void EndSubBlock();
+  void TrackTruePeak(const float* frame);
+
+  uint16_t channels_;
+  size_t sub_block_frames_;
+  Biquad shelf_;
+  Biquad high_pass_;
+  std::vector<double> weights_;
+  // Filter state, 4 values per channel for the two stages.
+  std::vector<double> state_;
+
+  std::vector<double> sub_block_energy_;
+  double current_energy_ = 0.0;
+  size_t current_frames_ = 0;
+  uint64_t sub_blocks_ = 0;
+
+  Histogram momentary_;
+  Histogram short_term_;
+
+  float sample_peak_ = 0.0f;
+  float true_peak_ = 0.0f;
+  size_t oversampling_;
+  size_t taps_per_phase_;
+  std::vector<float> interpolation_;
+  // Last taps_per_phase_ samples of every channel.
+  std::vector<float> history_;
+  size_t history_pos_ = 0;
+};
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_LOUDNESS_METER_H_
@@ -0,0 +1,683 @@
+#include "media_probe.h"
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace audio_waveforms {
+
+namespace {
+
+// The first MP3 frame is searched for in this much data after the tags.
+constexpr size_t kMp3SyncWindow = 64 * 1024;
+
+// Frames compared before an MP3 without a VBR header is treated as CBR.
+constexpr int kMp3CbrCheckFrames = 32;
+
+// Frames averaged to estimate the duration of an ADTS stream which isn't
+// scanned.
+constexpr int kAdtsEstimateFrames = 64;
+
+// Frame headers are read in chunks of this size while scanning.
+constexpr size_t kScanReadChunk = 256 * 1024;
+
+// Ogg pages are at most 65307 bytes, so the last page starts within this
+// distance from the end.
+constexpr int64_t kOggTailWindow = 65536 + 27 + 255;
+
+uint16_t ReadLe16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadLe32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t ReadLe64(const uint8_t* p) {
+  return static_cast<uint64_t>(ReadLe32(p)) |
+         (static_cast<uint64_t>(ReadLe32(p + 4)) << 32);
+}
+
+uint16_t ReadBe16(const uint8_t* p) {
+  return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t ReadBe32(const uint8_t* p) {
+  return (static_cast<uint32_t>(p[0]) << 24) |
+         (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+uint64_t ReadBe64(const uint8_t* p) {
+  return (static_cast<uint64_t>(ReadBe32(p)) << 32) | ReadBe32(p + 4);
+}
+
+// |units| in a |rate| time base, in milliseconds without overflowing.
+int64_t UnitsToMs(uint64_t units, uint64_t rate) {
+  if (rate == 0) return -1;
+  return static_cast<int64_t>((units / rate) * 1000 +
+                              (units % rate) * 1000 / rate);
+}
+
+class File {
+ public:
+  explicit File(const std::string& path)
+      : file_(std::fopen(path.c_str(), "rb")) {
+    if (file_ != nullptr && fseeko(file_, 0, SEEK_END) == 0) {
+      size_ = ftello(file_);
+    }
+  }
+
+  ~File() {
+    if (file_ != nullptr) std::fclose(file_);
+  }
+
+  // Disallow copy and assign.
+  File(const File&) = delete;
+  File& operator=(const File&) = delete;
+
+  bool is_open() const { return file_ != nullptr && size_ > 0; }
+  int64_t size() const { return size_; }
+
+  // Reads exactly |length| bytes at |offset|.
+  bool ReadAt(int64_t offset, void* out, size_t length) {
+    if (offset < 0 || offset + static_cast<int64_t>(length) > size_) {
+      return false;
+    }
+    return fseeko(file_, offset, SEEK_SET) == 0 &&
+           std::fread(out, 1, length, file_) == length;
+  }
+
+  // Reads up to |length| bytes at |offset|.
+  std::vector<uint8_t> ReadUpTo(int64_t offset, size_t length) {
+    std::vector<uint8_t> data(static_cast<size_t>(
+        std::clamp<int64_t>(size_ - offset, 0, static_cast<int64_t>(length))));
+    if (!data.empty() && !ReadAt(offset, data.data(), data.size())) {
+      data.clear();
+    }
+    return data;
+  }
+
+ private:
+  FILE* file_;
+  int64_t size_ = 0;
+};
+
+// Size of an ID3v2 tag at |offset|, or 0 if there is none.
+int64_t Id3v2Size(File* file, int64_t offset) {
+  uint8_t header[10];
+  if (!file->ReadAt(offset, header, sizeof(header)) ||
+      std::memcmp(header, "ID3", 3) != 0) {
+    return 0;
+  }
+  const int64_t size = (header[6] & 0x7F) << 21 | (header[7] & 0x7F) << 14 |
+                       (header[8] & 0x7F) << 7 | (header[9] & 0x7F);
+  const bool has_footer = (header[5] & 0x10) != 0;
+  return 10 + size + (has_footer ? 10 : 0);
+}
+
+bool ProbeWav(File* file, MediaInfo* info) {
+  int64_t offset = 12;
+  bool has_format = false;
+  uint16_t tag = 0;
+  uint16_t block_align = 0;
+  uint32_t byte_rate = 0;
+  uint8_t chunk[8];
+  while (file->ReadAt(offset, chunk, sizeof(chunk))) {
+    const uint32_t size = ReadLe32(chunk + 4);
+    const int64_t body = offset + 8;
+    if (std::memcmp(chunk, "fmt ", 4) == 0) {
+      uint8_t fmt[26] = {};
+      const size_t length = std::min<size_t>(size, sizeof(fmt));
+      if (length < 16 || !file->ReadAt(body, fmt, length)) return false;
+      tag = ReadLe16(fmt);
+      if (tag == 0xFFFE && length >= 26) tag = ReadLe16(fmt + 24);
+      info->channels = ReadLe16(fmt + 2);
+      info->sample_rate = ReadLe32(fmt + 4);
+      byte_rate = ReadLe32(fmt + 8);
+      block_align = ReadLe16(fmt + 12);
+      has_format = true;
+    } else if (std::memcmp(chunk, "data", 4) == 0) {
+      if (!has_format) return false;
+      // Interrupted recordings leave a zero or oversized length.
+      const int64_t available = file->size() - body;
+      const int64_t bytes =
+          size == 0 ? available : std::min<int64_t>(size, available);
+      switch (tag) {
+        case 0x0001:
+          info->codec = "pcm";
+          break;
+        case 0x0003:
+          info->codec = "float";
+          break;
+        case 0x0006:
+          info->codec = "alaw";
+          break;
+        case 0x0007:
+          info->codec = "mulaw";
+          break;
+        case 0x0002:
+        case 0x0011:
+          info->codec = "adpcm";
+          break;
+        case 0x0055:
+          info->codec = "mp3";
+          break;
+        default:
+          info->codec = "wav";
+      }
+      const bool linear = tag == 0x0001 || tag == 0x0003 || tag == 0x0006 ||
+                          tag == 0x0007;
+      if (linear && block_align > 0) {
+        info->duration_ms = UnitsToMs(bytes / block_align, info->sample_rate);
+      } else if (byte_rate > 0) {
+        info->duration_ms = UnitsToMs(bytes, byte_rate);
+      }
+      return true;
+    }
+    offset = body + size + (size & 1);
+  }
+  return false;
+}
+
+struct Mp3Frame {
+  bool mpeg1;
+  uint32_t bitrate;
+  uint32_t sample_rate;
+  uint16_t channels;
+  uint32_t samples;
+  uint32_t length;
+  const char* codec;
+};
+
+bool ParseMp3Frame(const uint8_t* p, Mp3Frame* frame) {
+  static const uint16_t kBitrates[5][15] = {
+      {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},
+      {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},
+      {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},
+      {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},
+      {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160}};
+  static const uint32_t kSampleRates[3] = {44100, 48000, 32000};
+
+  if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return false;
+  const int version = (p[1] >> 3) & 3;  // 0: 2.5, 2: 2, 3: 1.
+  const int layer = 4 - ((p[1] >> 1) & 3);
+  const int bitrate_index = p[2] >> 4;
+  const int rate_index = (p[2] >> 2) & 3;
+  if (version == 1 || layer == 4 || bitrate_index == 0 ||
+      bitrate_index == 15 || rate_index == 3) {
+    return false;
+  }
+  frame->mpeg1 = version == 3;
+  const int table = frame->mpeg1 ? layer - 1 : (layer == 1 ? 3 : 4);
+  frame->bitrate = kBitrates[table][bitrate_index] * 1000;
+  frame->sample_rate =
+      kSampleRates[rate_index] >> (version == 3 ? 0 : version == 2 ? 1 : 2);
+  frame->channels = (p[3] >> 6) == 3 ? 1 : 2;
+  const uint32_t padding = (p[2] >> 1) & 1;
+  if (layer == 1) {
+    frame->samples = 384;
+    frame->length = (12 * frame->bitrate / frame->sample_rate + padding) * 4;
+  } else {
+    frame->samples = layer == 3 && !frame->mpeg1 ? 576 : 1152;
+    frame->length =
+        frame->samples / 8 * frame->bitrate / frame->sample_rate + padding;
+  }
+  frame->codec = layer == 3 ? "mp3" : layer == 2 ? "mp2" : "mp1";
+  return frame->length >= 4;
+}
+
+// Sums the samples of the frames from |offset| up to |end| into |total|,
+// stopping at the first damaged frame. |parse| reads the sample count and
+// length of the frame whose kHeaderBytes long header it is given. Returns
+// whether the frames reached |end|.
+template <size_t kHeaderBytes, typename Parse>
+bool ScanFrames(File* file, int64_t offset, int64_t end, Parse parse,
+                uint64_t* total) {
+  std::vector<uint8_t> chunk;
+  int64_t chunk_start = 0;
+  uint32_t samples = 0;
+  uint32_t length = 0;
+  *total = 0;
+  while (offset + static_cast<int64_t>(kHeaderBytes) <= end) {
+    if (offset + static_cast<int64_t>(kHeaderBytes) >
+        chunk_start + static_cast<int64_t>(chunk.size())) {
+      chunk = file->ReadUpTo(offset, kScanReadChunk);
+      chunk_start = offset;
+      if (chunk.size() < kHeaderBytes) break;
+    }
+    if (!parse(&chunk[offset - chunk_start], &samples, &length)) break;
+    *total += samples;
+    offset += length;
+  }
+  return offset + static_cast<int64_t>(kHeaderBytes) > end;
+}
+
+// End of the MP3 or ADTS frames, before an ID3v1 tag.
+int64_t FramesEnd(File* file) {
+  uint8_t tag[3];
+  if (file->ReadAt(file->size() - 128, tag, sizeof(tag)) &&
+      std::memcmp(tag, "TAG", 3) == 0) {
+    return file->size() - 128;
+  }
+  return file->size();
+}
+
+bool ProbeMp3(File* file, int64_t start, MediaInfo* info,
+              bool exact_duration) {
+  // A frame counts as found when the next one follows right after it.
+  const std::vector<uint8_t> window = file->ReadUpTo(start, kMp3SyncWindow);
+  Mp3Frame frame = {};
+  int64_t first = -1;
+  for (size_t i = 0; i + 4 <= window.size(); ++i) {
+    if (!ParseMp3Frame(&window[i], &frame)) continue;
+    Mp3Frame next;
+    const size_t next_offset = i + frame.length;
+    if (next_offset + 4 <= window.size() &&
+        !ParseMp3Frame(&window[next_offset], &next)) {
+      continue;
+    }
+    first = start + static_cast<int64_t>(i);
+    break;
+  }
+  if (first < 0) return false;
+  info->codec = frame.codec;
+  info->sample_rate = frame.sample_rate;
+  info->channels = frame.channels;
+
+  // Xing (VBR) and Info (CBR) headers follow the side information, VBRI
+  // headers are at a fixed offset. Their frame holds no audio.
+  const int64_t side_info =
+      frame.mpeg1 ? (frame.channels == 1 ? 17 : 32)
+                  : (frame.channels == 1 ? 9 : 17);
+  uint8_t header[18];
+  bool has_vbr_header = false;
+  uint64_t header_frames = 0;
+  if (file->ReadAt(first + 4 + side_info, header, 12) &&
+      (std::memcmp(header, "Xing", 4) == 0 ||
+       std::memcmp(header, "Info", 4) == 0)) {
+    has_vbr_header = true;
+    if ((ReadBe32(header + 4) & 1) != 0) header_frames = ReadBe32(header + 8);
+  } else if (file->ReadAt(first + 4 + 32, header, 18) &&
+             std::memcmp(header, "VBRI", 4) == 0) {
+    has_vbr_header = true;
+    header_frames = ReadBe32(header + 14);
+  }
+
+  const int64_t end = FramesEnd(file);
+  if (exact_duration) {
+    // The frame count of a header is exact unless the file was cut or
+    // edited afterwards, which only a scan reaching the end of the frames
+    // can tell.
+    uint64_t samples = 0;
+    const bool complete = ScanFrames<4>(
+        file, has_vbr_header ? first + frame.length : first, end,
+        [](const uint8_t* p, uint32_t* samples, uint32_t* length) {
+          Mp3Frame frame;
+          if (!ParseMp3Frame(p, &frame)) return false;
+          *samples = frame.samples;
+          *length = frame.length;
+          return true;
+        },
+        &samples);
+    if (samples > 0 && (header_frames == 0 || complete)) {
+      info->duration_ms = UnitsToMs(samples, frame.sample_rate);
+      return true;
+    }
+  }
+  if (header_frames > 0) {
+    info->duration_ms =
+        UnitsToMs(header_frames * frame.samples, frame.sample_rate);
+    return true;
+  }
+
+  // Without a header, constant bitrate files are measured by their size
+  // and anything else by counting its frames.
+  uint64_t frames = 0;
+  bool constant = true;
+  int64_t offset = first;
+  uint8_t bytes[4];
+  Mp3Frame current;
+  while (offset + 4 <= end && file->ReadAt(offset, bytes, sizeof(bytes)) &&
+         ParseMp3Frame(bytes, &current)) {
+    constant = constant && current.bitrate == frame.bitrate;
+    ++frames;
+    offset += current.length;
+    if (constant && frames == kMp3CbrCheckFrames) {
+      info->duration_ms = UnitsToMs(
+          static_cast<uint64_t>(end - first) * 8, frame.bitrate);
+      return true;
+    }
+  }
+  info->duration_ms = UnitsToMs(frames * frame.samples, frame.sample_rate);
+  return true;
+}
+
+struct AdtsFrame {
+  uint32_t sample_rate;
+  uint16_t channels;
+  uint32_t samples;
+  uint32_t length;
+};
+
+// Parses the 7 byte header of an ADTS frame.
+bool ParseAdtsFrame(const uint8_t* p, AdtsFrame* frame) {
+  static const uint32_t kSampleRates[13] = {96000, 88200, 64000, 48000, 44100,
+                                            32000, 24000, 22050, 16000, 12000,
+                                            11025, 8000,  7350};
+
+  // The layer bits, which are never 0 in MPEG audio frames, are 0.
+  if (p[0] != 0xFF || (p[1] & 0xF6) != 0xF0) return false;
+  const int rate_index = (p[2] >> 2) & 0x0F;
+  if (rate_index >= 13) return false;
+  frame->sample_rate = kSampleRates[rate_index];
+  // 0 when a program config element in the payload tells it.
+  frame->channels = static_cast<uint16_t>(((p[2] & 1) << 2) | (p[3] >> 6));
+  frame->samples = 1024 * ((p[6] & 3) + 1);
+  frame->length = ((p[3] & 3) << 11) | (p[4] << 3) | (p[5] >> 5);
+  const uint32_t header_length = (p[1] & 1) != 0 ? 7 : 9;
+  return frame->length > header_length;
+}
+
+// ADTS streams have no header telling their duration. Unless
+// |exact_duration| is set, it is estimated from the average size of the
+// first frames, otherwise all frames are walked.
+bool ProbeAdts(File* file, int64_t start, MediaInfo* info,
+               bool exact_duration) {
+  uint8_t header[7];
+  AdtsFrame frame;
+  if (!file->ReadAt(start, header, sizeof(header)) ||
+      !ParseAdtsFrame(header, &frame)) {
+    return false;
+  }
+  info->codec = "aac";
+  info->sample_rate = frame.sample_rate;
+  info->channels = frame.channels;
+
+  const int64_t end = FramesEnd(file);
+  if (!exact_duration) {
+    uint64_t samples = 0;
+    int64_t offset = start;
+    AdtsFrame current;
+    for (int i = 0; i < kAdtsEstimateFrames && offset + 7 <= end &&
+                    file->ReadAt(offset, header, sizeof(header)) &&
+                    ParseAdtsFrame(header, &current);
+         ++i) {
+      samples += current.samples;
+      offset += current.length;
+    }
+    // Short streams were walked to their end.
+    if (offset + 7 <= end && offset > start) {
+      samples = samples * static_cast<uint64_t>(end - start) /
+                static_cast<uint64_t>(offset - start);
+    }
+    info->duration_ms = UnitsToMs(samples, frame.sample_rate);
+    return true;
+  }
+  uint64_t samples = 0;
+  ScanFrames<7>(
+      file, start, end,
+      [](const uint8_t* p, uint32_t* samples, uint32_t* length) {
+        AdtsFrame frame;
+        if (!ParseAdtsFrame(p, &frame)) return false;
+        *samples = frame.samples;
+        *length = frame.length;
+        return true;
+      },
+      &samples);
+  info->duration_ms = UnitsToMs(samples, frame.sample_rate);
+  return true;
+}
+
+// Calls |visit| with the type, body offset and end of every box in
+// [start, end) until it returns false.
+using BoxVisitor =
+    std::function<bool(const char* type, int64_t body, int64_t end)>;
+
+void ForEachBox(File* file, int64_t start, int64_t end,
+                const BoxVisitor& visit) {
+  uint8_t header[16];
+  while (start + 8 <= end && file->ReadAt(start, header, 8)) {
+    int64_t size = ReadBe32(header);
+    int64_t body = start + 8;
+    if (size == 1) {
+      if (!file->ReadAt(start + 8, header + 8, 8)) return;
+      size = static_cast<int64_t>(ReadBe64(header + 8));
+      body += 8;
+    } else if (size == 0) {
+      size = end - start;
+    }
+    if (size < body - start || start + size > end) return;
+    const char type[5] = {static_cast<char>(header[4]),
+                          static_cast<char>(header[5]),
+                          static_cast<char>(header[6]),
+                          static_cast<char>(header[7]), '\0'};
+    if (!visit(type, body, start + size)) return;
+    start += size;
+  }
+}
+
+// Reads the time scale and duration of an mvhd or mdhd box.
+bool ReadMediaHeader(File* file, int64_t body, uint32_t* timescale,
+                     uint64_t* duration) {
+  uint8_t data[32];
+  if (!file->ReadAt(body, data, 1)) return false;
+  if (data[0] == 1) {
+    if (!file->ReadAt(body, data, 32)) return false;
+    *timescale = ReadBe32(data + 20);
+    *duration = ReadBe64(data + 24);
+  } else {
+    if (!file->ReadAt(body, data, 20)) return false;
+    *timescale = ReadBe32(data + 12);
+    const uint32_t value = ReadBe32(data + 16);
+    *duration = value == 0xFFFFFFFF ? 0 : value;
+  }
+  return *timescale > 0;
+}
+
+const char* Mp4Codec(const char* fourcc) {
+  static const char* const kCodecs[][2] = {
+      {"mp4a", "aac"},    {"alac", "alac"}, {"Opus", "opus"},
+      {"fLaC", "flac"},   {"ac-3", "ac3"},  {"ec-3", "eac3"},
+      {"samr", "amr_nb"}, {"sawb", "amr_wb"}, {".mp3", "mp3"}};
+  for (const auto& codec : kCodecs) {
+    if (std::strcmp(fourcc, codec[0]) == 0) return codec[1];
+  }
+  return nullptr;
+}
+
+bool ProbeMp4(File* file, MediaInfo* info) {
+  int64_t moov = -1;
+  int64_t moov_end = -1;
+  ForEachBox(file, 0, file->size(),
+             [&](const char* type, int64_t body, int64_t end) {
+               if (std::strcmp(type, "moov") != 0) return true;
+               moov = body;
+               moov_end = end;
+               return false;
+             });
+  if (moov < 0) return false;
+
+  uint32_t movie_timescale = 0;
+  uint64_t movie_duration = 0;
+  bool found_track = false;
+  ForEachBox(file, moov, moov_end, [&](const char* type, int64_t body,
+                                       int64_t end) {
+    if (std::strcmp(type, "mvhd") == 0) {
+      ReadMediaHeader(file, body, &movie_timescale, &movie_duration);
+    } else if (std::strcmp(type, "trak") == 0 && !found_track) {
+      ForEachBox(file, body, end, [&](const char* type, int64_t body,
+                                      int64_t end) {
+        if (std::strcmp(type, "mdia") != 0) return true;
+        uint32_t timescale = 0;
+        uint64_t duration = 0;
+        bool is_sound = false;
+        MediaInfo track;
+        ForEachBox(file, body, end, [&](const char* type, int64_t body,
+                                        int64_t end) {
+          uint8_t data[36];
+          if (std::strcmp(type, "mdhd") == 0) {
+            ReadMediaHeader(file, body, &timescale, &duration);
+          } else if (std::strcmp(type, "hdlr") == 0) {
+            is_sound = file->ReadAt(body, data, 12) &&
+                       std::memcmp(data + 8, "soun", 4) == 0;
+          } else if (std::strcmp(type, "minf") == 0) {
+            // minf > stbl > stsd holds the first sample description.
+            ForEachBox(file, body, end, [&](const char* type, int64_t body,
+                                            int64_t end) {
+              if (std::strcmp(type, "stbl") != 0) return true;
+              ForEachBox(file, body, end, [&](const char* type, int64_t body,
+                                              int64_t) {
+                if (std::strcmp(type, "stsd") != 0) return true;
+                if (file->ReadAt(body + 8, data, sizeof(data))) {
+                  const char fourcc[5] = {
+                      static_cast<char>(data[4]), static_cast<char>(data[5]),
+                      static_cast<char>(data[6]), static_cast<char>(data[7]),
+                      '\0'};
+                  const char* codec = Mp4Codec(fourcc);
+                  track.codec = codec != nullptr ? codec : fourcc;
+                  track.channels = ReadBe16(data + 24);
+                  track.sample_rate = ReadBe32(data + 32) >> 16;
+                }
+                return false;
+              });
+              return false;
+            });
+          }
+          return true;
+        });
+        if (is_sound) {
+          found_track = true;
+          info->codec = track.codec;
+          info->channels = track.channels;
+          info->sample_rate =
+              track.sample_rate != 0 ? track.sample_rate : timescale;
+          if (duration > 0) info->duration_ms = UnitsToMs(duration, timescale);
+        }
+        return false;
+      });
+    }
+    return true;
+  });
+  if (!found_track) return false;
+  if (info->duration_ms < 0 && movie_duration > 0) {
+    info->duration_ms = UnitsToMs(movie_duration, movie_timescale);
+  }
+  return true;
+}
+
+// Reads a FLAC STREAMINFO block body.
+void ParseStreamInfo(const uint8_t* p, MediaInfo* info) {
+  info->codec = "flac";
+  info->sample_rate = (static_cast<uint32_t>(p[10]) << 12) |
+                      (static_cast<uint32_t>(p[11]) << 4) | (p[12] >> 4);
+  info->channels = static_cast<uint16_t>(((p[12] >> 1) & 7) + 1);
+  const uint64_t samples =
+      (static_cast<uint64_t>(p[13] & 0x0F) << 32) | ReadBe32(p + 14);
+  if (samples > 0) info->duration_ms = UnitsToMs(samples, info->sample_rate);
+}
+
+bool ProbeFlac(File* file, int64_t start, MediaInfo* info) {
+  uint8_t data[42];
+  // "fLaC", the header of the STREAMINFO block and its 34 bytes.
+  if (!file->ReadAt(start, data, sizeof(data)) ||
+      std::memcmp(data, "fLaC", 4) != 0 || (data[4] & 0x7F) != 0) {
+    return false;
+  }
+  ParseStreamInfo(data + 8, info);
+  return info->sample_rate > 0;
+}
+
+bool ProbeOgg(File* file, MediaInfo* info) {
+  uint8_t page[27 + 255];
+  if (!file->ReadAt(0, page, 27) ||
+      !file->ReadAt(27, page + 27, page[26])) {
+    return false;
+  }
+  const uint32_t serial = ReadLe32(page + 14);
+  uint8_t packet[64] = {};
+  const std::vector<uint8_t> head = file->ReadUpTo(27 + page[26], 64);
+  std::copy(head.begin(), head.end(), packet);
+
+  uint64_t granule_rate = 0;
+  uint64_t pre_skip = 0;
+  if (std::memcmp(packet, "\x01vorbis", 7) == 0) {
+    info->codec = "vorbis";
+    info->channels = packet[11];
+    info->sample_rate = ReadLe32(packet + 12);
+    granule_rate = info->sample_rate;
+  } else if (std::memcmp(packet, "OpusHead", 8) == 0) {
+    // Opus always runs at 48 kHz, the header holds the input rate.
+    info->codec = "opus";
+    info->channels = packet[9];
+    pre_skip = ReadLe16(packet + 10);
+    const uint32_t input_rate = ReadLe32(packet + 12);
+    info->sample_rate = input_rate != 0 ? input_rate : 48000;
+    granule_rate = 48000;
+  } else if (std::memcmp(packet, "\x7F" "FLAC", 5) == 0 &&
+             std::memcmp(packet + 9, "fLaC", 4) == 0) {
+    ParseStreamInfo(packet + 17, info);
+    granule_rate = info->sample_rate;
+  } else if (std::memcmp(packet, "Speex   ", 8) == 0) {
+    info->codec = "speex";
+    info->sample_rate = ReadLe32(packet + 36);
+    info->channels = static_cast<uint16_t>(ReadLe32(packet + 48));
+    granule_rate = info->sample_rate;
+  } else {
+    return false;
+  }
+
+  // The last page of the stream carries the total number of samples.
+  const int64_t tail_start = std::max<int64_t>(0, file->size() - kOggTailWindow);
+  const std::vector<uint8_t> tail =
+      file->ReadUpTo(tail_start, static_cast<size_t>(kOggTailWindow));
+  for (size_t i = tail.size() >= 27 ? tail.size() - 27 + 1 : 0; i-- > 0;) {
+    if (std::memcmp(&tail[i], "OggS", 4) != 0 ||
+        ReadLe32(&tail[i + 14]) != serial) {
+      continue;
+    }
+    const int64_t granule = static_cast<int64_t>(ReadLe64(&tail[i + 6]));
+    if (granule < 0) continue;
+    const uint64_t samples =
+        static_cast<uint64_t>(granule) > pre_skip ? granule - pre_skip : 0;
+    info->duration_ms = UnitsToMs(samples, granule_rate);
+    break;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool ProbeMedia(const std::string& path, MediaInfo* info,
+                bool exact_duration) {
+  *info = MediaInfo();
+  File file(path);
+  uint8_t magic[12];
+  if (!file.is_open() || !file.ReadAt(0, magic, sizeof(magic))) return false;
+
+  if (std::memcmp(magic, "RIFF", 4) == 0 &&
+      std::memcmp(magic + 8, "WAVE", 4) == 0) {
+    return ProbeWav(&file, info);
+  }
+  if (std::memcmp(magic, "OggS", 4) == 0) return ProbeOgg(&file, info);
+  for (const char* type : {"ftyp", "moov", "wide", "free", "skip", "mdat"}) {
+    if (std::memcmp(magic + 4, type, 4) == 0) return ProbeMp4(&file, info);
+  }
+  // MP3, ADTS and FLAC files may start with ID3 tags.
+  const int64_t start = Id3v2Size(&file, 0);
+  uint8_t marker[4];
+  if (file.ReadAt(start, marker, sizeof(marker)) &&
+      std::memcmp(marker, "fLaC", 4) == 0) {
+    return ProbeFlac(&file, start, info);
+  }
+  if (ProbeAdts(&file, start, info, exact_duration)) return true;
+  return ProbeMp3(&file, start, info, exact_duration);
+}
+
+}  // namespace audio_waveforms
@@ -0,0 +1,33 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_MEDIA_PROBE_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_MEDIA_PROBE_H_
+
+#include <cstdint>
+#include <string>
+
+namespace audio_waveforms {
+
+// Stream properties read from container headers.
+struct MediaInfo {
+  // Short codec name such as "pcm", "mp3", "aac", "vorbis" or "opus".
+  std::string codec;
+  // -1 when the headers don't tell it.
+  int64_t duration_ms = -1;
+  uint32_t sample_rate = 0;
+  uint16_t channels = 0;
+};
+
+// Reads the properties of the audio file at |path| without decoding it.
+// Supports RIFF/WAVE, MP3 (Xing/Info and VBRI headers, or a frame scan),
+// ADTS AAC (estimated from its first frames), MP4/M4A (mdhd of the sound
+// track, else mvhd), Ogg Vorbis/Opus/FLAC (last granule position) and FLAC.
+// Returns false for other or damaged files.
+//
+// With |exact_duration|, the durations of ADTS files and of MP3 files
+// without a Xing or VBRI frame count are summed from every frame header
+// instead of estimated, which reads through the whole file.
+bool ProbeMedia(const std::string& path, MediaInfo* info,
+                bool exact_duration = false);
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_MEDIA_PROBE_H_
@@ -0,0 +1,396 @@
+#include "recording_writer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+namespace audio_waveforms {
+
+namespace {
+
+constexpr size_t kHeaderSize = 44;
+constexpr uint16_t kFormatPcm = 0x0001;
+constexpr uint16_t kFormatFloat = 0x0003;
+
+// Samples encoded between publishing the read index, so the queue frees up
+// while a long drain is still running.
+constexpr size_t kDrainChunk = 4096;
+
+void WriteU16(uint8_t* p, uint16_t value) {
+  p[0] = static_cast<uint8_t>(value);
+  p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void WriteU32(uint8_t* p, uint32_t value) {
+  for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void WriteHeader(uint8_t* out, const PcmFormat& format, uint32_t data_bytes) {
+  const uint16_t block_align = format.channels * (format.bits_per_sample / 8);
+  std::memcpy(out, "RIFF", 4);
+  WriteU32(out + 4, data_bytes == 0 ? 0 : 36 + data_bytes);
+  std::memcpy(out + 8, "WAVEfmt ", 8);
+  WriteU32(out + 16, 16);
+  WriteU16(out + 20, format.is_float ? kFormatFloat : kFormatPcm);
+  WriteU16(out + 22, format.channels);
+  WriteU32(out + 24, format.sample_rate);
+  WriteU32(out + 28, format.sample_rate * block_align);
+  WriteU16(out + 32, block_align);
+  WriteU16(out + 34, format.bits_per_sample);
+  std::memcpy(out + 36, "data", 4);
+  WriteU32(out + 40, data_bytes);
+}
+
+// Writes |sample| in the little endian sample format of |format| to |out|.
+void EncodePcm(float sample, const PcmFormat& format, uint8_t* out) {
+  if (format.is_float) {
+    uint32_t bits;
+    std::memcpy(&bits, &sample, sizeof(bits));
+    WriteU32(out, bits);
+    return;
+  }
+  const double value = std::clamp(static_cast<double>(sample), -1.0, 1.0);
+  switch (format.bits_per_sample) {
+    case 8:
+      out[0] = static_cast<uint8_t>(std::lround(value * 127.0) + 128);
+      break;
+    case 16:
+      WriteU16(out, static_cast<uint16_t>(
+                        static_cast<int16_t>(std::lround(value * 32767.0))));
+      break;
+    case 24: {
+      const int32_t scaled =
+          static_cast<int32_t>(std::lround(value * 8388607.0));
+      for (int i = 0; i < 3; ++i) {
+        out[i] = static_cast<uint8_t>(static_cast<uint32_t>(scaled) >> (8 * i));
+      }
+      break;
+    }
+    default:
+      WriteU32(out, static_cast<uint32_t>(static_cast<int32_t>(
+                        std::llround(value * 2147483647.0))));
+      break;
+  }
+}
+
+int64_t ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+constexpr size_t RecordingWriter::kWriteAlignment;
+constexpr size_t RecordingWriter::kWaveformBuckets;
+constexpr size_t RecordingWriter::kBackpressurePercent;
+constexpr std::chrono::milliseconds RecordingWriter::kPollInterval;
+
+RecordingWriter::RecordingWriter() {}
+
+RecordingWriter::~RecordingWriter() { Close(); }
+
+size_t RecordingWriter::EstimateMemory(const PcmFormat& format,
+                                       const FlushPolicy& policy,
+                                       int64_t queue_ms) {
+  const size_t buffer = std::max(policy.buffer_bytes, kWriteAlignment) +
+                        kWriteAlignment;
+  const int64_t queue_frames =
+      std::max<int64_t>(queue_ms, 100) * format.sample_rate / 1000;
+  return buffer +
+         static_cast<size_t>(queue_frames) * format.channels * sizeof(float) +
+         kWaveformBuckets * (sizeof(double) + sizeof(float));
+}
+
+bool RecordingWriter::Open(const std::string& path, const PcmFormat& format,
+                           const FlushPolicy& policy, int64_t queue_ms) {
+  std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+  if (fd_ >= 0 || closed_) return false;
+  const uint16_t bits = format.bits_per_sample;
+  const bool supported =
+      format.is_float ? bits == 32
+                      : (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+  if (!supported || format.channels == 0 || format.sample_rate == 0) {
+    return false;
+  }
+  format_ = format;
+  policy_ = policy;
+
+  const size_t requested = std::max(policy.buffer_bytes, kWriteAlignment);
+  buffer_size_ = (requested + kWriteAlignment - 1) / kWriteAlignment *
+                 kWriteAlignment;
+  void* memory = nullptr;
+  if (posix_memalign(&memory, kWriteAlignment, buffer_size_) != 0) {
+    return false;
+  }
+  buffer_.reset(static_cast<uint8_t*>(memory));
+  const int64_t queue_frames =
+      std::max<int64_t>(queue_ms, 100) * format.sample_rate / 1000;
+  queue_.assign(static_cast<size_t>(queue_frames) * format.channels, 0.0f);
+  bucket_sums_.assign(kWaveformBuckets, 0.0);
+  bucket_peaks_.assign(kWaveformBuckets, 0.0f);
+  // Buckets start at 10 ms, which lasts about 40 s before the first merge.
+  frames_per_bucket_ = std::max<uint64_t>(1, format.sample_rate / 100);
+
+  fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) return false;
+  // Sent with the first buffer, so audio starts right after it and every
+  // buffer is written at an aligned offset.
+  WriteHeader(buffer_.get(), format_, 0);
+  buffered_ = kHeaderSize;
+  last_flush_ = last_sync_ = std::chrono::steady_clock::now();
+  accepting_.store(true, std::memory_order_release);
+  thread_ = std::thread(&RecordingWriter::Run, this);
+  return true;
+}
+
+bool RecordingWriter::Push(const float* samples, size_t frames) {
+  return PushSamples(frames, false,
+                     [samples](size_t i) { return samples[i]; });
+}
+
+bool RecordingWriter::PushPcm16(const uint8_t* data, size_t size) {
+  return PushSamples(size, true, [data](size_t i) {
+    const auto value =
+        static_cast<int16_t>(data[2 * i] | (data[2 * i + 1] << 8));
+    return value / 32768.0f;
+  });
+}
+
+template <typename Decode>
+bool RecordingWriter::PushSamples(size_t length, bool is_bytes,
+                                  Decode decode) {
+  // The format and queue are only known once the writer accepts audio.
+  if (!accepting_.load(std::memory_order_acquire)) {
+    dropped_blocks_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  const size_t frames =
+      is_bytes ? length / (2 * format_.channels) : length;
+  const size_t count = frames * format_.channels;
+  const size_t write = write_index_.load(std::memory_order_relaxed);
+  const size_t queued = write - read_index_.load(std::memory_order_acquire);
+  if (queued + count > queue_.size()) {
+    dropped_blocks_.fetch_add(1, std::memory_order_relaxed);
+    dropped_frames_.fetch_add(frames, std::memory_order_relaxed);
+    return false;
+  }
+  const size_t size = queue_.size();
+  for (size_t i = 0; i < count; ++i) queue_[(write + i) % size] = decode(i);
+  write_index_.store(write + count, std::memory_order_release);
+
+  const size_t filled = queued + count;
+  if (filled / format_.channels >
+      peak_queued_.load(std::memory_order_relaxed)) {
+    peak_queued_.store(filled / format_.channels, std::memory_order_relaxed);
+  }
+  const size_t threshold = size * kBackpressurePercent / 100;
+  if (!behind_ && filled >= threshold) {
+    behind_ = true;
+    backpressure_events_.fetch_add(1, std::memory_order_relaxed);
+  } else if (behind_ && filled < threshold / 2) {
+    behind_ = false;
+  }
+  return true;
+}
+
+void RecordingWriter::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    // Pushing has stopped before stopping_ is set, so the queue is
+    // complete once it was seen.
+    const bool stopping = stopping_;
+    lock.unlock();
+    Drain();
+    const auto now = std::chrono::steady_clock::now();
+    if (policy_.flush_interval_ms > 0 &&
+        now - last_flush_ >=
+            std::chrono::milliseconds(policy_.flush_interval_ms)) {
+      FlushAligned();
+    }
+    if (policy_.sync_interval_ms > 0 && unsynced_ &&
+        now - last_sync_ >=
+            std::chrono::milliseconds(policy_.sync_interval_ms)) {
+      Sync();
+    }
+    lock.lock();
+    if (stopping) break;
+    wake_.wait_for(lock, kPollInterval, [this] { return stopping_; });
+  }
+}
+
+size_t RecordingWriter::Drain() {
+  size_t read = read_index_.load(std::memory_order_relaxed);
+  const size_t write = write_index_.load(std::memory_order_acquire);
+  const size_t size = queue_.size();
+  const size_t total = write - read;
+  while (read != write) {
+    const size_t end = std::min(write, read + kDrainChunk);
+    for (size_t i = read; i != end; ++i) EncodeSample(queue_[i % size]);
+    samples_written_.fetch_add(end - read, std::memory_order_relaxed);
+    read_index_.store(end, std::memory_order_release);
+    read = end;
+  }
+  return total;
+}
+
+void RecordingWriter::EncodeSample(float sample) {
+  AddToWaveform(sample);
+  uint8_t bytes[4];
+  EncodePcm(sample, format_, bytes);
+  const size_t size = format_.bits_per_sample / 8;
+  for (size_t i = 0; i < size; ++i) {
+    buffer_.get()[buffered_++] = bytes[i];
+    if (buffered_ == buffer_size_) FlushAligned();
+  }
+}
+
+void RecordingWriter::AddToWaveform(float sample) {
+  // Clamped like the encoded sample, so the levels match the file.
+  frame_sum_ += std::clamp(sample, -1.0f, 1.0f);
+  if (++frame_channel_ < format_.channels) return;
+  const float mono = frame_sum_ / format_.channels;
+  frame_sum_ = 0.0f;
+  frame_channel_ = 0;
+  if (bucket_count_ == 0 || frames_in_bucket_ == frames_per_bucket_) {
+    if (bucket_count_ == kWaveformBuckets) MergeWaveformBuckets();
+    bucket_sums_[bucket_count_] = 0.0;
+    bucket_peaks_[bucket_count_] = 0.0f;
+    ++bucket_count_;
+    frames_in_bucket_ = 0;
+  }
+  bucket_sums_[bucket_count_ - 1] += static_cast<double>(mono) * mono;
+  bucket_peaks_[bucket_count_ - 1] =
+      std::max(bucket_peaks_[bucket_count_ - 1], std::abs(mono));
+  ++frames_in_bucket_;
+}
+
+void RecordingWriter::MergeWaveformBuckets() {
+  // Only called with every bucket full, so the merged ones are too.
+  for (size_t i = 0; i < kWaveformBuckets / 2; ++i) {
+    bucket_sums_[i] = bucket_sums_[2 * i] + bucket_sums_[2 * i + 1];
+    bucket_peaks_[i] = std::max(bucket_peaks_[2 * i], bucket_peaks_[2 * i + 1]);
+  }
+  bucket_count_ = kWaveformBuckets / 2;
+  frames_per_bucket_ *= 2;
+  frames_in_bucket_ = frames_per_bucket_;
+}
+
+void RecordingWriter::FlushAligned() {
+  last_flush_ = std::chrono::steady_clock::now();
+  const size_t aligned = buffered_ - buffered_ % kWriteAlignment;
+  if (aligned == 0) return;
+  WriteAll(buffer_.get(), aligned);
+  std::memmove(buffer_.get(), buffer_.get() + aligned, buffered_ - aligned);
+  buffered_ -= aligned;
+}
+
+bool RecordingWriter::WriteAll(const uint8_t* data, size_t size) {
+  // After a failure the rest is discarded, capture goes on regardless.
+  if (io_error_.load(std::memory_order_relaxed)) return false;
+  const auto start = std::chrono::steady_clock::now();
+  while (size > 0) {
+    const ssize_t written = write(fd_, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      io_error_.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  unsynced_ = true;
+  const int64_t elapsed = ElapsedMs(start);
+  if (elapsed > longest_write_ms_.load(std::memory_order_relaxed)) {
+    longest_write_ms_.store(elapsed, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+void RecordingWriter::Sync() {
+  const auto start = std::chrono::steady_clock::now();
+  last_sync_ = start;
+  unsynced_ = false;
+  if (fdatasync(fd_) != 0 && errno != EINVAL) {
+    io_error_.store(true, std::memory_order_relaxed);
+  }
+  const int64_t elapsed = ElapsedMs(start);
+  if (elapsed > longest_write_ms_.load(std::memory_order_relaxed)) {
+    longest_write_ms_.store(elapsed, std::memory_order_relaxed);
+  }
+}
+
+bool RecordingWriter::FinishFile() {
+  uint64_t data_bytes = samples_written_.load() * (format_.bits_per_sample / 8);
+  // RIFF chunks are padded to an even size.
+  if (data_bytes % 2 == 1) buffer_.get()[buffered_++] = 0;
+  WriteAll(buffer_.get(), buffered_);
+  buffered_ = 0;
+  // Lengths beyond 4 GiB can't be represented, readers use the file size.
+  uint8_t header[kHeaderSize];
+  WriteHeader(header, format_,
+              static_cast<uint32_t>(std::min<uint64_t>(
+                  data_bytes, UINT32_MAX - 36)));
+  if (!io_error_ &&
+      pwrite(fd_, header, sizeof(header), 0) !=
+          static_cast<ssize_t>(sizeof(header))) {
+    io_error_ = true;
+  }
+  Sync();
+  if (close(fd_) != 0) io_error_ = true;
+  fd_ = -1;
+  return !io_error_;
+}
+
+bool RecordingWriter::Close() {
+  std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+  if (closed_) return !io_error_;
+  closed_ = true;
+  if (fd_ < 0) return false;
+  accepting_.store(false, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  if (thread_.joinable()) thread_.join();
+  return FinishFile();
+}
+
+WriterStats RecordingWriter::Stats() const {
+  WriterStats stats;
+  stats.frames_written =
+      samples_written_.load(std::memory_order_relaxed) /
+      std::max<uint16_t>(format_.channels, 1);
+  stats.dropped_blocks = dropped_blocks_.load(std::memory_order_relaxed);
+  stats.dropped_frames = dropped_frames_.load(std::memory_order_relaxed);
+  stats.backpressure_events =
+      backpressure_events_.load(std::memory_order_relaxed);
+  stats.queue_capacity_frames =
+      queue_.size() / std::max<uint16_t>(format_.channels, 1);
+  stats.peak_queued_frames = peak_queued_.load(std::memory_order_relaxed);
+  stats.longest_write_ms = longest_write_ms_.load(std::memory_order_relaxed);
+  stats.io_error = io_error_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+RecordingWaveform RecordingWriter::Waveform() const {
+  RecordingWaveform waveform;
+  waveform.frames_per_bucket = frames_per_bucket_;
+  waveform.rms.reserve(bucket_count_);
+  for (size_t i = 0; i < bucket_count_; ++i) {
+    const uint64_t frames =
+        i + 1 < bucket_count_ ? frames_per_bucket_ : frames_in_bucket_;
+    waveform.rms.push_back(
+        static_cast<float>(std::sqrt(bucket_sums_[i] / frames)));
+  }
+  waveform.peaks.assign(bucket_peaks_.begin(),
+                        bucket_peaks_.begin() + bucket_count_);
+  return waveform;
+}
+
+}  // namespace audio_waveforms
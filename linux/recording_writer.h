@@ -0,0 +1,195 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_RECORDING_WRITER_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_RECORDING_WRITER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audio_waveforms {
+
+// Sample format of a written WAV file.
+struct PcmFormat {
+  uint32_t sample_rate = 44100;
+  uint16_t channels = 1;
+  // 8, 16, 24 or 32 for integer samples, 32 for float samples.
+  uint16_t bits_per_sample = 16;
+  bool is_float = false;
+};
+
+// Controls when encoded audio leaves the process and reaches the disk.
+struct FlushPolicy {
+  // Size of the write buffer, rounded up to RecordingWriter::kWriteAlignment.
+  size_t buffer_bytes = 1 << 20;
+  // Longest time encoded audio stays in the write buffer before it is
+  // written. 0 only writes full buffers.
+  int64_t flush_interval_ms = 500;
+  // Interval between fdatasync() calls. 0 leaves syncing to the kernel.
+  int64_t sync_interval_ms = 5000;
+};
+
+struct WriterStats {
+  uint64_t frames_written = 0;
+  // Blocks rejected by Push() because the queue couldn't hold them.
+  uint64_t dropped_blocks = 0;
+  uint64_t dropped_frames = 0;
+  // Times the queue filled beyond kBackpressurePercent, counted once until
+  // it drained below half of that again.
+  uint64_t backpressure_events = 0;
+  size_t queue_capacity_frames = 0;
+  size_t peak_queued_frames = 0;
+  // Longest single write() or fdatasync() call.
+  int64_t longest_write_ms = 0;
+  bool io_error = false;
+};
+
+// Waveform of the written audio, the RMS and peak of its mono downmix in
+// buckets of equal length. The RMS levels are the ones a waveform
+// extraction of the file computes.
+struct RecordingWaveform {
+  std::vector<float> rms;
+  std::vector<float> peaks;
+  // Frames covered by every bucket but the last, which may be shorter.
+  uint64_t frames_per_bucket = 0;
+};
+
+// Encodes captured PCM into a WAV file on a dedicated thread.
+//
+// Capture pushes interleaved blocks into a single producer, single
+// consumer queue which never blocks or allocates, so a stalled disk, for
+// example a network mounted home directory, only fills the queue instead
+// of holding up capture or the main loop. The writer thread drains it into
+// a large aligned buffer and writes whole multiples of kWriteAlignment at
+// aligned file offsets.
+//
+// The header is written with zero lengths first and patched on Close(),
+// readers treat such files as extending to their end, so a recording
+// interrupted by a crash stays readable.
+//
+// The writer thread also reduces every written frame into at most
+// kWaveformBuckets waveform buckets. Once all are in use, adjacent buckets
+// are merged and each covers twice as many frames from then on.
+class RecordingWriter {
+ public:
+  static constexpr size_t kWriteAlignment = 4096;
+  static constexpr size_t kWaveformBuckets = 4096;
+  static constexpr size_t kBackpressurePercent = 75;
+  // Longest time the writer thread sleeps between looking at the queue.
+  static constexpr std::chrono::milliseconds kPollInterval{10};
+
+  RecordingWriter();
+  ~RecordingWriter();
+
+  // Disallow copy and assign.
+  RecordingWriter(const RecordingWriter&) = delete;
+  RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+  // Memory of the write buffer and a queue holding |queue_ms| of audio.
+  static size_t EstimateMemory(const PcmFormat& format,
+                               const FlushPolicy& policy, int64_t queue_ms);
+
+  // Creates |path| and starts the writer thread with a queue holding
+  // |queue_ms| of audio. Returns false if the format is not supported, the
+  // file can't be created or the writer was closed. Can only be called
+  // once, and may run concurrently with Close().
+  bool Open(const std::string& path, const PcmFormat& format,
+            const FlushPolicy& policy, int64_t queue_ms);
+
+  // Queues |frames| interleaved frames. Only one thread may push at a
+  // time. Returns false and counts the block as dropped if the writer is
+  // not open or the queue can't hold the whole block.
+  bool Push(const float* samples, size_t frames);
+
+  // Same as Push() for |size| bytes of interleaved 16-bit little endian
+  // samples, as sent by Dart. Trailing bytes of an incomplete frame are
+  // ignored.
+  bool PushPcm16(const uint8_t* data, size_t size);
+
+  // Drains the queue, patches the header and closes the file. Blocks until
+  // everything was written. Returns false if any write failed.
+  bool Close();
+
+  WriterStats Stats() const;
+
+  // Waveform of everything written. Only valid once Close() returned.
+  RecordingWaveform Waveform() const;
+
+  const PcmFormat& format() const { return format_; }
+
+ private:
+  struct FreeDeleter {
+    void operator()(uint8_t* p) const { std::free(p); }
+  };
+
+  // Queues |length| frames, or |length| bytes when |is_bytes|, which are
+  // read with |decode|.
+  template <typename Decode>
+  bool PushSamples(size_t length, bool is_bytes, Decode decode);
+
+  void Run();
+  size_t Drain();
+  void EncodeSample(float sample);
+  void AddToWaveform(float sample);
+  void MergeWaveformBuckets();
+  void FlushAligned();
+  bool WriteAll(const uint8_t* data, size_t size);
+  void Sync();
+  bool FinishFile();
+
+  PcmFormat format_;
+  FlushPolicy policy_;
+  int fd_ = -1;
+
+  // Queue of samples. Indices only grow and are reduced modulo the size.
+  std::vector<float> queue_;
+  std::atomic<size_t> write_index_{0};
+  std::atomic<size_t> read_index_{0};
+  std::atomic<bool> accepting_{false};
+  // Only touched by the pushing thread.
+  bool behind_ = false;
+
+  std::unique_ptr<uint8_t, FreeDeleter> buffer_;
+  size_t buffer_size_ = 0;
+  size_t buffered_ = 0;
+  std::chrono::steady_clock::time_point last_flush_;
+  std::chrono::steady_clock::time_point last_sync_;
+  bool unsynced_ = false;
+
+  // Waveform buckets, only touched by the writer thread until it joined.
+  // Sums of squares and peaks of the mono downmix.
+  std::vector<double> bucket_sums_;
+  std::vector<float> bucket_peaks_;
+  size_t bucket_count_ = 0;
+  uint64_t frames_per_bucket_ = 1;
+  uint64_t frames_in_bucket_ = 0;
+  float frame_sum_ = 0.0f;
+  uint16_t frame_channel_ = 0;
+
+  std::atomic<uint64_t> samples_written_{0};
+  std::atomic<uint64_t> dropped_blocks_{0};
+  std::atomic<uint64_t> dropped_frames_{0};
+  std::atomic<uint64_t> backpressure_events_{0};
+  std::atomic<size_t> peak_queued_{0};
+  std::atomic<int64_t> longest_write_ms_{0};
+  std::atomic<bool> io_error_{false};
+
+  // Serializes Open() and Close(), which run on different threads when a
+  // recording is stopped while its file is still being created.
+  std::mutex lifecycle_mutex_;
+  bool closed_ = false;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_RECORDING_WRITER_H_
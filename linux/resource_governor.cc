@@ -0,0 +1,142 @@
+#include "resource_governor.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace audio_waveforms {
+
+ResourceGovernor::Lease::Lease(ResourceGovernor* governor, ResourceKind kind,
+                               size_t bytes, bool thread, bool queued)
+    : governor_(governor),
+      kind_(kind),
+      bytes_(bytes),
+      thread_(thread),
+      queued_(queued) {}
+
+ResourceGovernor::Lease::~Lease() { governor_->Release(*this); }
+
+ResourceGovernor::ResourceGovernor(const ResourceBudget& budget)
+    : budget_(budget) {}
+
+void ResourceGovernor::SetBudget(const ResourceBudget& budget) {
+  std::deque<QueuedJob> admitted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = budget;
+    admitted = TakeAdmittedLocked(false);
+  }
+  Admit(std::move(admitted));
+}
+
+void ResourceGovernor::SetPressureCallback(PressureCallback callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  on_pressure_ = std::move(callback);
+}
+
+void ResourceGovernor::Enqueue(ResourceKind kind, size_t bytes,
+                               Admission admit) {
+  std::deque<QueuedJob> admitted;
+  size_t missing = 0;
+  PressureCallback on_pressure;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back({kind, bytes, std::move(admit)});
+    admitted = TakeAdmittedLocked(false);
+    if (!queue_.empty()) {
+      size_t queued_bytes = 0;
+      for (const QueuedJob& job : queue_) queued_bytes += job.bytes;
+      missing = MissingLocked(queued_bytes);
+      on_pressure = on_pressure_;
+    }
+  }
+  Admit(std::move(admitted));
+  if (missing > 0 && on_pressure) on_pressure(missing);
+}
+
+ResourceGovernor::LeasePtr ResourceGovernor::Acquire(ResourceKind kind,
+                                                     size_t min_bytes,
+                                                     size_t bytes,
+                                                     bool thread) {
+  size_t granted = 0;
+  size_t missing = 0;
+  PressureCallback on_pressure;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    missing = MissingLocked(bytes);
+    granted = std::max(min_bytes, bytes - std::min(bytes, missing));
+    ReserveLocked(kind, granted, thread);
+    if (missing > 0) on_pressure = on_pressure_;
+  }
+  if (on_pressure) on_pressure(missing);
+  return LeasePtr(new Lease(this, kind, granted, thread, false));
+}
+
+void ResourceGovernor::AdmitAll() {
+  std::deque<QueuedJob> admitted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    admitted = TakeAdmittedLocked(true);
+  }
+  Admit(std::move(admitted));
+}
+
+ResourceUsage ResourceGovernor::Usage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ResourceUsage usage;
+  usage.budget = budget_;
+  usage.memory_bytes = memory_bytes_;
+  usage.threads = threads_;
+  usage.queued_jobs = queue_.size();
+  usage.leases = leases_;
+  return usage;
+}
+
+std::deque<ResourceGovernor::QueuedJob> ResourceGovernor::TakeAdmittedLocked(
+    bool all) {
+  std::deque<QueuedJob> admitted;
+  while (!queue_.empty()) {
+    QueuedJob& job = queue_.front();
+    const bool fits = MissingLocked(job.bytes) == 0 &&
+                      threads_ < budget_.threads;
+    if (!all && !fits && queued_jobs_running_ > 0) break;
+    ReserveLocked(job.kind, job.bytes, true);
+    ++queued_jobs_running_;
+    admitted.push_back(std::move(job));
+    queue_.pop_front();
+  }
+  return admitted;
+}
+
+void ResourceGovernor::Admit(std::deque<QueuedJob> jobs) {
+  for (QueuedJob& job : jobs) {
+    job.admit(LeasePtr(new Lease(this, job.kind, job.bytes, true, true)));
+  }
+}
+
+void ResourceGovernor::Release(const Lease& lease) {
+  std::deque<QueuedJob> admitted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory_bytes_ -= lease.bytes_;
+    if (lease.thread_) --threads_;
+    if (lease.queued_) --queued_jobs_running_;
+    --leases_[static_cast<size_t>(lease.kind_)];
+    admitted = TakeAdmittedLocked(false);
+  }
+  Admit(std::move(admitted));
+}
+
+void ResourceGovernor::ReserveLocked(ResourceKind kind, size_t bytes,
+                                     bool thread) {
+  memory_bytes_ += bytes;
+  if (thread) ++threads_;
+  ++leases_[static_cast<size_t>(kind)];
+}
+
+size_t ResourceGovernor::MissingLocked(size_t bytes) const {
+  const size_t available =
+      budget_.memory_bytes - std::min(budget_.memory_bytes, memory_bytes_);
+  return bytes > available ? bytes - available : 0;
+}
+
+}  // namespace audio_waveforms
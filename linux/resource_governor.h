@@ -0,0 +1,143 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_RESOURCE_GOVERNOR_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_RESOURCE_GOVERNOR_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace audio_waveforms {
+
+// What resources are reserved for.
+enum class ResourceKind {
+  kExtraction,
+  kSpectrum,
+  kRecording,
+  // Players are opened by Dart, which reserves an estimate for each.
+  kPlayer,
+};
+
+constexpr size_t kResourceKindCount = 4;
+
+struct ResourceBudget {
+  size_t memory_bytes = size_t{256} << 20;
+  // Threads decoding, analyzing or writing audio at once.
+  size_t threads = 4;
+};
+
+struct ResourceUsage {
+  ResourceBudget budget;
+  size_t memory_bytes = 0;
+  size_t threads = 0;
+  // Jobs waiting for resources.
+  size_t queued_jobs = 0;
+  // Reservations held, by ResourceKind.
+  std::array<size_t, kResourceKindCount> leases = {};
+};
+
+// Accounts the memory and threads of everything the plugin runs against a
+// single budget.
+//
+// Jobs which can wait, like extractions, are queued until their estimate
+// fits into the budget. Live work, like recordings and spectrum analysis,
+// can't wait and reserves whatever is left down to a minimum, going over
+// budget if it has to. Whenever a reservation doesn't fit, the owner is
+// told how much memory is missing, so it can free idle resources such as
+// players.
+class ResourceGovernor {
+ public:
+  // Resources held until the lease is destroyed, which may happen on any
+  // thread. Leases must not outlive their governor.
+  class Lease {
+   public:
+    ~Lease();
+
+    // Disallow copy and assign.
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+
+    size_t bytes() const { return bytes_; }
+
+   private:
+    friend class ResourceGovernor;
+    Lease(ResourceGovernor* governor, ResourceKind kind, size_t bytes,
+          bool thread, bool queued);
+
+    ResourceGovernor* governor_;
+    ResourceKind kind_;
+    size_t bytes_;
+    bool thread_;
+    // Whether the lease was admitted from the queue.
+    bool queued_;
+  };
+
+  using LeasePtr = std::unique_ptr<Lease>;
+  // Starts a queued job with the lease of its resources.
+  using Admission = std::function<void(LeasePtr lease)>;
+  // Receives the number of bytes the budget is short of. Called on the
+  // thread which reserved, without holding locks.
+  using PressureCallback = std::function<void(size_t missing_bytes)>;
+
+  explicit ResourceGovernor(const ResourceBudget& budget = {});
+
+  // Disallow copy and assign.
+  ResourceGovernor(const ResourceGovernor&) = delete;
+  ResourceGovernor& operator=(const ResourceGovernor&) = delete;
+
+  // Queued jobs which fit into |budget| are started right away. Reserved
+  // resources are never taken back.
+  void SetBudget(const ResourceBudget& budget);
+
+  void SetPressureCallback(PressureCallback callback);
+
+  // Calls |admit| once |bytes| and a thread fit into the budget, right
+  // away if they already do. Jobs are admitted in the order they were
+  // queued. So every job eventually runs, the first queued job is admitted
+  // regardless of the budget when no other queued job is running.
+  void Enqueue(ResourceKind kind, size_t bytes, Admission admit);
+
+  // Reserves up to |bytes| and, if |thread| is set, a thread without
+  // waiting. Less is reserved when the budget is short, but at least
+  // |min_bytes|, which may exceed the budget.
+  LeasePtr Acquire(ResourceKind kind, size_t min_bytes, size_t bytes,
+                   bool thread);
+
+  // Admits every queued job regardless of the budget, so their owners can
+  // respond before shutting down.
+  void AdmitAll();
+
+  ResourceUsage Usage() const;
+
+ private:
+  struct QueuedJob {
+    ResourceKind kind;
+    size_t bytes;
+    Admission admit;
+  };
+
+  // Takes the jobs which can start now off the queue and reserves their
+  // resources. |all| ignores the budget.
+  std::deque<QueuedJob> TakeAdmittedLocked(bool all);
+  void Admit(std::deque<QueuedJob> jobs);
+  void Release(const Lease& lease);
+  void ReserveLocked(ResourceKind kind, size_t bytes, bool thread);
+  // Bytes the budget is short of for |bytes| more.
+  size_t MissingLocked(size_t bytes) const;
+
+  mutable std::mutex mutex_;
+  ResourceBudget budget_;
+  size_t memory_bytes_ = 0;
+  size_t threads_ = 0;
+  // Running jobs which were admitted from the queue.
+  size_t queued_jobs_running_ = 0;
+  std::array<size_t, kResourceKindCount> leases_ = {};
+  std::deque<QueuedJob> queue_;
+  PressureCallback on_pressure_;
+};
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_RESOURCE_GOVERNOR_H_
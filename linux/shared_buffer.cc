@@ -0,0 +1,50 @@
+#include "shared_buffer.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "include/audio_waveforms/audio_waveforms_plugin.h"
+
+namespace audio_waveforms {
+
+static_assert(sizeof(std::atomic<uint64_t>) == 8 &&
+                  std::atomic<uint64_t>::is_always_lock_free,
+              "Dart reads the version as a plain 64-bit integer.");
+
+SharedBuffer* SharedBuffer::Create(size_t length) {
+  if (length > (SIZE_MAX - kDataOffset) / sizeof(float)) return nullptr;
+  void* memory = std::calloc(1, kDataOffset + length * sizeof(float));
+  if (memory == nullptr) return nullptr;
+  return new (memory) SharedBuffer(length);
+}
+
+SharedBuffer::SharedBuffer(size_t length)
+    : length_(static_cast<int64_t>(length)) {
+  static_assert(offsetof(SharedBuffer, version_) == 0 &&
+                    offsetof(SharedBuffer, length_) == 8 &&
+                    sizeof(SharedBuffer) <= kDataOffset,
+                "Dart reads the header at fixed offsets.");
+}
+
+void SharedBuffer::Retain() {
+  references_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SharedBuffer::Release() {
+  if (references_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+  this->~SharedBuffer();
+  std::free(this);
+}
+
+float* SharedBuffer::data() {
+  return reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(this) +
+                                  kDataOffset);
+}
+
+}  // namespace audio_waveforms
+
+void audio_waveforms_shared_buffer_release(void* buffer) {
+  if (buffer != nullptr) {
+    static_cast<audio_waveforms::SharedBuffer*>(buffer)->Release();
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SHARED_BUFFER_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SHARED_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace audio_waveforms {
+
+// Reference counted floats which Dart reads in place through dart:ffi
+// instead of receiving a copy in a platform message.
+//
+// Dart relies on the layout: the version at byte 0, the length at byte 8
+// and the floats from kDataOffset, all in native byte order. Dart owns one
+// reference per buffer it received and releases it with
+// audio_waveforms_shared_buffer_release() once its views are collected.
+class SharedBuffer {
+ public:
+  static constexpr size_t kDataOffset = 32;
+
+  // Returns a zeroed buffer of |length| floats holding one reference, or
+  // null if it can't be allocated.
+  static SharedBuffer* Create(size_t length);
+
+  // Disallow copy and assign.
+  SharedBuffer(const SharedBuffer&) = delete;
+  SharedBuffer& operator=(const SharedBuffer&) = delete;
+
+  void Retain();
+  // Frees the buffer when the last reference is released.
+  void Release();
+
+  float* data();
+  size_t length() const { return static_cast<size_t>(length_); }
+
+  // Counts changes of the floats, so readers can tell whether they saw a
+  // change. Published with release semantics after the floats are written.
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+  void Publish() { version_.fetch_add(1, std::memory_order_release); }
+
+ private:
+  explicit SharedBuffer(size_t length);
+  ~SharedBuffer() = default;
+
+  std::atomic<uint64_t> version_{0};
+  int64_t length_;
+  std::atomic<int32_t> references_{1};
+};
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SHARED_BUFFER_H_
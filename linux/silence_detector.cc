@@ -0,0 +1,65 @@
+#include "silence_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_waveforms {
+
+SilenceDetector::SilenceDetector(uint32_t sample_rate, float threshold_db,
+                                 int64_t min_silence_ms)
+    : sample_rate_(sample_rate),
+      frame_length_(std::max<size_t>(1, sample_rate / 100)),
+      threshold_power_(std::pow(10.0f, threshold_db / 10.0f)),
+      min_silence_frames_(std::max<int64_t>(1, (min_silence_ms + 9) / 10)) {}
+
+void SilenceDetector::Process(const float* samples, size_t count) {
+  samples_ += count;
+  for (size_t i = 0; i < count; ++i) {
+    frame_power_ += samples[i] * samples[i];
+    if (++frame_fill_ == frame_length_) CloseFrame();
+  }
+}
+
+void SilenceDetector::CloseFrame() {
+  const bool silent = frame_power_ / frame_fill_ < threshold_power_;
+  frame_power_ = 0.0;
+  frame_fill_ = 0;
+  if (frames_ == 0) {
+    run_silent_ = silent;
+  } else if (silent != run_silent_) {
+    Append(run_start_, frames_, run_silent_);
+    run_start_ = frames_;
+    run_silent_ = silent;
+  }
+  ++frames_;
+}
+
+void SilenceDetector::Append(int64_t start_frame, int64_t end_frame,
+                             bool silent) {
+  // Short silence is merged into the sound around it.
+  if (silent && end_frame - start_frame < min_silence_frames_) silent = false;
+  if (!segments_.empty() && segments_.back().silent == silent) {
+    segments_.back().end_ms = FrameToMs(end_frame);
+    return;
+  }
+  segments_.push_back({FrameToMs(start_frame), FrameToMs(end_frame), silent});
+}
+
+int64_t SilenceDetector::FrameToMs(int64_t frame) const {
+  return frame * static_cast<int64_t>(frame_length_) * 1000 / sample_rate_;
+}
+
+std::vector<AudioSegment> SilenceDetector::Finish() {
+  if (frame_fill_ > 0) CloseFrame();
+  if (frames_ > run_start_) Append(run_start_, frames_, run_silent_);
+  run_start_ = frames_;
+  // The last frame may be partial.
+  if (!segments_.empty()) {
+    segments_.back().end_ms = samples_ * 1000 / sample_rate_;
+  }
+  std::vector<AudioSegment> segments;
+  segments.swap(segments_);
+  return segments;
+}
+
+}  // namespace audio_waveforms
@@ -0,0 +1,56 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SILENCE_DETECTOR_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SILENCE_DETECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio_waveforms {
+
+// A span of audio which is either silent or not.
+struct AudioSegment {
+  int64_t start_ms;
+  int64_t end_ms;
+  bool silent;
+};
+
+// Splits a stream of mono samples into silent and non-silent segments.
+//
+// Samples are measured in 10 ms frames. A frame is silent when its RMS level
+// is below the threshold, and silence shorter than the minimum duration is
+// treated as part of the surrounding sound. Only the segment list grows with
+// the input, so memory stays bounded for any file length.
+class SilenceDetector {
+ public:
+  SilenceDetector(uint32_t sample_rate, float threshold_db,
+                  int64_t min_silence_ms);
+
+  void Process(const float* samples, size_t count);
+
+  // Flushes the last frame and returns segments covering the whole input
+  // in chronological order, alternating between silent and non-silent.
+  std::vector<AudioSegment> Finish();
+
+ private:
+  void CloseFrame();
+  void Append(int64_t start_frame, int64_t end_frame, bool silent);
+  int64_t FrameToMs(int64_t frame) const;
+
+  uint32_t sample_rate_;
+  size_t frame_length_;
+  float threshold_power_;
+  int64_t min_silence_frames_;
+
+  double frame_power_ = 0.0;
+  size_t frame_fill_ = 0;
+  int64_t frames_ = 0;
+  int64_t samples_ = 0;
+
+  bool run_silent_ = false;
+  int64_t run_start_ = 0;
+  std::vector<AudioSegment> segments_;
+};
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SILENCE_DETECTOR_H_
@@ -0,0 +1,138 @@
+#include "spectrum_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_waveforms {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Band edges are FFT bin indices, spaced logarithmically between
+// kMinFrequency and Nyquist. Every band covers at least one bin.
+std::vector<size_t> BandEdges(size_t fft_size, size_t band_count,
+                              uint32_t sample_rate) {
+  const size_t half = fft_size / 2;
+  const double bin_hz = static_cast<double>(sample_rate) / fft_size;
+  const double low =
+      std::max(SpectrumAnalyzer::kMinFrequency / bin_hz, 1.0);
+  const double high = static_cast<double>(half);
+  band_count = std::max<size_t>(1, std::min(band_count, half - 1));
+  std::vector<size_t> edges;
+  edges.push_back(static_cast<size_t>(low));
+  for (size_t i = 1; i <= band_count; ++i) {
+    const size_t edge = static_cast<size_t>(
+        std::lround(low * std::pow(high / low, static_cast<double>(i) /
+                                                   band_count)));
+    if (edge <= edges.back()) {
+      if (edges.back() + 1 > half) break;
+      edges.push_back(edges.back() + 1);
+    } else {
+      edges.push_back(std::min(edge, half));
+    }
+  }
+  return edges;
+}
+
+}  // namespace
+
+SpectrumAnalyzer::SpectrumAnalyzer(size_t fft_size, size_t band_count,
+                                   uint32_t sample_rate)
+    : fft_size_(fft_size) {
+  const size_t half = fft_size / 2;
+
+  double window_sum = 0.0;
+  window_.resize(fft_size);
+  for (size_t i = 0; i < fft_size; ++i) {
+    window_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i /
+                                                         (fft_size - 1)));
+    window_sum += window_[i];
+  }
+  // A full scale sine reads 0 dB regardless of window and FFT size.
+  power_scale_ = static_cast<float>(4.0 / (window_sum * window_sum));
+
+  size_t bits = 0;
+  while ((static_cast<size_t>(1) << bits) < half) ++bits;
+  bit_reverse_.resize(half);
+  for (size_t i = 0; i < half; ++i) {
+    size_t reversed = 0;
+    for (size_t b = 0; b < bits; ++b) {
+      reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    bit_reverse_[i] = reversed;
+  }
+  twiddles_.resize(half / 2);
+  for (size_t i = 0; i < twiddles_.size(); ++i) {
+    twiddles_[i] = std::polar(1.0f, static_cast<float>(-2.0 * kPi * i / half));
+  }
+  split_twiddles_.resize(half);
+  for (size_t k = 0; k < half; ++k) {
+    split_twiddles_[k] =
+        std::polar(1.0f, static_cast<float>(-2.0 * kPi * k / fft_size));
+  }
+  buffer_.resize(half);
+  power_.resize(half + 1);
+  band_edges_ = BandEdges(fft_size, band_count, sample_rate);
+}
+
+size_t SpectrumAnalyzer::BandCount(size_t fft_size, size_t band_count,
+                                   uint32_t sample_rate) {
+  return BandEdges(fft_size, band_count, sample_rate).size() - 1;
+}
+
+bool SpectrumAnalyzer::IsValidFftSize(size_t fft_size) {
+  return fft_size >= 64 && fft_size <= 32768 &&
+         (fft_size & (fft_size - 1)) == 0;
+}
+
+void SpectrumAnalyzer::Analyze(const float* samples, float* bands) {
+  const size_t half = fft_size_ / 2;
+
+  // Packs even samples into the real and odd samples into the imaginary
+  // part, so the real FFT costs one complex FFT of half the size.
+  for (size_t i = 0; i < half; ++i) {
+    buffer_[bit_reverse_[i]] = {samples[2 * i] * window_[2 * i],
+                                samples[2 * i + 1] * window_[2 * i + 1]};
+  }
+  Transform();
+
+  for (size_t k = 0; k <= half; ++k) {
+    const std::complex<float> z = buffer_[k % half];
+    const std::complex<float> mirror = std::conj(buffer_[(half - k) % half]);
+    const std::complex<float> even = 0.5f * (z + mirror);
+    const std::complex<float> odd =
+        std::complex<float>(0.0f, -0.5f) * (z - mirror);
+    const std::complex<float> twiddle =
+        k < half ? split_twiddles_[k] : std::complex<float>(-1.0f, 0.0f);
+    power_[k] = std::norm(even + twiddle * odd) * power_scale_;
+  }
+
+  for (size_t b = 0; b + 1 < band_edges_.size(); ++b) {
+    float sum = 0.0f;
+    for (size_t k = band_edges_[b]; k < band_edges_[b + 1]; ++k) {
+      sum += power_[k];
+    }
+    const float mean = sum / (band_edges_[b + 1] - band_edges_[b]);
+    const float db = 10.0f * std::log10(std::max(mean, 1e-12f));
+    bands[b] = std::clamp((db - kFloorDb) / -kFloorDb, 0.0f, 1.0f);
+  }
+}
+
+void SpectrumAnalyzer::Transform() {
+  const size_t n = buffer_.size();
+  for (size_t size = 2; size <= n; size <<= 1) {
+    const size_t step = n / size;
+    const size_t span = size / 2;
+    for (size_t start = 0; start < n; start += size) {
+      for (size_t j = 0; j < span; ++j) {
+        const std::complex<float> t =
+            twiddles_[j * step] * buffer_[start + j + span];
+        buffer_[start + j + span] = buffer_[start + j] - t;
+        buffer_[start + j] += t;
+      }
+    }
+  }
+}
+
+}  // namespace audio_waveforms
@@ -0,0 +1,56 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SPECTRUM_ANALYZER_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SPECTRUM_ANALYZER_H_
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio_waveforms {
+
+// Computes a bar spectrum of mono audio frames. Each call windows
+// |fft_size| samples with a Hann window, runs a real FFT and averages the
+// power of the bins into logarithmically spaced bands.
+//
+// Band values are the band level in dBFS mapped from [kFloorDb, 0] to
+// [0, 1], so they can be drawn like waveform data.
+class SpectrumAnalyzer {
+ public:
+  static constexpr float kFloorDb = -90.0f;
+  static constexpr float kMinFrequency = 40.0f;
+
+  // |fft_size| must be a power of two of at least 64. |band_count| is
+  // reduced when the FFT doesn't have enough bins to fill every band.
+  SpectrumAnalyzer(size_t fft_size, size_t band_count, uint32_t sample_rate);
+
+  size_t fft_size() const { return fft_size_; }
+  size_t band_count() const { return band_edges_.size() - 1; }
+
+  // Analyzes |fft_size| samples from |samples| and writes band_count()
+  // values into |bands|.
+  void Analyze(const float* samples, float* bands);
+
+  static bool IsValidFftSize(size_t fft_size);
+
+  // The band_count() of an analyzer constructed with these arguments.
+  static size_t BandCount(size_t fft_size, size_t band_count,
+                          uint32_t sample_rate);
+
+ private:
+  // In-place radix-2 FFT of |buffer_|, which holds fft_size / 2 points.
+  void Transform();
+
+  size_t fft_size_;
+  float power_scale_;
+  std::vector<float> window_;
+  std::vector<size_t> band_edges_;
+  std::vector<size_t> bit_reverse_;
+  std::vector<std::complex<float>> twiddles_;
+  std::vector<std::complex<float>> split_twiddles_;
+  std::vector<std::complex<float>> buffer_;
+  std::vector<float> power_;
+};
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SPECTRUM_ANALYZER_H_
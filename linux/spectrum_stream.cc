@@ -0,0 +1,189 @@
+#include "spectrum_stream.h"
+
+#include <algorithm>
+
+namespace audio_waveforms {
+
+constexpr std::chrono::milliseconds SpectrumStream::kFrameInterval;
+
+PlaybackSpectrum::PlaybackSpectrum(std::unique_ptr<WavReader> reader,
+                                   size_t fft_size, size_t band_count,
+                                   FrameCallback callback)
+    : reader_(std::move(reader)),
+      analyzer_(fft_size, band_count, reader_->format().sample_rate),
+      callback_(std::move(callback)),
+      frames_(fft_size * reader_->format().channels),
+      mono_(fft_size),
+      anchor_time_(std::chrono::steady_clock::now()),
+      thread_(&PlaybackSpectrum::Run, this) {}
+
+size_t PlaybackSpectrum::EstimateMemory(size_t fft_size, size_t band_count,
+                                        uint16_t channels) {
+  // Raw and decoded frames, the downmix and the analyzer, which keeps about
+  // eight floats per frame in its tables.
+  return fft_size * (2 * channels + 1 + 8) * sizeof(float) +
+         band_count * (sizeof(float) + sizeof(size_t));
+}
+
+PlaybackSpectrum::~PlaybackSpectrum() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+void PlaybackSpectrum::UpdateClock(int64_t position_ms, double rate,
+                                   bool playing) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    anchor_ms_ = position_ms;
+    anchor_time_ = std::chrono::steady_clock::now();
+    rate_ = rate;
+    playing_ = playing;
+    dirty_ = true;
+  }
+  wake_.notify_one();
+}
+
+int64_t PlaybackSpectrum::PositionMsLocked() const {
+  if (!playing_) return anchor_ms_;
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - anchor_time_);
+  return anchor_ms_ + static_cast<int64_t>(elapsed.count() * rate_);
+}
+
+void PlaybackSpectrum::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    if (playing_) {
+      wake_.wait_for(lock, kFrameInterval);
+    } else {
+      wake_.wait(lock, [this] { return stopped_ || dirty_; });
+    }
+    if (stopped_) break;
+    const bool dirty = dirty_;
+    if (frame_pending_ && !dirty) continue;
+    dirty_ = false;
+    const int64_t position_ms = PositionMsLocked();
+    lock.unlock();
+    AnalyzeAt(position_ms);
+    lock.lock();
+  }
+}
+
+void PlaybackSpectrum::AnalyzeAt(int64_t position_ms) {
+  const WavFormat& format = reader_->format();
+  const size_t fft_size = analyzer_.fft_size();
+  // The window is centered on the playback position.
+  const int64_t center = position_ms * format.sample_rate / 1000;
+  const int64_t start = center - static_cast<int64_t>(fft_size / 2);
+  const size_t skipped =
+      static_cast<size_t>(std::clamp<int64_t>(-start, 0, fft_size));
+  std::fill(mono_.begin(), mono_.end(), 0.0f);
+  size_t read = 0;
+  if (skipped < fft_size && reader_->SeekToFrame(start + skipped)) {
+    read = reader_->ReadFrames(frames_.data(), fft_size - skipped);
+    DownmixToMono(frames_.data(), read, format.channels,
+                  mono_.data() + skipped);
+  }
+
+  std::vector<float> bands(analyzer_.band_count());
+  analyzer_.Analyze(mono_.data(), bands.data());
+  frame_pending_ = true;
+  callback_(std::move(bands));
+}
+
+RecordingSpectrum::RecordingSpectrum(uint32_t sample_rate, uint16_t channels,
+                                     size_t fft_size, size_t band_count,
+                                     FrameCallback callback)
+    : analyzer_(fft_size, band_count, sample_rate),
+      callback_(std::move(callback)),
+      channels_(std::max<uint16_t>(channels, 1)),
+      sample_rate_(sample_rate),
+      mono_(fft_size),
+      history_(fft_size + sample_rate),
+      block_time_(std::chrono::steady_clock::now()),
+      thread_(&RecordingSpectrum::Run, this) {}
+
+size_t RecordingSpectrum::EstimateMemory(size_t fft_size, size_t band_count,
+                                         uint32_t sample_rate) {
+  // A second of history besides the window, the downmix and the analyzer.
+  return (fft_size * (2 + 8) + sample_rate) * sizeof(float) +
+         band_count * (sizeof(float) + sizeof(size_t));
+}
+
+RecordingSpectrum::~RecordingSpectrum() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+void RecordingSpectrum::PushPcm16(const uint8_t* data, size_t size) {
+  const size_t frames = size / (2 * channels_);
+  if (frames == 0) return;
+  // Decoded before taking the lock, which the analysis thread holds while
+  // it copies its window.
+  std::vector<float> samples(frames * channels_);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] =
+        static_cast<int16_t>(data[2 * i] | (data[2 * i + 1] << 8)) / 32768.0f;
+  }
+  block_.resize(frames);
+  DownmixToMono(samples.data(), frames, channels_, block_.data());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // A block which doesn't fit is only kept up to its last samples.
+  const size_t kept = std::min(frames, history_.size());
+  for (size_t i = frames - kept; i < frames; ++i) {
+    history_[(received_ + i) % history_.size()] = block_[i];
+  }
+  // The rest of a block which wasn't fully shown yet is skipped.
+  block_start_ = received_;
+  received_ += frames;
+  block_time_ = std::chrono::steady_clock::now();
+}
+
+uint64_t RecordingSpectrum::WindowEndLocked() const {
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - block_time_);
+  const uint64_t spread =
+      static_cast<uint64_t>(elapsed.count()) * sample_rate_ / 1000000;
+  // Never older than the history holds, behind a block too long to spread.
+  const uint64_t oldest =
+      received_ > history_.size() - mono_.size()
+          ? received_ - (history_.size() - mono_.size())
+          : 0;
+  return std::max(std::min(block_start_ + spread, received_), oldest);
+}
+
+void RecordingSpectrum::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    wake_.wait_for(lock, kFrameInterval);
+    if (stopped_) break;
+    const uint64_t end = WindowEndLocked();
+    if (frame_pending_ || end == analyzed_end_) continue;
+    analyzed_end_ = end;
+    // The window ends at |end|, the samples before the first are silence.
+    const size_t fft_size = mono_.size();
+    for (size_t i = 0; i < fft_size; ++i) {
+      const uint64_t index = end + i;
+      mono_[i] = index < fft_size ? 0.0f
+                                  : history_[(index - fft_size) %
+                                             history_.size()];
+    }
+    lock.unlock();
+    std::vector<float> bands(analyzer_.band_count());
+    analyzer_.Analyze(mono_.data(), bands.data());
+    frame_pending_ = true;
+    callback_(std::move(bands));
+    lock.lock();
+  }
+}
+
+}  // namespace audio_waveforms
@@ -0,0 +1,138 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SPECTRUM_STREAM_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SPECTRUM_STREAM_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spectrum_analyzer.h"
+#include "wav_reader.h"
+
+namespace audio_waveforms {
+
+// A source of spectrum frames analyzed on a dedicated thread.
+class SpectrumStream {
+ public:
+  // Receives band values of one frame. Called on the analysis thread.
+  using FrameCallback = std::function<void(std::vector<float> bands)>;
+
+  static constexpr std::chrono::milliseconds kFrameInterval{16};
+
+  virtual ~SpectrumStream() = default;
+
+  // Reports play, pause, seek and rate changes of the audio the stream
+  // follows. Streams which follow capture ignore it.
+  virtual void UpdateClock(int64_t position_ms, double rate, bool playing) {}
+
+  // Frames are dropped until the previously emitted frame was delivered,
+  // so a busy UI thread never accumulates a backlog.
+  void FrameDelivered() { frame_pending_ = false; }
+
+ protected:
+  std::atomic<bool> frame_pending_{false};
+};
+
+// Produces spectrum frames of a file in sync with its playback.
+//
+// Playback happens elsewhere, so the owner reports play, pause, seek and
+// rate changes through UpdateClock() and the stream extrapolates the
+// position in between. While playing, one frame is analyzed per display
+// frame on a dedicated thread. Otherwise a single frame is emitted after
+// each clock update, starting with the first one.
+class PlaybackSpectrum : public SpectrumStream {
+ public:
+  PlaybackSpectrum(std::unique_ptr<WavReader> reader, size_t fft_size,
+                   size_t band_count, FrameCallback callback);
+
+  // Approximate memory held by a stream of a file with |channels|.
+  static size_t EstimateMemory(size_t fft_size, size_t band_count,
+                               uint16_t channels);
+  ~PlaybackSpectrum() override;
+
+  // Disallow copy and assign.
+  PlaybackSpectrum(const PlaybackSpectrum&) = delete;
+  PlaybackSpectrum& operator=(const PlaybackSpectrum&) = delete;
+
+  void UpdateClock(int64_t position_ms, double rate, bool playing) override;
+
+ private:
+  void Run();
+  int64_t PositionMsLocked() const;
+  void AnalyzeAt(int64_t position_ms);
+
+  std::unique_ptr<WavReader> reader_;
+  SpectrumAnalyzer analyzer_;
+  FrameCallback callback_;
+  std::vector<float> frames_;
+  std::vector<float> mono_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopped_ = false;
+  bool dirty_ = false;
+  bool playing_ = false;
+  double rate_ = 1.0;
+  int64_t anchor_ms_ = 0;
+  std::chrono::steady_clock::time_point anchor_time_;
+
+  std::thread thread_;
+};
+
+// Produces spectrum frames of audio while it is recorded.
+//
+// The recorder delivers audio in blocks, so each block is spread over its
+// own duration: one frame is analyzed per display frame, with the window
+// ending where the audio received so far would be if it arrived in real
+// time. No frames are emitted while no audio arrives.
+class RecordingSpectrum : public SpectrumStream {
+ public:
+  RecordingSpectrum(uint32_t sample_rate, uint16_t channels, size_t fft_size,
+                    size_t band_count, FrameCallback callback);
+
+  // Approximate memory held by a stream of audio at |sample_rate|.
+  static size_t EstimateMemory(size_t fft_size, size_t band_count,
+                               uint32_t sample_rate);
+  ~RecordingSpectrum() override;
+
+  // Disallow copy and assign.
+  RecordingSpectrum(const RecordingSpectrum&) = delete;
+  RecordingSpectrum& operator=(const RecordingSpectrum&) = delete;
+
+  // Appends |size| bytes of interleaved 16-bit little-endian PCM, the
+  // blocks queued to the RecordingWriter. Called on one thread only.
+  void PushPcm16(const uint8_t* data, size_t size);
+
+ private:
+  void Run();
+  uint64_t WindowEndLocked() const;
+
+  SpectrumAnalyzer analyzer_;
+  FrameCallback callback_;
+  const uint16_t channels_;
+  const uint32_t sample_rate_;
+  std::vector<float> block_;
+  std::vector<float> mono_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopped_ = false;
+  // Ring of the latest mono samples, indexed by their position modulo its
+  // size. Longer than the window so a block can be spread over time.
+  std::vector<float> history_;
+  uint64_t received_ = 0;
+  uint64_t block_start_ = 0;
+  std::chrono::steady_clock::time_point block_time_;
+  uint64_t analyzed_end_ = 0;
+
+  std::thread thread_;
+};
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_SPECTRUM_STREAM_H_
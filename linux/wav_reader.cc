@@ -0,0 +1,188 @@
+#include "wav_reader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace audio_waveforms {
+
+namespace {
+
+constexpr uint16_t kFormatPcm = 0x0001;
+constexpr uint16_t kFormatFloat = 0x0003;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+// Frames converted per fread() call.
+constexpr size_t kReadChunkFrames = 4096;
+
+uint16_t ReadU16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+float DecodeSample(const uint8_t* p, const WavFormat& format) {
+  if (format.is_float) {
+    if (format.bits_per_sample == 64) {
+      uint64_t bits = static_cast<uint64_t>(ReadU32(p)) |
+                      (static_cast<uint64_t>(ReadU32(p + 4)) << 32);
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return static_cast<float>(value);
+    }
+    uint32_t bits = ReadU32(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  switch (format.bits_per_sample) {
+    case 8:
+      return (static_cast<int>(p[0]) - 128) / 128.0f;
+    case 16:
+      return static_cast<int16_t>(ReadU16(p)) / 32768.0f;
+    case 24: {
+      int32_t value = static_cast<int32_t>(
+          (static_cast<uint32_t>(p[0]) << 8) |
+          (static_cast<uint32_t>(p[1]) << 16) |
+          (static_cast<uint32_t>(p[2]) << 24));
+      return (value >> 8) / 8388608.0f;
+    }
+    default:
+      return static_cast<float>(static_cast<int32_t>(ReadU32(p)) /
+                                2147483648.0);
+  }
+}
+
+}  // namespace
+
+WavReader::WavReader() {}
+
+WavReader::~WavReader() { Close(); }
+
+bool WavReader::Open(const std::string& path) {
+  Close();
+  file_ = std::fopen(path.c_str(), "rb");
+  if (file_ == nullptr) return false;
+
+  uint8_t header[12];
+  if (std::fread(header, 1, sizeof(header), file_) != sizeof(header) ||
+      std::memcmp(header, "RIFF", 4) != 0 ||
+      std::memcmp(header + 8, "WAVE", 4) != 0) {
+    Close();
+    return false;
+  }
+
+  bool has_format = false;
+  uint8_t chunk[8];
+  while (std::fread(chunk, 1, sizeof(chunk), file_) == sizeof(chunk)) {
+    const uint32_t size = ReadU32(chunk + 4);
+    if (std::memcmp(chunk, "fmt ", 4) == 0) {
+      uint8_t fmt[40] = {};
+      const size_t length = std::min<size_t>(size, sizeof(fmt));
+      if (length < 16 || std::fread(fmt, 1, length, file_) != length) break;
+      uint16_t tag = ReadU16(fmt);
+      if (tag == kFormatExtensible && length >= 26) tag = ReadU16(fmt + 24);
+      format_.channels = ReadU16(fmt + 2);
+      format_.sample_rate = ReadU32(fmt + 4);
+      format_.block_align = ReadU16(fmt + 12);
+      format_.bits_per_sample = ReadU16(fmt + 14);
+      format_.is_float = tag == kFormatFloat;
+      const uint16_t bits = format_.bits_per_sample;
+      const bool supported =
+          format_.is_float ? (bits == 32 || bits == 64)
+                           : (tag == kFormatPcm &&
+                              (bits == 8 || bits == 16 || bits == 24 ||
+                               bits == 32));
+      if (!supported || format_.channels == 0 || format_.sample_rate == 0 ||
+          format_.block_align < format_.channels * (bits / 8)) {
+        break;
+      }
+      has_format = true;
+      std::fseek(file_, static_cast<long>(size - length + (size & 1)),
+                 SEEK_CUR);
+    } else if (std::memcmp(chunk, "data", 4) == 0) {
+      if (!has_format) break;
+      data_offset_ = std::ftell(file_);
+      // Recorders that were interrupted leave a zero or oversized length.
+      std::fseek(file_, 0, SEEK_END);
+      const int64_t available = std::ftell(file_) - data_offset_;
+      const int64_t declared = size == 0 ? available : size;
+      frame_count_ = std::min(declared, available) / format_.block_align;
+      return SeekToFrame(0);
+    } else if (std::fseek(file_, static_cast<long>(size + (size & 1)),
+                          SEEK_CUR) != 0) {
+      break;
+    }
+  }
+  Close();
+  return false;
+}
+
+void WavReader::Close() {
+  if (file_ != nullptr) std::fclose(file_);
+  file_ = nullptr;
+  format_ = WavFormat();
+  data_offset_ = 0;
+  frame_count_ = 0;
+  position_ = 0;
+}
+
+int64_t WavReader::DurationMs() const {
+  if (format_.sample_rate == 0) return 0;
+  return frame_count_ * 1000 / format_.sample_rate;
+}
+
+bool WavReader::SeekToFrame(int64_t frame) {
+  if (file_ == nullptr) return false;
+  frame = std::clamp<int64_t>(frame, 0, frame_count_);
+  if (std::fseek(file_,
+                 static_cast<long>(data_offset_ + frame * format_.block_align),
+                 SEEK_SET) != 0) {
+    return false;
+  }
+  position_ = frame;
+  return true;
+}
+
+size_t WavReader::ReadFrames(float* out, size_t max_frames) {
+  if (file_ == nullptr) return 0;
+  const size_t bytes_per_sample = format_.bits_per_sample / 8;
+  size_t total = 0;
+  while (total < max_frames && position_ < frame_count_) {
+    const size_t wanted = static_cast<size_t>(std::min<int64_t>(
+        {static_cast<int64_t>(max_frames - total),
+         static_cast<int64_t>(kReadChunkFrames), frame_count_ - position_}));
+    raw_.resize(wanted * format_.block_align);
+    const size_t frames =
+        std::fread(raw_.data(), format_.block_align, wanted, file_);
+    for (size_t i = 0; i < frames; ++i) {
+      const uint8_t* frame = raw_.data() + i * format_.block_align;
+      for (uint16_t c = 0; c < format_.channels; ++c) {
+        *out++ = DecodeSample(frame + c * bytes_per_sample, format_);
+      }
+    }
+    total += frames;
+    position_ += frames;
+    if (frames < wanted) break;
+  }
+  return total;
+}
+
+void DownmixToMono(const float* in, size_t frames, uint16_t channels,
+                   float* out) {
+  if (channels == 1) {
+    std::copy(in, in + frames, out);
+    return;
+  }
+  const float scale = 1.0f / channels;
+  for (size_t i = 0; i < frames; ++i) {
+    float sum = 0.0f;
+    for (uint16_t c = 0; c < channels; ++c) sum += *in++;
+    out[i] = sum * scale;
+  }
+}
+
+}  // namespace audio_waveforms
@@ -0,0 +1,61 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_WAV_READER_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_WAV_READER_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace audio_waveforms {
+
+// Sample layout of a RIFF/WAVE file.
+struct WavFormat {
+  uint16_t channels = 0;
+  uint32_t sample_rate = 0;
+  uint16_t bits_per_sample = 0;
+  uint16_t block_align = 0;
+  bool is_float = false;
+};
+
+// Reads linear PCM and IEEE float WAV files as interleaved floats in
+// [-1, 1]. The data chunk is accessed directly, so seeking is O(1).
+class WavReader {
+ public:
+  WavReader();
+  ~WavReader();
+
+  // Disallow copy and assign.
+  WavReader(const WavReader&) = delete;
+  WavReader& operator=(const WavReader&) = delete;
+
+  // Opens |path| and parses its header. Returns false if the file is not a
+  // WAV file with a supported sample format.
+  bool Open(const std::string& path);
+  void Close();
+
+  const WavFormat& format() const { return format_; }
+  int64_t frame_count() const { return frame_count_; }
+  int64_t DurationMs() const;
+
+  bool SeekToFrame(int64_t frame);
+
+  // Reads up to |max_frames| interleaved frames into |out|, which must hold
+  // |max_frames| * channels floats. Returns the number of frames read.
+  size_t ReadFrames(float* out, size_t max_frames);
+
+ private:
+  FILE* file_ = nullptr;
+  WavFormat format_;
+  int64_t data_offset_ = 0;
+  int64_t frame_count_ = 0;
+  int64_t position_ = 0;
+  std::vector<uint8_t> raw_;
+};
+
+// Averages the channels of |frames| interleaved frames from |in| into |out|.
+void DownmixToMono(const float* in, size_t frames, uint16_t channels,
+                   float* out);
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_WAV_READER_H_
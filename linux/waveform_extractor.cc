@@ -0,0 +1,323 @@
+#include "waveform_extractor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace audio_waveforms {
+
+namespace {
+
+constexpr size_t kBlockFrames = 4096;
+
+// Progress is reported in steps of at least this much.
+constexpr float kProgressStep = 0.01f;
+
+// Channels assumed by EstimateMemory(), the file isn't opened before.
+constexpr size_t kEstimatedChannels = 2;
+
+// Blocks visited by the coarsest level of a progressive extraction, unless
+// there are fewer points.
+constexpr int64_t kCoarsestBlocks = 64;
+
+// Point i covers frames [i * total / count, (i + 1) * total / count).
+int64_t BucketEnd(size_t index, int64_t total_frames, size_t sample_count) {
+  return static_cast<int64_t>((index + 1) * total_frames / sample_count);
+}
+
+// Index of the first point whose end is past |frame|, the inverse of
+// BucketEnd().
+size_t BucketOf(int64_t frame, int64_t total_frames, size_t sample_count) {
+  const int64_t count = static_cast<int64_t>(sample_count);
+  return static_cast<size_t>(
+      ((frame + 1) * count + total_frames - 1) / total_frames - 1);
+}
+
+// RMS of every point. With |fill_gaps| points no frame has reached yet
+// repeat the closest reached point on their left, or the first one.
+std::vector<float> PointLevels(const std::vector<double>& sums,
+                               const std::vector<int64_t>& counts,
+                               bool fill_gaps) {
+  std::vector<float> waveform(sums.size(), 0.0f);
+  ptrdiff_t first = -1;
+  ptrdiff_t last = -1;
+  for (size_t i = 0; i < sums.size(); ++i) {
+    if (counts[i] > 0) {
+      waveform[i] = static_cast<float>(std::sqrt(sums[i] / counts[i]));
+      if (first < 0) first = static_cast<ptrdiff_t>(i);
+      last = static_cast<ptrdiff_t>(i);
+    } else if (fill_gaps && last >= 0) {
+      waveform[i] = waveform[last];
+    }
+  }
+  if (fill_gaps && first > 0) {
+    std::fill(waveform.begin(), waveform.begin() + first, waveform[first]);
+  }
+  return waveform;
+}
+
+// Sums of squares of the waveforms of a ChannelMode for every point, read
+// from the interleaved blocks which also feed the mixed waveform.
+class ChannelSums {
+ public:
+  ChannelSums(ChannelMode mode, uint16_t channels, size_t sample_count,
+              int64_t total_frames)
+      : mode_(mode),
+        channels_(channels),
+        lanes_(mode == ChannelMode::kPerChannel ? channels
+               : mode == ChannelMode::kMidSide  ? 2
+                                                : 0),
+        sample_count_(sample_count),
+        total_frames_(total_frames),
+        sums_(lanes_ * sample_count, 0.0),
+        counts_(sample_count, 0) {}
+
+  bool empty() const { return lanes_ == 0; }
+
+  // Adds |count| frames starting at frame |start| of the file.
+  void Add(const float* frames, size_t count, int64_t start) {
+    if (empty() || count == 0) return;
+    size_t i = 0;
+    size_t bucket = BucketOf(start, total_frames_, sample_count_);
+    while (i < count && bucket < sample_count_) {
+      // Frames up to the end of the point are reduced in one run.
+      const int64_t end = BucketEnd(bucket, total_frames_, sample_count_);
+      const size_t run = static_cast<size_t>(std::min<int64_t>(
+          static_cast<int64_t>(count - i),
+          end - start - static_cast<int64_t>(i)));
+      AddRun(frames + i * channels_, run, &sums_[bucket * lanes_]);
+      counts_[bucket] += static_cast<int64_t>(run);
+      i += run;
+      ++bucket;
+    }
+  }
+
+  std::vector<std::vector<float>> Levels() const {
+    std::vector<std::vector<float>> levels(
+        lanes_, std::vector<float>(sample_count_, 0.0f));
+    for (size_t i = 0; i < sample_count_; ++i) {
+      if (counts_[i] == 0) continue;
+      for (size_t lane = 0; lane < lanes_; ++lane) {
+        levels[lane][i] = static_cast<float>(
+            std::sqrt(sums_[i * lanes_ + lane] / counts_[i]));
+      }
+    }
+    return levels;
+  }
+
+ private:
+  void AddRun(const float* frames, size_t count, double* sums) const {
+    if (mode_ == ChannelMode::kMidSide) {
+      const size_t right = channels_ > 1 ? 1 : 0;
+      double mid = 0.0;
+      double side = 0.0;
+      for (size_t i = 0; i < count; ++i) {
+        const float* frame = frames + i * channels_;
+        const float m = (frame[0] + frame[right]) * 0.5f;
+        const float d = (frame[0] - frame[right]) * 0.5f;
+        mid += static_cast<double>(m) * m;
+        side += static_cast<double>(d) * d;
+      }
+      sums[0] += mid;
+      sums[1] += side;
+      return;
+    }
+    // Channel by channel, so each reduction is a plain strided loop.
+    for (size_t c = 0; c < channels_; ++c) {
+      double sum = 0.0;
+      for (size_t i = 0; i < count; ++i) {
+        const float value = frames[i * channels_ + c];
+        sum += static_cast<double>(value) * value;
+      }
+      sums[c] += sum;
+    }
+  }
+
+  const ChannelMode mode_;
+  const size_t channels_;
+  const size_t lanes_;
+  const size_t sample_count_;
+  const int64_t total_frames_;
+  // Point major, the sums of all lanes of a point are adjacent.
+  std::vector<double> sums_;
+  std::vector<int64_t> counts_;
+};
+
+}  // namespace
+
+WaveformExtractor::WaveformExtractor(const ExtractionOptions& options)
+    : options_(options) {
+  options_.sample_count = std::max<size_t>(1, options_.sample_count);
+}
+
+size_t WaveformExtractor::EstimateMemory(const ExtractionOptions& options) {
+  const size_t lanes = options.channel_mode == ChannelMode::kMixed
+                           ? 0
+                           : kEstimatedChannels;
+  // Sums, counts and levels of every point and lane, and the copy of the
+  // levels sent to Dart.
+  const size_t per_point = sizeof(double) + sizeof(int64_t) +
+                           2 * sizeof(float) +
+                           lanes * (sizeof(double) + 2 * sizeof(float));
+  // Decoded, raw and downmixed samples of a block.
+  const size_t per_block =
+      kBlockFrames * (2 * kEstimatedChannels * sizeof(float) + sizeof(float));
+  return std::max<size_t>(1, options.sample_count) * per_point + per_block;
+}
+
+bool WaveformExtractor::Extract(WavReader* reader,
+                                const std::atomic<bool>& cancelled,
+                                const ProgressCallback& on_progress,
+                                ExtractionResult* result) {
+  const WavFormat& format = reader->format();
+  const int64_t total_frames = reader->frame_count();
+  const size_t sample_count = options_.sample_count;
+  result->waveform.clear();
+  result->waveform.reserve(sample_count);
+  result->channel_waveforms.clear();
+  result->segments.clear();
+  result->has_loudness = false;
+  result->duration_ms = reader->DurationMs();
+  if (!reader->SeekToFrame(0)) return false;
+  if (options_.progressive && !options_.detect_silence &&
+      !options_.measure_loudness) {
+    return ExtractProgressive(reader, cancelled, on_progress, result);
+  }
+
+  std::unique_ptr<SilenceDetector> silence;
+  if (options_.detect_silence) {
+    silence = std::make_unique<SilenceDetector>(format.sample_rate,
+                                                options_.silence_threshold_db,
+                                                options_.min_silence_ms);
+  }
+  std::unique_ptr<LoudnessMeter> loudness;
+  if (options_.measure_loudness) {
+    loudness =
+        std::make_unique<LoudnessMeter>(format.sample_rate, format.channels);
+  }
+
+  ChannelSums channel_sums(options_.channel_mode, format.channels,
+                           sample_count, total_frames);
+  std::vector<float> frames(kBlockFrames * format.channels);
+  std::vector<float> mono(kBlockFrames);
+  int64_t position = 0;
+  int64_t end = BucketEnd(0, total_frames, sample_count);
+  double sum = 0.0;
+  int64_t summed = 0;
+  float reported = 0.0f;
+
+  while (result->waveform.size() < sample_count) {
+    if (cancelled) return false;
+    const size_t read = reader->ReadFrames(frames.data(), kBlockFrames);
+    // Loudness is weighted per channel, so it is measured before downmixing.
+    if (loudness) loudness->Process(frames.data(), read);
+    channel_sums.Add(frames.data(), read, position);
+    DownmixToMono(frames.data(), read, format.channels, mono.data());
+    if (silence) silence->Process(mono.data(), read);
+
+    for (size_t i = 0; i < read; ++i) {
+      sum += static_cast<double>(mono[i]) * mono[i];
+      ++summed;
+      if (++position < end) continue;
+      while (position >= end && result->waveform.size() < sample_count) {
+        result->waveform.push_back(
+            summed > 0 ? static_cast<float>(std::sqrt(sum / summed)) : 0.0f);
+        sum = 0.0;
+        summed = 0;
+        end = BucketEnd(result->waveform.size(), total_frames, sample_count);
+      }
+    }
+
+    const bool finished = read < kBlockFrames;
+    if (finished) {
+      // Files shorter than the number of points leave empty buckets.
+      result->waveform.resize(sample_count, 0.0f);
+    }
+    const float progress =
+        static_cast<float>(result->waveform.size()) / sample_count;
+    if (on_progress && (progress - reported >= kProgressStep ||
+                        progress >= 1.0f)) {
+      reported = progress;
+      on_progress(result->waveform, progress, -1);
+    }
+    if (finished) break;
+  }
+
+  if (!channel_sums.empty()) result->channel_waveforms = channel_sums.Levels();
+  if (silence) result->segments = silence->Finish();
+  if (loudness) {
+    result->loudness = loudness->Finish();
+    result->has_loudness = true;
+  }
+  return true;
+}
+
+bool WaveformExtractor::ExtractProgressive(WavReader* reader,
+                                           const std::atomic<bool>& cancelled,
+                                           const ProgressCallback& on_progress,
+                                           ExtractionResult* result) {
+  const uint16_t channels = reader->format().channels;
+  const int64_t total_frames = reader->frame_count();
+  const size_t sample_count = options_.sample_count;
+  const int64_t block_count =
+      (total_frames + static_cast<int64_t>(kBlockFrames) - 1) / kBlockFrames;
+  const int64_t coarsest =
+      std::min(kCoarsestBlocks, static_cast<int64_t>(sample_count));
+  int64_t stride = 1;
+  while (block_count / (stride * 2) >= coarsest) stride *= 2;
+
+  std::vector<double> sums(sample_count, 0.0);
+  std::vector<int64_t> counts(sample_count, 0);
+  ChannelSums channel_sums(options_.channel_mode, channels, sample_count,
+                           total_frames);
+  std::vector<float> frames(kBlockFrames * channels);
+  std::vector<float> mono(kBlockFrames);
+  int64_t visited = 0;
+  float reported = 0.0f;
+  int level = 0;
+  for (int64_t step = stride; step >= 1; step /= 2, ++level) {
+    const int64_t first = level == 0 ? 0 : step;
+    const int64_t increment = level == 0 ? step : step * 2;
+    for (int64_t block = first; block < block_count; block += increment) {
+      if (cancelled) return false;
+      const int64_t start = block * static_cast<int64_t>(kBlockFrames);
+      if (!reader->SeekToFrame(start)) return false;
+      const size_t read = reader->ReadFrames(frames.data(), kBlockFrames);
+      channel_sums.Add(frames.data(), read, start);
+      DownmixToMono(frames.data(), read, channels, mono.data());
+
+      size_t bucket = BucketOf(start, total_frames, sample_count);
+      int64_t end = BucketEnd(bucket, total_frames, sample_count);
+      for (size_t i = 0; i < read; ++i) {
+        while (start + static_cast<int64_t>(i) >= end) {
+          end = BucketEnd(++bucket, total_frames, sample_count);
+        }
+        sums[bucket] += static_cast<double>(mono[i]) * mono[i];
+        ++counts[bucket];
+      }
+
+      const float progress = static_cast<float>(++visited) / block_count;
+      if (on_progress && progress - reported >= kProgressStep &&
+          visited < block_count) {
+        reported = progress;
+        on_progress(PointLevels(sums, counts, true), progress, level);
+      }
+    }
+    // Every level ends with an update, even if it was too short to report
+    // progress on its own.
+    if (on_progress) {
+      const bool complete = visited == block_count;
+      if (!complete) reported = static_cast<float>(visited) / block_count;
+      on_progress(PointLevels(sums, counts, !complete),
+                  complete ? 1.0f : reported, level);
+    }
+  }
+
+  // Files shorter than the number of points leave empty buckets, which
+  // stay zero as in the sequential pass.
+  result->waveform = PointLevels(sums, counts, false);
+  if (!channel_sums.empty()) result->channel_waveforms = channel_sums.Levels();
+  return true;
+}
+
+}  // namespace audio_waveforms
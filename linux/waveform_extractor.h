@@ -0,0 +1,97 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_WAVEFORM_EXTRACTOR_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_WAVEFORM_EXTRACTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "loudness_meter.h"
+#include "silence_detector.h"
+#include "wav_reader.h"
+
+namespace audio_waveforms {
+
+// Waveforms computed besides the mixed one.
+enum class ChannelMode {
+  kMixed,
+  // One waveform per channel.
+  kPerChannel,
+  // The mid (L + R) / 2 and side (L - R) / 2 waveforms of the first two
+  // channels. Mono files have a silent side.
+  kMidSide,
+};
+
+struct ExtractionOptions {
+  // Number of waveform points, the noOfSamples of extractWaveformData.
+  size_t sample_count = 100;
+
+  bool detect_silence = false;
+  float silence_threshold_db = -50.0f;
+  int64_t min_silence_ms = 300;
+
+  bool measure_loudness = false;
+
+  // Decodes the file coarse to fine instead of from start to end, so the
+  // first update already spans the whole file. Ignored when silence is
+  // detected or loudness is measured, both need the frames in order.
+  bool progressive = false;
+
+  ChannelMode channel_mode = ChannelMode::kMixed;
+};
+
+struct ExtractionResult {
+  std::vector<float> waveform;
+  // Waveforms of ExtractionOptions::channel_mode, each with the points of
+  // |waveform|. Empty for ChannelMode::kMixed.
+  std::vector<std::vector<float>> channel_waveforms;
+  // Only filled when ExtractionOptions::detect_silence is set.
+  std::vector<AudioSegment> segments;
+  // Only set when ExtractionOptions::measure_loudness is set.
+  bool has_loudness = false;
+  LoudnessResult loudness = {};
+  int64_t duration_ms = 0;
+};
+
+// Computes the RMS waveform of a file in a single decode pass, the same
+// values the Android and iOS extractors produce. Every other analysis,
+// including the waveforms of single channels, is fed from the same decoded
+// blocks so it doesn't cost another pass. Progress updates only carry the
+// mixed waveform.
+//
+// Progressive extractions read every block exactly once too, but visit
+// every |stride|th block first and then the blocks halfway between those
+// visited so far. Each of these rounds is a resolution level. Points no
+// block has reached yet repeat their closest neighbour, and the last level
+// yields the exact waveform.
+class WaveformExtractor {
+ public:
+  // Receives the waveform computed so far, the progress in [0, 1] and the
+  // resolution level, which is -1 unless the extraction is progressive.
+  using ProgressCallback = std::function<void(
+      const std::vector<float>& waveform, float progress, int level)>;
+
+  explicit WaveformExtractor(const ExtractionOptions& options);
+
+  // Upper bound of the memory an extraction with |options| holds, including
+  // the copies of its result, for files of up to two channels.
+  static size_t EstimateMemory(const ExtractionOptions& options);
+
+  // Decodes |reader| from its first frame. Returns false if |cancelled| was
+  // set before the extraction finished.
+  bool Extract(WavReader* reader, const std::atomic<bool>& cancelled,
+               const ProgressCallback& on_progress, ExtractionResult* result);
+
+ private:
+  bool ExtractProgressive(WavReader* reader,
+                          const std::atomic<bool>& cancelled,
+                          const ProgressCallback& on_progress,
+                          ExtractionResult* result);
+
+  ExtractionOptions options_;
+};
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_WAVEFORM_EXTRACTOR_H_
@@ -0,0 +1,55 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+
+namespace audio_waveforms {
+
+constexpr size_t WorkerPool::kMaxThreads;
+
+WorkerPool::WorkerPool()
+    : WorkerPool(std::clamp<size_t>(std::thread::hardware_concurrency(), 2,
+                                    kMaxThreads)) {}
+
+WorkerPool::WorkerPool(size_t thread_count) {
+  thread_count = std::max<size_t>(1, thread_count);
+  threads_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back(&WorkerPool::Run, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  available_.notify_all();
+  for (auto& thread : threads_) thread.join();
+}
+
+void WorkerPool::Post(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(task));
+  }
+  available_.notify_one();
+}
+
+void WorkerPool::Run() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      available_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      // Queued tasks still run while stopping, they may hold method calls
+      // which have to be answered.
+      if (queue_.empty()) return;
+      task = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    // Whatever the task captured is released here, off the main thread.
+    task();
+  }
+}
+
+}  // namespace audio_waveforms
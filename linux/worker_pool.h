@@ -0,0 +1,56 @@
+#ifndef FLUTTER_PLUGIN_AUDIO_WAVEFORMS_WORKER_POOL_H_
+#define FLUTTER_PLUGIN_AUDIO_WAVEFORMS_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace audio_waveforms {
+
+// Runs decoding, probing and file I/O on a fixed set of threads so method
+// calls never block the GTK main thread.
+//
+// Tasks don't return anything. They report back by marshalling their
+// results to the main context themselves, and are cancelled through flags
+// owned by whoever posted them.
+class WorkerPool {
+ public:
+  using Task = std::function<void()>;
+
+  // Threads used when the hardware concurrency is unknown or higher.
+  static constexpr size_t kMaxThreads = 4;
+
+  // Uses one thread per core, between 2 and kMaxThreads.
+  WorkerPool();
+  explicit WorkerPool(size_t thread_count);
+
+  // Runs the tasks which are still queued, then joins the threads. Owners
+  // cancel their tasks first so this returns quickly.
+  ~WorkerPool();
+
+  // Disallow copy and assign.
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Queues |task|. Tasks start in the order they were posted.
+  void Post(Task task);
+
+  size_t thread_count() const { return threads_.size(); }
+
+ private:
+  void Run();
+
+  std::mutex mutex_;
+  std::condition_variable available_;
+  std::deque<Task> queue_;
+  bool stopping_ = false;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace audio_waveforms
+
+#endif  // FLUTTER_PLUGIN_AUDIO_WAVEFORMS_WORKER_POOL_H_
@@ -1,9 +1,16 @@
 import 'dart:async';
 import 'dart:io';
+import 'dart:typed_data';
 
+import 'package:audio_waveforms/src/base/constants.dart';
 import 'package:audio_waveforms/src/base/utils.dart' show FinishMode;
 import 'package:audio_waveforms/src/base/desktop_audio_handler.dart';
+import 'package:audio_waveforms/src/base/platform_streams.dart';
+import 'package:audio_waveforms/src/base/playback_clock.dart';
 import 'package:audio_waveforms/src/models/recorder_settings.dart';
+import 'package:audio_waveforms/src/models/recording_writer_settings.dart';
+import 'package:audio_waveforms/src/models/resource_budget.dart';
+import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:mockito/mockito.dart';
 import 'package:mockito/annotations.dart';
@@ -11,9 +18,14 @@ import 'package:record/record.dart'
     show AudioRecorder, RecordConfig, AudioEncoder;
 import 'package:just_audio/just_audio.dart';
 import 'desktop_audio_handler_test.mocks.dart';
+import 'shared_float_buffer_test.dart' show allocateBuffer;
 
 @GenerateMocks([AudioRecorder, AudioPlayer])
 void main() {
+  // Handlers probe durations natively on Linux, which falls back to the
+  // player when the channel has no handler.
+  TestWidgetsFlutterBinding.ensureInitialized();
+
   group('initRecorder', () {
     test('returns false when permission denied', () async {
       final mockRecorder = MockAudioRecorder();
@@ -73,6 +85,187 @@ void main() {
     )).called(1);
   });
 
+  test('stop reads the recording duration with the probe', () async {
+    final mockRecorder = MockAudioRecorder();
+    when(mockRecorder.stop()).thenAnswer((_) async => '/tmp/recording.m4a');
+    final mockPlayer = MockAudioPlayer();
+
+    final handler = DesktopAudioHandler(
+      recorder: mockRecorder,
+      playerFactory: () => mockPlayer,
+      durationProbe: (path) async => 1500,
+    );
+
+    final result = await handler.stop();
+
+    expect(result[Constants.resultFilePath], '/tmp/recording.m4a');
+    expect(result[Constants.resultDuration], 1500);
+    verifyNever(mockPlayer.setFilePath(any));
+  });
+
+  group('native recording writer', () {
+    const channel = MethodChannel(Constants.methodChannelName);
+
+    tearDown(() {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, null);
+    });
+
+    test('streams wav recordings into the writer', () async {
+      final calls = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        calls.add(call);
+        switch (call.method) {
+          case Constants.startRecordingWriter:
+            return true;
+          case Constants.writeRecordingData:
+            return true;
+          case Constants.stopRecordingWriter:
+            return {
+              Constants.duration: 1000,
+              Constants.framesWritten: 16000,
+              Constants.droppedBlocks: 0,
+              Constants.waveformData: Float32List.fromList([0.25, 0.5]),
+              Constants.waveformPeaks: Float32List.fromList([0.5, 1.0]),
+            };
+        }
+        return null;
+      });
+      final pcm = StreamController<Uint8List>();
+      final mockRecorder = MockAudioRecorder();
+      when(mockRecorder.hasPermission()).thenAnswer((_) async => true);
+      when(mockRecorder.startStream(any)).thenAnswer((_) async => pcm.stream);
+      when(mockRecorder.stop()).thenAnswer((_) async {
+        pcm.add(Uint8List(4));
+        await pcm.close();
+        return null;
+      });
+      final handler = DesktopAudioHandler(
+        recorder: mockRecorder,
+        playerFactory: () => MockAudioPlayer(),
+      );
+
+      final started = await handler.record(
+        settings: const RecorderSettings(
+          sampleRate: 16000,
+          writerSettings: RecordingWriterSettings(channels: 2),
+        ),
+        path: '/tmp/recording.wav',
+      );
+      pcm.add(Uint8List(8));
+      final result = await handler.stop();
+
+      expect(started, isTrue);
+      verifyNever(mockRecorder.start(any, path: anyNamed('path')));
+      final config = verify(mockRecorder.startStream(captureAny))
+          .captured
+          .single as RecordConfig;
+      expect(config.encoder, AudioEncoder.pcm16bits);
+      expect(config.sampleRate, 16000);
+      expect(config.numChannels, 2);
+      expect(calls.first.arguments[Constants.path], '/tmp/recording.wav');
+      expect(calls.first.arguments[Constants.channels], 2);
+      expect(calls.first.arguments[Constants.linearPCMBitDepth], 16);
+      // Blocks shorter than a batch are sent together once capture ends.
+      expect(
+        calls
+            .where((call) => call.method == Constants.writeRecordingData)
+            .map((call) => (call.arguments[Constants.data] as Uint8List)
+                .length),
+        [12],
+      );
+      expect(calls.last.method, Constants.stopRecordingWriter);
+      expect(result[Constants.resultFilePath], '/tmp/recording.wav');
+      expect(result[Constants.resultDuration], 1000);
+      // Buckets of the written samples, so the file isn't decoded again.
+      expect(result[Constants.waveformData], [0.25, 0.5]);
+      expect(result[Constants.waveformPeaks], [0.5, 1.0]);
+    }, skip: !Platform.isLinux);
+
+    test('analyses the spectrum of the recording', () async {
+      final calls = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        calls.add(call);
+        return call.method == Constants.stopRecordingWriter ? null : true;
+      });
+      final mockRecorder = MockAudioRecorder();
+      when(mockRecorder.hasPermission()).thenAnswer((_) async => true);
+      when(mockRecorder.startStream(any))
+          .thenAnswer((_) async => const Stream.empty());
+      when(mockRecorder.stop()).thenAnswer((_) async => null);
+      final handler = DesktopAudioHandler(
+        recorder: mockRecorder,
+        playerFactory: () => MockAudioPlayer(),
+      );
+
+      final before =
+          await handler.startRecordingSpectrum(bands: 16, fftSize: 1024);
+      await handler.record(
+        settings: const RecorderSettings(
+          sampleRate: 16000,
+          writerSettings: RecordingWriterSettings(channels: 2),
+        ),
+        path: '/tmp/recording.wav',
+      );
+      final started =
+          await handler.startRecordingSpectrum(bands: 16, fftSize: 1024);
+      await handler.stop();
+
+      expect(before, isFalse);
+      expect(started, isTrue);
+      final start = calls.singleWhere(
+          (call) => call.method == Constants.startRecordingSpectrum);
+      expect(start.arguments, {
+        Constants.playerKey: Constants.recorderSpectrumKey,
+        Constants.bands: 16,
+        Constants.fftSize: 1024,
+        Constants.sampleRate: 16000,
+        Constants.channels: 2,
+      });
+      // Analysis stops with the recording.
+      expect(
+        calls.map((call) => call.method).skipWhile(
+            (method) => method != Constants.startRecordingSpectrum),
+        [
+          Constants.startRecordingSpectrum,
+          Constants.stopSpectrumAnalysis,
+          Constants.stopRecordingWriter,
+        ],
+      );
+    }, skip: !Platform.isLinux);
+
+    test('falls back to file recording when the writer can\'t open',
+        () async {
+      final calls = <String>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        calls.add(call.method);
+        return call.method == Constants.startRecordingWriter ? false : null;
+      });
+      final mockRecorder = MockAudioRecorder();
+      when(mockRecorder.hasPermission()).thenAnswer((_) async => true);
+      when(mockRecorder.start(any, path: anyNamed('path')))
+          .thenAnswer((_) async {});
+      final handler = DesktopAudioHandler(
+        recorder: mockRecorder,
+        playerFactory: () => MockAudioPlayer(),
+      );
+
+      final started = await handler.record(
+        settings: const RecorderSettings(),
+        path: '/tmp/recording.wav',
+      );
+
+      expect(started, isTrue);
+      verify(mockRecorder.start(any, path: '/tmp/recording.wav')).called(1);
+      verifyNever(mockRecorder.startStream(any));
+      expect(calls,
+          [Constants.startRecordingWriter, Constants.stopRecordingWriter]);
+    }, skip: !Platform.isLinux);
+  });
+
   group('player controls', () {
     const testKey = 'key';
     const testPath = '/tmp/test.m4a';
@@ -92,6 +285,10 @@ void main() {
       when(mockPlayer.pause()).thenAnswer((_) async {});
       when(mockPlayer.stop()).thenAnswer((_) async {});
       when(mockPlayer.seek(any)).thenAnswer((_) async {});
+      when(mockPlayer.playingStream).thenAnswer((_) => const Stream.empty());
+      when(mockPlayer.speedStream).thenAnswer((_) => const Stream.empty());
+      when(mockPlayer.playbackEventStream)
+          .thenAnswer((_) => const Stream.empty());
     });
 
     test('startPlayer calls play on AudioPlayer', () async {
@@ -109,6 +306,7 @@ void main() {
 
     test('pausePlayer calls pause on AudioPlayer', () async {
       await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+      await handler.startPlayer(testKey);
 
       final paused = await handler.pausePlayer(testKey);
 
@@ -118,6 +316,7 @@ void main() {
 
     test('stopPlayer calls stop on AudioPlayer', () async {
       await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+      await handler.startPlayer(testKey);
 
       final stopped = await handler.stopPlayer(testKey);
 
@@ -127,6 +326,7 @@ void main() {
 
     test('setVolume clamps value and calls setVolume on AudioPlayer', () async {
       await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+      await handler.startPlayer(testKey);
 
       final success = await handler.setVolume(2.0, testKey);
 
@@ -145,6 +345,7 @@ void main() {
 
     test('setRate adjusts playback speed', () async {
       await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+      await handler.startPlayer(testKey);
 
       when(mockPlayer.setSpeed(any)).thenAnswer((_) async {});
 
@@ -156,6 +357,7 @@ void main() {
 
     test('getDuration returns current and max duration', () async {
       await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+      await handler.startPlayer(testKey);
 
       when(mockPlayer.position).thenReturn(const Duration(milliseconds: 300));
       when(mockPlayer.load()).thenAnswer((_) async {});
@@ -170,6 +372,7 @@ void main() {
 
     test('setReleaseMode loop uses LoopMode.one', () async {
       await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+      await handler.startPlayer(testKey);
 
       when(mockPlayer.setLoopMode(any)).thenAnswer((_) async {});
 
@@ -184,6 +387,7 @@ void main() {
       when(mockPlayer.setLoopMode(any)).thenAnswer((_) async {});
 
       await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+      await handler.startPlayer(testKey);
       await handler.setReleaseMode(testKey, FinishMode.pause);
 
       controller.add(PlayerState(false, ProcessingState.completed));
@@ -199,6 +403,7 @@ void main() {
       when(mockPlayer.setLoopMode(any)).thenAnswer((_) async {});
 
       await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+      await handler.startPlayer(testKey);
       await handler.setReleaseMode(testKey, FinishMode.stop);
 
       controller.add(PlayerState(false, ProcessingState.completed));
@@ -206,5 +411,461 @@ void main() {
 
       verify(mockPlayer.stop()).called(1);
     });
+
+    test('preparePlayer does not open the file until playback', () async {
+      await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+
+      verifyNever(mockPlayer.setFilePath(any));
+
+      await handler.startPlayer(testKey);
+
+      verify(mockPlayer.setFilePath(testPath)).called(1);
+    });
+
+    test('getDuration uses the duration probe without opening a player',
+        () async {
+      handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => mockPlayer,
+        durationProbe: (path) async => 4200,
+      );
+      await handler.preparePlayer(path: testPath, key: testKey, frequency: 1);
+
+      final max = await handler.getDuration(testKey, 1);
+
+      expect(max, 4200);
+      verifyNever(mockPlayer.setFilePath(any));
+    });
+  });
+
+  group('prepared player pool', () {
+    late List<MockAudioPlayer> created;
+    late DesktopAudioHandler handler;
+
+    setUp(() {
+      created = [];
+      handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        maxResidentPlayers: 1,
+        playerFactory: () {
+          final player = MockAudioPlayer();
+          when(player.setFilePath(any)).thenAnswer((_) async => null);
+          when(player.setVolume(any)).thenAnswer((_) async {});
+          when(player.seek(any)).thenAnswer((_) async {});
+          when(player.playing).thenReturn(false);
+          when(player.position)
+              .thenReturn(const Duration(milliseconds: 700));
+          when(player.playingStream).thenAnswer((_) => const Stream.empty());
+          when(player.speedStream).thenAnswer((_) => const Stream.empty());
+          when(player.playbackEventStream)
+              .thenAnswer((_) => const Stream.empty());
+          created.add(player);
+          return player;
+        },
+      );
+    });
+
+    test('evicts least recently used idle player', () async {
+      await handler.preparePlayer(path: 'a.m4a', key: 'a', frequency: 1);
+      await handler.preparePlayer(path: 'b.m4a', key: 'b', frequency: 1);
+
+      await handler.startPlayer('a');
+      await handler.startPlayer('b');
+
+      expect(created, hasLength(2));
+      verify(created.first.dispose()).called(1);
+      verifyNever(created.last.dispose());
+    });
+
+    test('restores volume and position when re-opening an evicted player',
+        () async {
+      await handler.preparePlayer(
+          path: 'a.m4a', key: 'a', frequency: 1, volume: 0.5);
+      await handler.preparePlayer(path: 'b.m4a', key: 'b', frequency: 1);
+
+      await handler.startPlayer('a');
+      await handler.startPlayer('b');
+      final position = await handler.getDuration('a', 0);
+      await handler.startPlayer('a');
+
+      expect(position, 700);
+      expect(created, hasLength(3));
+      verify(created.last.setFilePath('a.m4a')).called(1);
+      verify(created.last.setVolume(0.5)).called(1);
+      verify(created.last.seek(const Duration(milliseconds: 700))).called(1);
+    });
+
+    test('keeps the volume when re-preparing without one', () async {
+      await handler.preparePlayer(
+          path: 'a.m4a', key: 'a', frequency: 1, volume: 0.5);
+      await handler.preparePlayer(path: 'b.m4a', key: 'b', frequency: 1);
+      await handler.startPlayer('a');
+      await handler.preparePlayer(path: 'a.m4a', key: 'a', frequency: 1);
+
+      await handler.startPlayer('b');
+      await handler.startPlayer('a');
+
+      expect(created, hasLength(3));
+      verify(created.last.setVolume(0.5)).called(1);
+    });
+
+    test('does not evict a playing player', () async {
+      await handler.preparePlayer(path: 'a.m4a', key: 'a', frequency: 1);
+      await handler.preparePlayer(path: 'b.m4a', key: 'b', frequency: 1);
+
+      await handler.startPlayer('a');
+      when(created.first.playing).thenReturn(true);
+      await handler.startPlayer('b');
+
+      verifyNever(created.first.dispose());
+    });
+
+    test('evicts idle players under resource pressure', () async {
+      await handler.preparePlayer(path: 'a.m4a', key: 'a', frequency: 1);
+      await handler.startPlayer('a');
+
+      await handler.relieveResourcePressure(1);
+
+      verify(created.single.dispose()).called(1);
+    });
+
+    test('reserves the resource budget of resident players', () async {
+      const channel = MethodChannel(Constants.methodChannelName);
+      final calls = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        calls.add(call);
+        return call.method == Constants.probeMedia ? [null] : true;
+      });
+      addTearDown(() => TestDefaultBinaryMessengerBinding
+          .instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, null));
+      await handler.preparePlayer(path: 'a.m4a', key: 'a', frequency: 1);
+      await handler.preparePlayer(path: 'b.m4a', key: 'b', frequency: 1);
+
+      await handler.startPlayer('a');
+      await handler.startPlayer('b');
+
+      expect(
+        calls.map((call) => [call.method, call.arguments[Constants.playerKey]]),
+        [
+          [Constants.acquirePlayerResources, 'a'],
+          [Constants.releasePlayerResources, 'a'],
+          [Constants.acquirePlayerResources, 'b'],
+        ],
+      );
+    }, skip: !Platform.isLinux);
+  });
+
+  group('spectrum analysis', () {
+    const channel = MethodChannel(Constants.methodChannelName);
+    late List<MethodCall> calls;
+    late MockAudioPlayer mockPlayer;
+    late DesktopAudioHandler handler;
+
+    setUp(() {
+      TestWidgetsFlutterBinding.ensureInitialized();
+      calls = [];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        calls.add(call);
+        return true;
+      });
+      mockPlayer = MockAudioPlayer();
+      when(mockPlayer.setFilePath(any)).thenAnswer((_) async => null);
+      when(mockPlayer.play()).thenAnswer((_) async {});
+      when(mockPlayer.playing).thenReturn(true);
+      when(mockPlayer.speed).thenReturn(1.5);
+      when(mockPlayer.processingState).thenReturn(ProcessingState.ready);
+      when(mockPlayer.position).thenReturn(const Duration(milliseconds: 250));
+      when(mockPlayer.playingStream).thenAnswer((_) => const Stream.empty());
+      when(mockPlayer.speedStream).thenAnswer((_) => const Stream.empty());
+      when(mockPlayer.playbackEventStream)
+          .thenAnswer((_) => const Stream.empty());
+      handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => mockPlayer,
+      );
+    });
+
+    tearDown(() {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, null);
+    });
+
+    test('starts native analysis with the prepared path', () async {
+      await handler.preparePlayer(path: 'a.wav', key: 'k', frequency: 1);
+
+      final started = await handler.startSpectrumAnalysis(
+        key: 'k',
+        bands: 16,
+        fftSize: 1024,
+      );
+
+      expect(started, isTrue);
+      expect(calls.first.method, Constants.startSpectrumAnalysis);
+      expect(calls.first.arguments, {
+        Constants.playerKey: 'k',
+        Constants.path: 'a.wav',
+        Constants.bands: 16,
+        Constants.fftSize: 1024,
+      });
+    });
+
+    test('reads frames from the ring shared by the plugin', () async {
+      final ring = allocateBuffer([for (var i = 0; i < 8 * 2; i++) i / 16]);
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        if (call.method != Constants.startSpectrumAnalysis) return null;
+        // Fewer bands than requested, as the analyzer reports them.
+        return {Constants.sharedBuffer: ring, Constants.bands: 2};
+      });
+      await handler.preparePlayer(path: 'a.wav', key: 'k', frequency: 1);
+
+      final started = await handler.startSpectrumAnalysis(
+        key: 'k',
+        bands: 4,
+        fftSize: 1024,
+      );
+
+      expect(started, isTrue);
+      expect(handler.spectrumFrame('k', 1), [0, 1 / 16]);
+      expect(handler.spectrumFrame('k', 10), [2 / 16, 3 / 16]);
+      await handler.stopSpectrumAnalysis('k');
+      expect(handler.spectrumFrame('k', 1), isNull);
+    }, skip: Platform.isWindows);
+
+    test('forwards the playback clock of the resident player', () async {
+      await handler.preparePlayer(path: 'a.wav', key: 'k', frequency: 1);
+      await handler.startPlayer('k');
+
+      await handler.startSpectrumAnalysis(key: 'k', bands: 16, fftSize: 1024);
+
+      expect(calls.last.method, Constants.updateSpectrumClock);
+      expect(calls.last.arguments, {
+        Constants.playerKey: 'k',
+        Constants.progress: 250,
+        Constants.rate: 1.5,
+        Constants.isPlaying: true,
+      });
+    });
+
+    test('anchors the playback clock of the controller', () async {
+      final clock = PlaybackClock();
+      PlatformStreams.instance.playbackClocks['k'] = clock;
+      addTearDown(() => PlatformStreams.instance.playbackClocks.remove('k'));
+      when(mockPlayer.playingStream).thenAnswer((_) => Stream.value(true));
+
+      await handler.preparePlayer(path: 'a.wav', key: 'k', frequency: 1);
+      await handler.startPlayer('k');
+      await Future<void>.delayed(Duration.zero);
+
+      expect(clock.isPlaying, isTrue);
+      expect(clock.position(maxDuration: 250), 250);
+      // Opening the player only reserves its share of the resource budget.
+      expect(
+        calls.where((call) => call.method != Constants.acquirePlayerResources),
+        isEmpty,
+      );
+    });
+
+    test('ignores clock updates which fail', () async {
+      final playing = StreamController<bool>();
+      when(mockPlayer.playingStream).thenAnswer((_) => playing.stream);
+      await handler.preparePlayer(path: 'a.wav', key: 'k', frequency: 1);
+      await handler.startPlayer('k');
+      await handler.startSpectrumAnalysis(key: 'k', bands: 16, fftSize: 1024);
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        throw PlatformException(code: 'CLOSED');
+      });
+
+      // An unhandled error would fail the test.
+      playing.add(false);
+      await Future<void>.delayed(Duration.zero);
+      await playing.close();
+    });
+
+    test('release stops native analysis', () async {
+      await handler.preparePlayer(path: 'a.wav', key: 'k', frequency: 1);
+      await handler.startSpectrumAnalysis(key: 'k', bands: 16, fftSize: 1024);
+
+      await handler.release('k');
+
+      expect(calls.last.method, Constants.stopSpectrumAnalysis);
+    });
+  });
+
+  group('resource budget', () {
+    const channel = MethodChannel(Constants.methodChannelName);
+
+    tearDown(() {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, null);
+    });
+
+    test('sends the budget and reads the usage', () async {
+      final calls = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        calls.add(call);
+        if (call.method != Constants.getResourceUsage) return true;
+        return {
+          Constants.memory: 48 << 20,
+          Constants.threads: 2,
+          Constants.memoryBudget: 64 << 20,
+          Constants.threadBudget: 3,
+          Constants.queuedJobs: 1,
+          Constants.runningExtractions: 1,
+          Constants.residentPlayers: 2,
+        };
+      });
+
+      final set = await DesktopAudioHandler.setResourceBudget(
+        const ResourceBudget(memory: 64 << 20, threads: 3),
+      );
+      final usage = await DesktopAudioHandler.getResourceUsage();
+
+      expect(set, isTrue);
+      expect(calls.first.arguments, {
+        Constants.memory: 64 << 20,
+        Constants.threads: 3,
+      });
+      expect(usage?.memory, 48 << 20);
+      expect(usage?.budget.memory, 64 << 20);
+      expect(usage?.budget.threads, 3);
+      expect(usage?.queuedJobs, 1);
+      expect(usage?.residentPlayers, 2);
+    }, skip: !Platform.isLinux);
+
+    test('is not enforced without the plugin', () async {
+      expect(
+        await DesktopAudioHandler.setResourceBudget(const ResourceBudget()),
+        isFalse,
+      );
+      expect(await DesktopAudioHandler.getResourceUsage(), isNull);
+    });
+  });
+
+  group('media probe', () {
+    const channel = MethodChannel(Constants.methodChannelName);
+
+    tearDown(() {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, null);
+    });
+
+    test('probes all paths in one call', () async {
+      final calls = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        calls.add(call);
+        return [
+          {
+            Constants.codec: 'opus',
+            Constants.duration: 4000,
+            Constants.sampleRate: 48000,
+            Constants.channels: 2,
+          },
+          null,
+        ];
+      });
+
+      final infos = await DesktopAudioHandler.probeMedia(['a.opus', 'b.txt']);
+
+      expect(calls.single.method, Constants.probeMedia);
+      expect(calls.single.arguments[Constants.paths], ['a.opus', 'b.txt']);
+      expect(calls.single.arguments[Constants.exactDuration], isFalse);
+      expect(infos.first?.codec, 'opus');
+      expect(infos.first?.duration, const Duration(seconds: 4));
+      expect(infos.first?.sampleRate, 48000);
+      expect(infos.first?.channels, 2);
+      expect(infos.last, isNull);
+    }, skip: !Platform.isLinux);
+
+    test('getDuration only probes the headers', () async {
+      final calls = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        calls.add(call);
+        return [
+          {
+            Constants.codec: 'mp3',
+            Constants.duration: 3600000,
+            Constants.sampleRate: 44100,
+            Constants.channels: 2,
+          },
+        ];
+      });
+      final handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => MockAudioPlayer(),
+      );
+      await handler.preparePlayer(path: 'a.mp3', key: 'k', frequency: 1);
+
+      final duration = await handler.getDuration('k', 1);
+
+      expect(duration, 3600000);
+      expect(calls.single.arguments[Constants.paths], ['a.mp3']);
+      expect(calls.single.arguments[Constants.exactDuration], isFalse);
+    }, skip: !Platform.isLinux);
+
+    test('seekTo measures the file once for its exact duration', () async {
+      final measured = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        if (call.method != Constants.probeMedia) return null;
+        final exact = call.arguments[Constants.exactDuration] as bool;
+        if (exact) measured.add(call);
+        return [
+          {
+            Constants.codec: 'mp3',
+            // The header of a VBR file only estimates the duration.
+            Constants.duration: exact ? 3600000 : 3500000,
+            Constants.sampleRate: 44100,
+            Constants.channels: 2,
+          },
+        ];
+      });
+      final mockPlayer = MockAudioPlayer();
+      when(mockPlayer.setFilePath(any)).thenAnswer((_) async => null);
+      when(mockPlayer.seek(any)).thenAnswer((_) async {});
+      when(mockPlayer.playingStream).thenAnswer((_) => const Stream.empty());
+      when(mockPlayer.speedStream).thenAnswer((_) => const Stream.empty());
+      when(mockPlayer.playbackEventStream)
+          .thenAnswer((_) => const Stream.empty());
+      final handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => mockPlayer,
+      );
+      await handler.preparePlayer(path: 'a.mp3', key: 'k', frequency: 1);
+      final estimate = await handler.getDuration('k', 1);
+
+      await handler.seekTo('k', 1000);
+      await handler.seekTo('k', 2000);
+      await pumpEventQueue();
+
+      expect(estimate, 3500000);
+      expect(await handler.getDuration('k', 1), 3600000);
+      expect(measured.single.arguments[Constants.paths], ['a.mp3']);
+    }, skip: !Platform.isLinux);
+
+    test('getDuration falls back to the player without a native probe',
+        () async {
+      final mockPlayer = MockAudioPlayer();
+      when(mockPlayer.setFilePath(any)).thenAnswer((_) async => null);
+      when(mockPlayer.load()).thenAnswer((_) async => null);
+      when(mockPlayer.duration).thenReturn(const Duration(seconds: 2));
+      when(mockPlayer.playing).thenReturn(false);
+      final handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => mockPlayer,
+      );
+      await handler.preparePlayer(path: 'a.m4a', key: 'k', frequency: 1);
+
+      final duration = await handler.getDuration('k', 1);
+
+      expect(duration, 2000);
+    });
   });
 }
@@ -0,0 +1,64 @@
+import 'package:audio_waveforms/src/base/keyed_stream.dart';
+import 'package:audio_waveforms/src/base/player_identifier.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  group('keyed stream controller', () {
+    late KeyedStreamController<int> controller;
+
+    setUp(() {
+      controller = KeyedStreamController<int>();
+    });
+
+    tearDown(() {
+      controller.close();
+    });
+
+    test('routes events only to the listeners of their key', () async {
+      final a = <int>[];
+      final b = <int>[];
+      final all = <String>[];
+      final subscriptions = [
+        controller.forKey('a').listen(a.add),
+        controller.forKey('b').listen(b.add),
+        controller.forKey('b').listen(b.add),
+        controller.stream.listen((event) => all.add(event.playerKey)),
+      ];
+
+      controller
+        ..add(PlayerIdentifier('a', 1))
+        ..add(PlayerIdentifier('b', 2))
+        ..add(PlayerIdentifier('c', 3));
+      await Future<void>.delayed(Duration.zero);
+
+      expect(a, [1]);
+      expect(b, [2, 2]);
+      expect(all, ['a', 'b', 'c']);
+      for (final subscription in subscriptions) {
+        await subscription.cancel();
+      }
+    });
+
+    test('drops a key once its last listener cancels', () async {
+      final first = controller.forKey('a').listen((_) {});
+      final second = controller.forKey('a').listen((_) {});
+
+      await first.cancel();
+      expect(controller.hasListener, isTrue);
+      await second.cancel();
+      expect(controller.hasListener, isFalse);
+    });
+
+    test('closes the streams of every key', () async {
+      var isDone = false;
+      controller.forKey('a').listen((_) {}, onDone: () => isDone = true);
+
+      controller.close();
+      await Future<void>.delayed(Duration.zero);
+
+      expect(isDone, isTrue);
+      expect(controller.hasListener, isFalse);
+      expect(await controller.forKey('a').isEmpty, isTrue);
+    });
+  });
+}
@@ -0,0 +1,109 @@
+import 'package:audio_waveforms/audio_waveforms.dart';
+import 'package:audio_waveforms/src/base/constants.dart';
+import 'package:audio_waveforms/src/base/platform_streams.dart';
+import 'package:audio_waveforms/src/base/playback_clock.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+
+  group('playback clock', () {
+    late int now;
+    late PlaybackClock clock;
+
+    setUp(() {
+      now = 1000000;
+      clock = PlaybackClock(now: () => now);
+    });
+
+    test('holds the position while paused', () {
+      clock.anchor(
+          position: 1200, timestamp: 50, rate: 1.0, isPlaying: false);
+      now += 500000;
+
+      expect(clock.position(), 1200);
+    });
+
+    test('extrapolates the position with the rate while playing', () {
+      clock.anchor(position: 1000, timestamp: 0, rate: 1.5, isPlaying: true);
+      now += 400000;
+
+      expect(clock.position(), 1600);
+      expect(clock.position(maxDuration: 1500), 1500);
+    });
+
+    test('compensates the delivery delay of late anchors', () {
+      clock.anchor(position: 0, timestamp: 0, rate: 1.0, isPlaying: true);
+      // Read 1 s later on the platform, delivered 30 ms late.
+      now += 1030000;
+      clock.anchor(
+          position: 1000, timestamp: 1000000, rate: 1.0, isPlaying: true);
+
+      expect(clock.position(), 1030);
+    });
+
+    test('rebases after a platform clock discontinuity', () {
+      clock.anchor(position: 0, timestamp: 0, rate: 1.0, isPlaying: true);
+      now += 100000;
+      clock.anchor(
+          position: 100, timestamp: -5000000, rate: 1.0, isPlaying: true);
+
+      expect(clock.position(), 100);
+    });
+  });
+
+  group('player position', () {
+    late PlayerController controller;
+
+    setUp(() {
+      controller = PlayerController()
+        ..updateFrequency = UpdateFrequency.medium;
+    });
+
+    tearDown(() {
+      PlatformStreams.instance.playbackClocks.remove(controller.playerKey);
+      PlatformStreams.instance.playerControllerFactory
+          .remove(controller.playerKey);
+      PlatformStreams.instance.dispose();
+    });
+
+    Future<void> sendAnchor(int position, {required bool isPlaying}) {
+      return TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .handlePlatformMessage(
+        Constants.methodChannelName,
+        const StandardMethodCodec().encodeMethodCall(
+          MethodCall(Constants.onPlaybackAnchor, {
+            Constants.playerKey: controller.playerKey,
+            Constants.current: position,
+            Constants.timestamp: PlaybackClock.now(),
+            Constants.rate: 1.0,
+            Constants.isPlaying: isPlaying,
+          }),
+        ),
+        (_) {},
+      );
+    }
+
+    test('is extrapolated between anchors while playing', () async {
+      final positions = <int>[];
+      final subscription =
+          controller.onCurrentDurationChanged.listen(positions.add);
+      addTearDown(subscription.cancel);
+
+      await sendAnchor(2000, isPlaying: true);
+      await Future<void>.delayed(const Duration(milliseconds: 350));
+      await sendAnchor(2400, isPlaying: false);
+      final count = positions.length;
+      await Future<void>.delayed(const Duration(milliseconds: 250));
+
+      expect(positions.first, 2000);
+      expect(positions.length, greaterThanOrEqualTo(4));
+      expect(positions.last, 2400);
+      expect(positions, hasLength(count));
+      for (var i = 1; i < positions.length - 1; i++) {
+        expect(positions[i], greaterThan(positions[i - 1]));
+      }
+    });
+  });
+}
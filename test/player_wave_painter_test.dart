@@ -0,0 +1,70 @@
+import 'package:audio_waveforms/audio_waveforms.dart';
+import 'package:audio_waveforms/src/painters/player_wave_painter.dart';
+import 'package:flutter/material.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+class _LineRecorder implements Canvas {
+  final lines = <(Offset, Offset)>[];
+
+  @override
+  void drawLine(Offset p1, Offset p2, Paint paint) => lines.add((p1, p2));
+
+  @override
+  dynamic noSuchMethod(Invocation invocation) => null;
+}
+
+void main() {
+  PlayerWavePainter painter({
+    required List<double> waveformData,
+    List<List<double>> channelWaveforms = const [],
+  }) {
+    return PlayerWavePainter(
+      waveformData: waveformData,
+      channelWaveforms: channelWaveforms,
+      animValue: 1.0,
+      dragOffset: Offset.zero,
+      totalBackDistance: Offset.zero,
+      audioProgress: 0.0,
+      pushBack: () {},
+      callPushback: false,
+      scrollScale: 1.0,
+      waveformType: WaveformType.fitWidth,
+      cachedAudioProgress: 0.0,
+      playerWaveStyle: const PlayerWaveStyle(
+        scaleFactor: 10,
+        showSeekLine: false,
+      ),
+    );
+  }
+
+  test('draws channel waveforms in lanes from top to bottom', () {
+    final canvas = _LineRecorder();
+
+    painter(
+      waveformData: const [1.0, 1.0],
+      channelWaveforms: const [
+        [1.0, 0.0],
+        [0.0, 2.0],
+      ],
+    ).paint(canvas, const Size(100, 40));
+
+    expect(canvas.lines, hasLength(4));
+    // Lanes are 20 high, waves are scaled by half to fit them.
+    final (bottom, top) = canvas.lines[0];
+    expect(bottom.dy, 15);
+    expect(top.dy, 5);
+    final (secondBottom, secondTop) = canvas.lines[3];
+    expect(secondBottom.dy, 40);
+    expect(secondTop.dy, 20);
+  });
+
+  test('draws the mixed waveform over the whole height', () {
+    final canvas = _LineRecorder();
+
+    painter(waveformData: const [1.0]).paint(canvas, const Size(100, 40));
+
+    final (bottom, top) = canvas.lines.single;
+    expect(bottom.dy, 30);
+    expect(top.dy, 10);
+  });
+}
@@ -1,9 +1,119 @@
+import 'dart:io';
+
 import 'package:flutter_test/flutter_test.dart';
 import 'package:audio_waveforms/audio_waveforms.dart';
+import 'package:audio_waveforms/src/base/waveform_accumulator.dart';
+import 'package:audio_waveforms/src/base/waveform_sidecar.dart';
 
 void main() {
   test('RecorderController initializes', () {
     final controller = RecorderController();
     expect(controller.recorderState, RecorderState.stopped);
   });
+
+  group('waveform accumulator', () {
+    test('resamples levels to the requested number of points', () {
+      final accumulator = WaveformAccumulator();
+      for (final level in [0.0, 0.0, 1.0, 1.0]) {
+        accumulator.add(level);
+      }
+
+      expect(accumulator.toWaveform(2), [0.0, 1.0]);
+      expect(accumulator.toWaveform(8), hasLength(8));
+    });
+
+    test('merges buckets once the capacity is reached', () {
+      final accumulator = WaveformAccumulator(capacity: 4);
+      for (var i = 0; i < 10; i++) {
+        accumulator.add(i.isEven ? 0.0 : 1.0);
+      }
+
+      // Two buckets of 4 levels and one holding the last 2.
+      expect(accumulator.buckets, hasLength(3));
+      expect(accumulator.buckets.first, closeTo(0.7071, 1e-4));
+    });
+
+    test('resamples peaks to the loudest bucket of each point', () {
+      expect(
+        WaveformAccumulator.resamplePeaks([0.1, 0.9, 0.4, 0.2], 2),
+        [0.9, 0.4],
+      );
+      expect(WaveformAccumulator.resamplePeaks([0.5], 3), [0.5, 0.5, 0.5]);
+    });
+
+    test('is empty until a level is added', () {
+      final accumulator = WaveformAccumulator();
+
+      expect(accumulator.isEmpty, isTrue);
+      expect(accumulator.toWaveform(3), [0.0, 0.0, 0.0]);
+    });
+  });
+
+  group('waveform sidecar', () {
+    late Directory dir;
+    late String audioPath;
+
+    setUp(() async {
+      dir = await Directory.systemTemp.createTemp();
+      audioPath = '${dir.path}/recording.m4a';
+      await File(audioPath).writeAsBytes([0]);
+    });
+
+    tearDown(() => dir.delete(recursive: true));
+
+    test('round trips buckets, peaks and duration', () async {
+      final path = await const WaveformSidecar(
+        buckets: [0.25, 0.5],
+        peaks: [0.75, 1.0],
+        duration: Duration(milliseconds: 1200),
+      ).write(audioPath);
+
+      final sidecar = await WaveformSidecar.read(audioPath);
+
+      expect(path, WaveformSidecar.pathFor(audioPath));
+      expect(sidecar?.buckets, [0.25, 0.5]);
+      expect(sidecar?.peaks, [0.75, 1.0]);
+      expect(sidecar?.duration, const Duration(milliseconds: 1200));
+    });
+
+    test('is ignored when the audio file is newer', () async {
+      await const WaveformSidecar(
+        buckets: [0.5],
+        peaks: [0.5],
+        duration: Duration.zero,
+      ).write(audioPath);
+      await File(audioPath).setLastModified(
+        DateTime.now().add(const Duration(minutes: 1)),
+      );
+
+      expect(await WaveformSidecar.read(audioPath), isNull);
+    });
+
+    test('is ignored when malformed', () async {
+      await File(WaveformSidecar.pathFor(audioPath)).writeAsBytes([1, 2, 3]);
+
+      expect(await WaveformSidecar.read(audioPath), isNull);
+    });
+
+    test('is read by waveform extraction instead of the file', () async {
+      await const WaveformSidecar(
+        buckets: [0.25, 0.5],
+        peaks: [0.5, 1.0],
+        duration: Duration(milliseconds: 1200),
+      ).write(audioPath);
+
+      final waveform = await WaveformExtractionController()
+          .extractWaveformData(path: audioPath, noOfSamples: 2);
+
+      expect(waveform, [0.25, 0.5]);
+    });
+
+    test('ignores the format of levels polled while recording', () async {
+      // "AWF1", 1200 ms and one bucket without peaks.
+      await File(WaveformSidecar.pathFor(audioPath)).writeAsBytes(
+          [0x41, 0x57, 0x46, 0x31, 0xb0, 0x04, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0]);
+
+      expect(await WaveformSidecar.read(audioPath), isNull);
+    });
+  });
 }
@@ -0,0 +1,61 @@
+import 'dart:ffi';
+import 'dart:io';
+
+import 'package:audio_waveforms/src/base/constants.dart';
+import 'package:audio_waveforms/src/base/shared_float_buffer.dart';
+import 'package:audio_waveforms/src/models/waveform_extraction_result.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+/// Lays out a buffer like the plugin does, in memory released with free.
+int allocateBuffer(List<double> values, {int version = 1}) {
+  final calloc = DynamicLibrary.process().lookupFunction<
+      Pointer<Void> Function(IntPtr, IntPtr),
+      Pointer<Void> Function(int, int)>('calloc');
+  final address = calloc(1, 32 + values.length * 4).address;
+  Pointer<Int64>.fromAddress(address).value = version;
+  Pointer<Int64>.fromAddress(address + 8).value = values.length;
+  final floats = Pointer<Float>.fromAddress(address + 32);
+  for (var i = 0; i < values.length; i++) {
+    floats[i] = values[i];
+  }
+  return address;
+}
+
+void main() {
+  final free = Platform.isWindows
+      ? null
+      : DynamicLibrary.process().lookup<NativeFinalizerFunction>('free');
+
+  group('shared float buffer', () {
+    test('reads the floats in place', () {
+      final address = allocateBuffer([0.25, 0.5, 1.0]);
+
+      final buffer = SharedFloatBuffer.adopt(address, release: free);
+      Pointer<Float>.fromAddress(address + 36).value = 0.75;
+      Pointer<Int64>.fromAddress(address).value = 2;
+
+      expect(buffer.data, [0.25, 0.75, 1.0]);
+      expect(buffer.version, 2);
+    });
+
+    test('is not supported without the plugin library', () {
+      expect(SharedFloatBuffer.isSupported, isFalse);
+    });
+
+    test('backs the waveforms of extraction results', () {
+      final result = WaveformExtractionResult.fromPlatform({
+        Constants.waveformData: allocateBuffer([0.5, 1.0]),
+        Constants.channelWaveforms: [
+          allocateBuffer([0.25, 0.5]),
+          [0.75, 1.0],
+        ],
+      });
+
+      expect(result.waveformData, [0.5, 1.0]);
+      expect(result.channelWaveforms, [
+        [0.25, 0.5],
+        [0.75, 1.0],
+      ]);
+    });
+  }, skip: Platform.isWindows);
+}
@@ -1,7 +1,11 @@
 import 'dart:async';
+import 'dart:typed_data';
 
+import 'package:audio_waveforms/audio_waveforms.dart' show AudioSegment, ChannelMode, LoudnessInfo, SilenceDetection, WaveformExtractionResult;
+import 'package:audio_waveforms/src/base/constants.dart';
 import 'package:audio_waveforms/src/base/desktop_audio_handler.dart';
 import 'package:audio_waveforms/src/base/platform_streams.dart';
+import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:just_waveform/just_waveform.dart';
 import 'package:mockito/mockito.dart';
@@ -56,6 +60,63 @@ void main() {
       expect(result, [1.0, 2.0]);
     });
 
+    test('converts long waveforms on a background isolate', () async {
+      const length = 1 << 15;
+      final waveform = Waveform(
+        version: 1,
+        flags: 0,
+        sampleRate: 44100,
+        samplesPerPixel: 100,
+        length: length,
+        data: Int16List.fromList(
+          List.generate(2 * length, (i) => i.isOdd ? i ~/ 2 % 100 : 0),
+        ),
+      );
+
+      final future =
+          handler.extractWaveformData(key: 'k', path: 'p', noOfSamples: 2);
+      controller
+        ..add(FakeProgress(1.0, waveform))
+        ..close();
+
+      final result = await future;
+      expect(result, isA<Float64List>());
+      expect(result, hasLength(length));
+      expect(result[length - 1], (length - 1) % 100);
+    });
+
+    test('reuses one temp directory and deletes the output', () async {
+      final outputs = <File>[];
+      final handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => MockAudioPlayer(),
+        waveformExtractor: (
+            {required audioInFile, required waveOutFile, required zoom}) {
+          outputs.add(waveOutFile..writeAsBytesSync([0]));
+          return Stream.value(FakeProgress(
+            1.0,
+            Waveform(
+              version: 1,
+              flags: 0,
+              sampleRate: 44100,
+              samplesPerPixel: 100,
+              length: 1,
+              data: [0, 1],
+            ),
+          ));
+        },
+      );
+
+      await handler.extractWaveformData(key: 'a', path: 'p', noOfSamples: 1);
+      await handler.extractWaveformData(key: 'b', path: 'p', noOfSamples: 1);
+      await pumpEventQueue();
+
+      expect(outputs, hasLength(2));
+      expect(outputs[0].parent.path, outputs[1].parent.path);
+      expect(outputs.any((file) => file.existsSync()), isFalse);
+      await outputs[0].parent.delete(recursive: true);
+    });
+
     test('stopWaveformExtraction cancels extraction', () {
       fakeAsync((async) {
         final waveform = Waveform(
@@ -80,4 +141,267 @@ void main() {
       });
     });
   });
+
+  group('silence segments', () {
+    const channel = MethodChannel(Constants.methodChannelName);
+
+    tearDown(() {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, null);
+    });
+
+    test('fromPlatform parses segment triples', () {
+      final result = WaveformExtractionResult.fromPlatform({
+        Constants.waveformData: Float32List.fromList([0.5, 0.25]),
+        Constants.segments: Int64List.fromList([0, 1000, 0, 1000, 1500, 1]),
+      });
+
+      expect(result.waveformData, [0.5, 0.25]);
+      expect(result.segments, hasLength(2));
+      final AudioSegment silence = result.segments![1];
+      expect(silence.start, const Duration(milliseconds: 1000));
+      expect(silence.end, const Duration(milliseconds: 1500));
+      expect(silence.isSilent, isTrue);
+    });
+
+    test('fromPlatform parses channel waveforms', () {
+      final result = WaveformExtractionResult.fromPlatform({
+        Constants.waveformData: Float32List.fromList([0.5, 0.25]),
+        Constants.channelWaveforms: [
+          Float32List.fromList([0.5, 0.0]),
+          Float32List.fromList([0.0, 0.5]),
+        ],
+      });
+
+      expect(result.channelWaveforms, [
+        [0.5, 0.0],
+        [0.0, 0.5],
+      ]);
+    });
+
+    test('fromPlatform accepts a plain waveform list', () {
+      final result = WaveformExtractionResult.fromPlatform([0.1, 0.2]);
+
+      expect(result.waveformData, [0.1, 0.2]);
+      expect(result.segments, isNull);
+    });
+
+    test('native extraction sends silence options', () async {
+      MethodCall? received;
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        received = call;
+        return {
+          Constants.waveformData: Float32List.fromList([0.5]),
+          Constants.segments: Int64List.fromList([0, 200, 1]),
+        };
+      });
+      final handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => MockAudioPlayer(),
+      );
+
+      final result = await handler.extractWaveformNatively(
+        key: 'k',
+        path: 'a.wav',
+        noOfSamples: 1,
+        silenceDetection: const SilenceDetection(
+          thresholdDb: -40,
+          minDuration: Duration(milliseconds: 200),
+        ),
+      );
+
+      expect(received?.arguments[Constants.silenceThreshold], -40);
+      expect(received?.arguments[Constants.silenceMinDuration], 200);
+      expect(result?.segments?.single.isSilent, isTrue);
+    });
+
+    test('native extraction returns null for unsupported files', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async => null);
+      final handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => MockAudioPlayer(),
+      );
+
+      final result = await handler.extractWaveformNatively(
+        key: 'k',
+        path: 'a.mp3',
+        noOfSamples: 1,
+      );
+
+      expect(result, isNull);
+    });
+  });
+
+  group('loudness', () {
+    const channel = MethodChannel(Constants.methodChannelName);
+
+    tearDown(() {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, null);
+    });
+
+    test('fromPlatform parses loudness', () {
+      final result = WaveformExtractionResult.fromPlatform({
+        Constants.waveformData: Float32List.fromList([0.5]),
+        Constants.loudness: {
+          Constants.integratedLoudness: -18.5,
+          Constants.loudnessRange: 6.0,
+          Constants.samplePeak: -1.5,
+          Constants.truePeak: -0.5,
+        },
+      });
+
+      final LoudnessInfo loudness = result.loudness!;
+      expect(loudness.integratedLoudness, -18.5);
+      expect(loudness.loudnessRange, 6.0);
+      expect(loudness.samplePeak, -1.5);
+      expect(loudness.truePeak, -0.5);
+      expect(loudness.gainTo(-23), -4.5);
+      expect(result.segments, isNull);
+    });
+
+    test('native extraction requests loudness only when asked', () async {
+      final received = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (call) async {
+        received.add(call);
+        return {Constants.waveformData: Float32List.fromList([0.5])};
+      });
+      final handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => MockAudioPlayer(),
+      );
+
+      await handler.extractWaveformNatively(
+          key: 'k', path: 'a.wav', noOfSamples: 1);
+      final result = await handler.extractWaveformNatively(
+        key: 'k',
+        path: 'a.wav',
+        noOfSamples: 1,
+        measureLoudness: true,
+      );
+
+      expect(received[0].arguments[Constants.measureLoudness], isNull);
+      expect(received[1].arguments[Constants.measureLoudness], isTrue);
+      expect(result?.loudness, isNull);
+    });
+  });
+
+  group('progressive extraction', () {
+    const channel = MethodChannel(Constants.methodChannelName);
+    final messenger =
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger;
+
+    tearDown(() {
+      messenger.setMockMethodCallHandler(channel, null);
+    });
+
+    test('native extraction requests progressive updates only when asked',
+        () async {
+      final received = <MethodCall>[];
+      messenger.setMockMethodCallHandler(channel, (call) async {
+        received.add(call);
+        return {Constants.waveformData: Float32List.fromList([0.5])};
+      });
+      final handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => MockAudioPlayer(),
+      );
+
+      await handler.extractWaveformNatively(
+          key: 'k', path: 'a.wav', noOfSamples: 1);
+      await handler.extractWaveformNatively(
+        key: 'k',
+        path: 'a.wav',
+        noOfSamples: 1,
+        progressive: true,
+      );
+
+      expect(received[0].arguments[Constants.progressive], isNull);
+      expect(received[1].arguments[Constants.progressive], isTrue);
+    });
+
+    test('native extraction requests channel waveforms only when asked',
+        () async {
+      final received = <MethodCall>[];
+      messenger.setMockMethodCallHandler(channel, (call) async {
+        received.add(call);
+        return {Constants.waveformData: Float32List.fromList([0.5])};
+      });
+      final handler = DesktopAudioHandler(
+        recorder: MockAudioRecorder(),
+        playerFactory: () => MockAudioPlayer(),
+      );
+
+      await handler.extractWaveformNatively(
+          key: 'k', path: 'a.wav', noOfSamples: 1);
+      await handler.extractWaveformNatively(
+        key: 'k',
+        path: 'a.wav',
+        noOfSamples: 1,
+        channelMode: ChannelMode.midSide,
+      );
+
+      expect(received[0].arguments[Constants.channelMode], isNull);
+      expect(received[1].arguments[Constants.channelMode],
+          ChannelMode.midSide.index);
+    });
+
+    test('resolution levels are forwarded with their waveform', () async {
+      await PlatformStreams.instance.init();
+      final levels = <int>[];
+      final waveforms = <List<double>>[];
+      final subscriptions = [
+        PlatformStreams.instance.onExtractionResolution
+            .where((event) => event.playerKey == 'k')
+            .listen((event) => levels.add(event.type)),
+        PlatformStreams.instance.onCurrentExtractedWaveformData
+            .where((event) => event.playerKey == 'k')
+            .listen((event) => waveforms.add(event.type)),
+      ];
+
+      Future<void> send(Map<String, Object?> arguments) {
+        return messenger.handlePlatformMessage(
+          Constants.methodChannelName,
+          const StandardMethodCodec().encodeMethodCall(
+            MethodCall(Constants.onCurrentExtractedWaveformData, arguments),
+          ),
+          (_) {},
+        );
+      }
+
+      await send({
+        Constants.playerKey: 'k',
+        Constants.progress: 0.0,
+        Constants.waveformData: [0.5, 0.5],
+        Constants.resolutionLevel: 0,
+      });
+      await send({
+        Constants.playerKey: 'k',
+        Constants.progress: 1.0,
+        Constants.waveformData: [0.25, 0.75],
+        Constants.resolutionLevel: 1,
+      });
+      // Sequential extractions don't tag their updates.
+      await send({
+        Constants.playerKey: 'k',
+        Constants.progress: 1.0,
+        Constants.waveformData: [0.1, 0.2],
+      });
+      await pumpEventQueue();
+
+      expect(levels, [0, 1]);
+      expect(waveforms, [
+        [0.5, 0.5],
+        [0.25, 0.75],
+        [0.1, 0.2],
+      ]);
+      for (final subscription in subscriptions) {
+        await subscription.cancel();
+      }
+      PlatformStreams.instance.dispose();
+    });
+  });
 }